@@ -21,15 +21,27 @@
 
 #include "bdd.h"
 
+#include <mutex>
+#include <set>
+#include <unordered_set>
+
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/range/algorithm.hpp>
 
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 #include "zbdd.h"
 
 namespace scram::core {
 
+namespace {
+
+const int kMinReorderSize = 4096;  ///< The initial reordering threshold.
+const double kMaxSiftGrowth = 1.2;  ///< The limit on the BDD growth in sifting.
+
+}  // namespace
+
 int GetPrimeNumber(int n) {
   assert(n > 0 && "Only natural numbers.");
   if (n % 2 == 0)
@@ -39,39 +51,72 @@ int GetPrimeNumber(int n) {
   return n;
 }
 
-Bdd::Bdd(const Pdag* graph, const Settings& settings)
+Bdd::Bdd(const FrozenPdag& graph, const Settings& settings)
     : kSettings_(settings),
-      coherent_(graph->coherent()),
+      coherent_(graph.coherent()),
+      pool_(new VertexPool<Ite>),
+      reorder_time_(settings.reorder_time()),
+      reorder_threshold_(kMinReorderSize),
       kOne_(new Terminal<Ite>(true)),
-      function_id_(2) {
+      function_id_(2),
+      host_(nullptr) {
   TIMER(DEBUG3, "Converting PDAG into BDD");
-  if (graph->IsTrivial()) {
-    const Gate& top_gate = graph->root();
-    assert(top_gate.args().size() == 1);
-    assert(top_gate.args<Gate>().empty());
-    int child = *top_gate.args().begin();
-    if (top_gate.constant()) {
+  if (graph.roots().empty() && graph.trivial()) {
+    const FrozenPdag::GateInfo& top_gate = graph.gate(graph.root());
+    if (top_gate.constant) {
       // Constant case should only happen to the top gate.
-      root_ = {child < 0, kOne_};
+      roots_.push_back({graph.complement(), kOne_});
     } else {
-      const Variable& var = top_gate.args<Variable>().begin()->second;
-      root_ = {child < 0,
-               FindOrAddVertex(var.index(), kOne_, kOne_, true, var.order())};
-      index_to_order_.emplace(var.index(), var.order());
+      assert(graph.variable_args(graph.root()).size() == 1);
+      int child = graph.variable_args(graph.root()).front();
+      int index = child >> 1;
+      int order = graph.variable_order(index);
+      roots_.push_back({static_cast<bool>(child & 1),
+                        FindOrAddVertex(index, kOne_, kOne_, true, order)});
+      index_to_order_.emplace(index, order);
     }
   } else {
-    std::unordered_map<int, std::pair<Function, int>> gates;
-    root_ = ConvertGraph(graph->root(), &gates);
-    root_.complement ^= graph->complement();
+    std::vector<std::pair<Function, int>> gates(graph.num_gates());
+    if (!graph.roots().empty())
+      SkipUnreachableGates(graph, &gates);
+    int first = 0;
+    if (ThreadBudget::Available(kSettings_.num_threads()) > 1) {
+      for (int module : ConvertModules(graph, &gates)) {
+        ConvertGates(graph, first, graph.gate(module).first, &gates);
+        first = module + 1;
+      }
+    }
+    ConvertGates(graph, first, graph.num_gates(), &gates);
+    if (graph.roots().empty()) {
+      roots_.push_back(gates.back().first);
+      roots_.front().complement ^= graph.complement();
+    }
+    for (const FrozenPdag::Root& root : graph.roots()) {
+      if (root.position >= 0) {
+        roots_.push_back(gates[root.position].first);  // Kept by the pin.
+        roots_.back().complement ^= root.complement;
+      } else if (root.index) {
+        int order = GetOrder(root.index, graph.variable_order(root.index));
+        roots_.push_back({root.complement, FindOrAddVertex(root.index, kOne_,
+                                                           kOne_, true, order)});
+        index_to_order_.emplace(root.index, order);
+      } else {
+        roots_.push_back({root.complement, kOne_});
+      }
+    }
   }
   ClearMarks(false);
-  TestStructure(root_.vertex);
+  for (const Function& root : roots_)
+    TestStructure(root.vertex);
   LOG(DEBUG4) << "# of BDD vertices created: " << function_id_ - 1;
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
   ClearMarks(false);
-  LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
+  int num_ite = 0;
+  for (const Function& root : roots_)
+    num_ite += CountIteNodes(root.vertex);  // The shared vertices are marked.
+  LOG(DEBUG4) << "# of ITE in BDD: " << num_ite;
   ClearMarks(false);
   if (coherent_) {  // Clear tables if no more calculations are expected.
     Freeze();
@@ -80,17 +125,79 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
   }
 }
 
+Bdd::Bdd(Bdd* host)
+    : kSettings_(host->kSettings_),
+      coherent_(host->coherent_),
+      pool_(new VertexPool<Ite>),
+      reorder_time_(host->reorder_time_),
+      reorder_threshold_(kMinReorderSize),
+      kOne_(new Terminal<Ite>(true)),
+      function_id_(0),
+      host_(host) {}
+
 Bdd::~Bdd()  = default;
 
+std::vector<int> Bdd::ConvertModules(
+    const FrozenPdag& graph, std::vector<std::pair<Function, int>>* gates) {
+  // Modules reachable from the root without passing through other modules
+  // share no variables or gates;
+  // a lone module is expanded in search of more parallelism.
+  // The gates of a module precede it in a contiguous range,
+  // so nested modules are skipped by jumping over the range.
+  std::vector<int> modules;
+  for (int parent = graph.root(); parent >= 0;) {
+    modules.clear();
+    for (int i = parent - 1; i >= graph.gate(parent).first; --i) {
+      if (graph.gate(i).module) {
+        modules.push_back(i);
+        i = graph.gate(i).first;
+      }
+    }
+    parent = modules.size() == 1 ? modules.front() : -1;
+  }
+  if (modules.size() < 2 ||
+      ThreadBudget::Available(kSettings_.num_threads()) < 2)
+    return {};
+  LOG(DEBUG4) << "Converting " << modules.size() << " modules concurrently...";
+  std::vector<std::unique_ptr<Bdd>> workers;
+  std::mutex workers_mutex;
+  ParallelFor(modules.size(), 1, kSettings_.num_threads(), [&](int) {
+    std::lock_guard<std::mutex> lock(workers_mutex);
+    Bdd* worker = workers.emplace_back(new Bdd(this)).get();
+    return [&graph, &modules, gates, worker](std::size_t first,
+                                             std::size_t last) {
+      for (std::size_t i = first; i < last; ++i) {
+        // The module ranges are disjoint in the shared container.
+        worker->ConvertGates(graph, graph.gate(modules[i]).first,
+                             modules[i] + 1, gates);
+      }
+    };
+  });
+
+  for (const std::unique_ptr<Bdd>& worker : workers) {
+    unique_table_.Merge(&worker->unique_table_);
+    modules_.merge(worker->modules_);
+    index_to_order_.merge(worker->index_to_order_);
+    orders_.merge(worker->orders_);
+  }
+  boost::sort(modules);
+  return modules;
+}
+
 void Bdd::Analyze(const Pdag* graph)  {
   // Only build ZBDD/products if required by settings; otherwise, keep just BDD.
   if (kSettings_.requires_products()) {
-    zbdd_ = std::make_unique<Zbdd>(this, kSettings_);
-    if (graph)
-      zbdd_->SetProbabilityContext(graph);
-    zbdd_->Analyze(graph);
+    for (int i = 0; i < roots_.size(); ++i) {
+      Zbdd* zbdd = zbdds_.emplace_back(new Zbdd(this, i, kSettings_)).get();
+      if (graph)
+        zbdd->SetProbabilityContext(graph);
+      zbdd->Analyze(graph);
+    }
     if (!coherent_)  // The BDD has been used by the ZBDD.
       Freeze();
+    if (kSettings_.probability_analysis() &&
+        kSettings_.approximation() == Approximation::kNone)
+      Compact();  // The owner releases the graph for the quantification.
   } else {
     // No ZBDD requested; ensure any transient tables are cleared.
     ClearTables();
@@ -99,6 +206,49 @@ void Bdd::Analyze(const Pdag* graph)  {
   }
 }
 
+void Bdd::Compact() {
+  if (compact())
+    return;
+  CLOCK(compact_time);
+  Freeze();  // The tables are released before the array is allocated.
+  ClearMarks(false);
+  // Counting marks all the vertices to append.
+  std::size_t num_nodes = 1;
+  for (const Function& root : roots_)
+    num_nodes += CountIteNodes(root.vertex);
+  nodes_.reserve(num_nodes);
+  nodes_.push_back({0, 0, kNoModule, 0, 0});  // The terminal vertex.
+  for (Function& root : roots_) {
+    root_edges_.push_back(CompactGraph(root.vertex) << 1 | root.complement);
+    root = {false, kOne_};
+  }
+  modules_.clear();
+  pool_.reset();  // The slabs are released with the last vertex.
+  LOG(DEBUG4) << "Compacted " << nodes_.size() - 1 << " BDD vertices in "
+              << DUR(compact_time);
+}
+
+std::uint32_t Bdd::CompactGraph(const VertexPtr& vertex) {
+  if (vertex->terminal())
+    return 0;
+  Ite& ite = Ite::Ref(vertex);
+  if (!ite.mark())
+    return ite.handle();
+  Node node{0, 0, kNoModule, ite.index(), ite.order()};
+  if (ite.module()) {
+    const Function& res = modules_.find(ite.index())->second;
+    node.module = CompactGraph(res.vertex) << 1 | res.complement;
+  }
+  node.high = CompactGraph(ite.high());
+  node.low = CompactGraph(ite.low()) << 1 | ite.complement_edge();
+  assert(nodes_.size() < (1u << 31) && "Too many vertices for 32-bit edges.");
+  assert(nodes_.size() < nodes_.capacity() && "Uncounted vertices.");
+  ite.handle(nodes_.size());
+  ite.mark(false);
+  nodes_.push_back(node);
+  return ite.handle();
+}
+
 ItePtr Bdd::FindOrAddVertex(int index, const VertexPtr& high,
                             const VertexPtr& low, bool complement_edge,
                             int order)  {
@@ -108,7 +258,7 @@ ItePtr Bdd::FindOrAddVertex(int index, const VertexPtr& high,
   if (!in_table.expired())
     return in_table.lock();
   assert(order > 0 && "Improper order.");
-  ItePtr ite(new Ite(index, order, function_id_++, high, low));
+  ItePtr ite(pool_->Create(index, order, NextId(), high, low));
   ite->complement_edge(complement_edge);
   in_table = ite;
   return ite;
@@ -128,71 +278,343 @@ ItePtr Bdd::FindOrAddVertex(const ItePtr& ite, const VertexPtr& high,
   return in_table;
 }
 
-ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                            const VertexPtr& low,
-                            bool complement_edge)  {
-  assert(gate.module() && "Only module gates are expected for proxies.");
-  ItePtr in_table =
-      FindOrAddVertex(gate.index(), high, low, complement_edge, gate.order());
+ItePtr Bdd::FindOrAddVertex(const FrozenPdag::GateInfo& gate,
+                            const VertexPtr& high, const VertexPtr& low,
+                            bool complement_edge) {
+  assert(gate.module && "Only module gates are expected for proxies.");
+  ItePtr in_table = FindOrAddVertex(gate.index, high, low, complement_edge,
+                                    GetOrder(gate.index, gate.order));
   if (in_table->unique()) {
-    in_table->module(gate.module());
-    in_table->coherent(gate.coherent());
+    in_table->module(gate.module);
+    in_table->coherent(gate.coherent);
   }
-  assert(in_table->module() == gate.module());
-  assert(in_table->coherent() == gate.coherent());
+  assert(in_table->module() == gate.module);
+  assert(in_table->coherent() == gate.coherent);
   return in_table;
 }
 
-Bdd::Function Bdd::ConvertGraph(
-    const Gate& gate,
-    std::unordered_map<int, std::pair<Function, int>>* gates)  {
-  assert(!gate.constant() && "Unexpected constant gate!");
-  Function result;  // For the NRVO, due to memoization.
-  // Memoization check.
-  if (auto it_entry = ext::find(*gates, gate.index())) {
-    std::pair<Function, int>& entry = it_entry->second;
-    result = entry.first;
-    assert(entry.second < static_cast<int>(gate.parents().size()));  // Processed parents.
-    if (++entry.second == static_cast<int>(gate.parents().size()))
-      gates->erase(it_entry);
-    return result;
+void Bdd::SkipUnreachableGates(
+    const FrozenPdag& graph, std::vector<std::pair<Function, int>>* gates) {
+  std::vector<bool> reachable(graph.num_gates());
+  for (const FrozenPdag::Root& root : graph.roots()) {
+    if (root.position >= 0)
+      reachable[root.position] = true;
   }
+  // The arguments precede their parents in the topological order.
+  for (int position = graph.num_gates() - 1; position >= 0; --position) {
+    if (!reachable[position]) {
+      (*gates)[position].second = -1;
+      for (int arg : graph.gate_args(position))
+        ++(*gates)[arg >> 1].second;  // Never a parent of the converted gate.
+      continue;
+    }
+    for (int arg : graph.gate_args(position))
+      reachable[arg >> 1] = true;
+  }
+}
+
+void Bdd::ConvertGates(const FrozenPdag& graph, int first, int last,
+                       std::vector<std::pair<Function, int>>* gates) {
   std::vector<Function> args;
-  for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
-    args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
-  }
-  for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
-    if (arg.second.module()) {
-      args.push_back(
-          {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
-    } else {
-      bool complement = (arg.first < 0) ^ res.complement;
-      args.push_back({complement, res.vertex});
+  for (int position = first; position < last; ++position) {
+    if ((*gates)[position].second < 0)
+      continue;  // Unreachable from the roots.
+    const FrozenPdag::GateInfo& gate = graph.gate(position);
+    assert(!gate.constant && "Unexpected constant gate!");
+    args.clear();
+    for (int arg : graph.variable_args(position)) {
+      int index = arg >> 1;
+      int order = GetOrder(index, graph.variable_order(index));
+      args.push_back({static_cast<bool>(arg & 1),
+                      FindOrAddVertex(index, kOne_, kOne_, true, order)});
+      index_to_order_.emplace(index, order);
+    }
+    for (int arg : graph.gate_args(position)) {
+      const FrozenPdag::GateInfo& child = graph.gate(arg >> 1);
+      std::pair<Function, int>& entry = (*gates)[arg >> 1];
+      assert(entry.first && entry.second < child.num_parents);
+      bool complement = arg & 1;
+      if (child.module) {
+        args.push_back(
+            {complement, FindOrAddVertex(child, kOne_, kOne_, true)});
+      } else {
+        args.push_back({complement != entry.first.complement,
+                        entry.first.vertex});
+      }
+      if (++entry.second == child.num_parents)
+        entry.first.reset();  // The last parent is processed.
     }
+    boost::sort(args, [](const Function& lhs, const Function& rhs) {
+      if (lhs.vertex->terminal())
+        return true;
+      if (rhs.vertex->terminal())
+        return false;
+      return Ite::Ref(lhs.vertex).order() > Ite::Ref(rhs.vertex).order();
+    });
+    auto it = args.cbegin();
+    Function result = *it++;
+    for (; it != args.cend(); ++it) {
+      result = Apply(gate.type, result.vertex, it->vertex, result.complement,
+                     it->complement);
+      if (reorder_time_ > 0 && unique_table_.size() >= reorder_threshold_)
+        Reorder();
+    }
+    ClearTables();
+    assert(result.vertex);
+    if (gate.module)
+      modules_.emplace(gate.index, result);
+    (*gates)[position] = {result, 0};
   }
-  boost::sort(args, [](const Function& lhs, const Function& rhs) {
-    if (lhs.vertex->terminal())
-      return true;
-    if (rhs.vertex->terminal())
-      return false;
-    return Ite::Ref(lhs.vertex).order() > Ite::Ref(rhs.vertex).order();
-  });
-  auto it = args.cbegin();
-  for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
-                   it->complement);
+}
+
+/// Rudell's sifting of variables in the BDD.
+/// The vertices are taken out of the unique table into per-level lists,
+/// which keep them alive and let adjacent levels swap in place.
+/// A vertex is dead if its level list holds the only reference to it.
+class Bdd::Sifter {
+ public:
+  /// Takes the vertices out of the unique table.
+  ///
+  /// @param[in,out] bdd  The BDD with cleared computation tables.
+  explicit Sifter(Bdd* bdd) : bdd_(bdd), num_vertices_(0) {
+    std::unordered_map<int, int> index_to_level;
+    for (ItePtr& ite : bdd_->unique_table_.Extract()) {
+      auto [it, inserted] = index_to_level.emplace(ite->index(), 0);
+      if (inserted) {
+        orders_.push_back(ite->order());
+        levels_.push_back({ite->index(), ite->module(), ite->coherent(), {}});
+        it->second = levels_.size() - 1;
+      }
+      levels_[it->second].vertices.push_back(std::move(ite));
+      ++num_vertices_;
+    }
+    boost::sort(orders_);
+    boost::sort(levels_, [](const Level& lhs, const Level& rhs) {
+      return Ite::Ref(lhs.vertices.front()).order() <
+             Ite::Ref(rhs.vertices.front()).order();
+    });
+    for (int i = 0; i < static_cast<int>(levels_.size()); ++i)
+      index_to_level_[levels_[i].index] = i;
+  }
+
+  /// Assigns the new orders to the variables
+  /// and puts the vertices back into the unique table.
+  ~Sifter() {
+    for (int i = 0; i < static_cast<int>(levels_.size()); ++i) {
+      int index = levels_[i].index;
+      bdd_->orders_[index] = orders_[i];
+      if (auto it = ext::find(bdd_->index_to_order_, index))
+        it->second = orders_[i];
+      for (ItePtr& ite : levels_[i].vertices) {
+        bdd_->unique_table_.FindOrAdd(ite->index(), ite->high()->id(),
+                                      get_low_id(*ite)) = ite;
+      }
+    }
   }
+
+  /// @returns The number of live vertices.
+  int num_vertices() const { return num_vertices_; }
+
+  /// Sifts variables one at a time
+  /// in the order of decreasing number of vertices on their levels.
+  /// Each variable is moved through all the levels
+  /// and is left at the level with the smallest BDD.
+  ///
+  /// @param[in] time_limit  The time budget in seconds.
+  void Run(double time_limit) {
+    CLOCK(sift_time);
+    auto expired = [&sift_time, time_limit] {
+      return DUR(sift_time) > time_limit;
+    };
+    std::vector<std::pair<int, int>> candidates;  // {size, index}
+    for (const Level& level : levels_)
+      candidates.emplace_back(level.vertices.size(), level.index);
+    boost::sort(candidates, std::greater<>());
+    int num_levels = levels_.size();
+    for (const std::pair<int, int>& candidate : candidates) {
+      if (expired())
+        break;
+      int level = index_to_level_.find(candidate.second)->second;
+      int best_level = level;
+      int best_size = num_vertices_;
+      auto update = [&] {
+        if (num_vertices_ < best_size) {
+          best_size = num_vertices_;
+          best_level = level;
+        }
+      };
+      int max_size = best_size * kMaxSiftGrowth;
+      while (level + 1 < num_levels && num_vertices_ <= max_size &&
+             !expired()) {
+        Swap(level++);
+        update();
+      }
+      while (level > 0 && num_vertices_ <= max_size && !expired()) {
+        Swap(--level);
+        update();
+      }
+      while (level < best_level)
+        Swap(level++);
+      while (level > best_level)
+        Swap(--level);
+    }
+  }
+
+ private:
+  /// Vertices of the same variable.
+  struct Level {
+    int index;  ///< The variable index.
+    bool module;  ///< The variable is a module proxy.
+    bool coherent;  ///< The module is coherent.
+    std::vector<ItePtr> vertices;  ///< All live vertices of the variable.
+  };
+
+  /// Splits a function into its cofactors by a variable.
+  ///
+  /// @param[in] function  The function with the top variable at or below.
+  /// @param[in] index  The index of the variable.
+  ///
+  /// @returns The positive and negative cofactors.
+  static std::pair<Function, Function> Cofactor(const Function& function,
+                                                int index) {
+    if (function.vertex->terminal() ||
+        Ite::Ref(function.vertex).index() != index) {
+      return {function, function};
+    }
+    Ite& ite = Ite::Ref(function.vertex);
+    return {{function.complement, ite.high()},
+            {function.complement != ite.complement_edge(), ite.low()}};
+  }
+
+  /// Swaps the variables of adjacent levels.
+  /// Vertices of the upper variable depending on the lower variable
+  /// are rebuilt in place as vertices of the lower variable;
+  /// the others only move down a level.
+  ///
+  /// @param[in] upper  The upper level of the swap.
+  void Swap(int upper) {
+    Level& top = levels_[upper];
+    Level& bottom = levels_[upper + 1];
+    int top_order = orders_[upper + 1];  // The new orders.
+    int bottom_order = orders_[upper];
+    auto depends = [&bottom](const VertexPtr& vertex) {
+      return !vertex->terminal() && Ite::Ref(vertex).index() == bottom.index;
+    };
+    std::vector<ItePtr> moving;
+    std::vector<ItePtr> top_vertices;
+    std::unordered_map<std::pair<int, int>, ItePtr,
+                       boost::hash<std::pair<int, int>>>
+        top_table;
+    for (ItePtr& ite : top.vertices) {
+      if (depends(ite->high()) || depends(ite->low())) {
+        moving.push_back(std::move(ite));
+      } else {
+        ite->order(top_order);
+        top_table.emplace(std::pair(ite->high()->id(), get_low_id(*ite)), ite);
+        top_vertices.push_back(std::move(ite));
+      }
+    }
+    // The reduced if-then-else vertex of the upper variable.
+    auto find_or_add = [&](Function high, Function low) -> Function {
+      if (high.complement == low.complement &&
+          high.vertex->id() == low.vertex->id()) {
+        return high;
+      }
+      bool complement = high.complement;
+      low.complement ^= complement;  // The high edge must be regular.
+      ItePtr& ite = top_table[{high.vertex->id(), low.complement
+                                                      ? -low.vertex->id()
+                                                      : low.vertex->id()}];
+      if (!ite) {
+        ite = bdd_->pool_->Create(top.index, top_order, bdd_->NextId(),
+                                  high.vertex, low.vertex);
+        ite->complement_edge(low.complement);
+        ite->module(top.module);
+        ite->coherent(top.coherent);
+        top_vertices.push_back(ite);
+        ++num_vertices_;
+      }
+      return {complement, ite};
+    };
+    std::vector<ItePtr> bottom_vertices = std::move(bottom.vertices);
+    for (ItePtr& ite : bottom_vertices)
+      ite->order(bottom_order);
+    for (ItePtr& ite : moving) {
+      auto [high_high, high_low] = Cofactor({false, ite->high()}, bottom.index);
+      auto [low_high, low_low] =
+          Cofactor({ite->complement_edge(), ite->low()}, bottom.index);
+      Function high = find_or_add(high_high, low_high);
+      Function low = find_or_add(high_low, low_low);
+      assert(!high.complement && "Irregular high edge.");
+      ite->Reset(bottom.index, bottom_order, high.vertex, low.vertex);
+      ite->complement_edge(low.complement);
+      ite->module(bottom.module);
+      ite->coherent(bottom.coherent);
+      bottom_vertices.push_back(std::move(ite));
+    }
+    top.vertices = std::move(bottom_vertices);
+    bottom.vertices = std::move(top_vertices);
+    std::swap(top.index, bottom.index);
+    std::swap(top.module, bottom.module);
+    std::swap(top.coherent, bottom.coherent);
+    index_to_level_[top.index] = upper;
+    index_to_level_[bottom.index] = upper + 1;
+    Collect(upper);
+  }
+
+  /// Releases dead vertices on a level
+  /// and the vertices below left dead by the release.
+  ///
+  /// @param[in] start  The level with potentially dead vertices.
+  void Collect(int start) {
+    std::set<int> dirty = {start};
+    while (!dirty.empty()) {
+      std::vector<ItePtr>& vertices = levels_[*dirty.begin()].vertices;
+      dirty.erase(dirty.begin());
+      auto it_live = vertices.begin();
+      for (ItePtr& ite : vertices) {
+        if (ite->use_count() > 1) {
+          *it_live++ = std::move(ite);
+          continue;
+        }
+        std::vector<Ite*> children;  // Terminals may die with the vertex.
+        for (const VertexPtr& child : {ite->high(), ite->low()}) {
+          if (!child->terminal())
+            children.push_back(&Ite::Ref(child));
+        }
+        ite.reset();
+        --num_vertices_;
+        for (Ite* child : children) {
+          if (child->use_count() == 1)
+            dirty.insert(index_to_level_.find(child->index())->second);
+        }
+      }
+      vertices.erase(it_live, vertices.end());
+    }
+  }
+
+  Bdd* bdd_;  ///< The host BDD.
+  std::vector<int> orders_;  ///< The ascending orders of levels.
+  std::vector<Level> levels_;  ///< The levels of the variable ordering.
+  std::unordered_map<int, int> index_to_level_;  ///< Variable levels.
+  int num_vertices_;  ///< The number of live vertices.
+};
+
+void Bdd::Reorder() {
+  CLOCK(reorder_time);
   ClearTables();
-  assert(result.vertex);
-  if (gate.module())
-    modules_.emplace(gate.index(), result);
-  if (gate.parents().size() > 1)
-    gates->insert({gate.index(), {result, 1}});
-  return result;
+  int num_vertices = 0;
+  {
+    Sifter sifter(this);
+    num_vertices = sifter.num_vertices();
+    sifter.Run(reorder_time_);
+    LOG(DEBUG4) << "Sifted BDD variables: " << num_vertices << " -> "
+                << sifter.num_vertices() << " vertices";
+    num_vertices = sifter.num_vertices();
+  }
+  reorder_time_ -= DUR(reorder_time);
+  reorder_threshold_ = std::max(kMinReorderSize, 2 * num_vertices);
+  LOG(DEBUG4) << "Reordered BDD in " << DUR(reorder_time);
 }
 
 std::pair<int, int> Bdd::GetMinMaxId(const VertexPtr& arg_one,
@@ -24,8 +24,13 @@
 #include <cmath>
 
 #include <algorithm>
-#include <forward_list>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <new>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -37,6 +42,10 @@
 #include "pdag.h"
 #include "settings.h"
 
+#if SCRAM_WITH_HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
 namespace scram::core {
 
 /// The default management of BDD vertices.
@@ -48,6 +57,132 @@ using IntrusivePtr = boost::intrusive_ptr<T>;
 template <class T>
 class Vertex;  // Manager of its own entry in the unique table.
 
+/// Slab allocator of BDD vertices of the same type.
+/// Vertices are carved out of large aligned slabs
+/// and recycled through a free list,
+/// which avoids per-vertex heap allocations
+/// and keeps the vertices of one BDD close in memory.
+///
+/// The pool is reference-counted by its owners and its live vertices;
+/// the slabs are released in bulk
+/// after the owner BDD and all the vertices of the pool are destroyed.
+///
+/// @tparam T  The type of the non-terminal vertex.
+///
+/// @note The pool is not thread-safe.
+///       Vertices of one pool must not be created or destroyed concurrently.
+template <class T>
+class VertexPool : private boost::noncopyable {
+  /// Reference counting for owners and live vertices.
+  ///
+  /// @param[in] pool  The pool managed by intrusive pointers.
+  /// @{
+  friend void intrusive_ptr_add_ref(VertexPool* pool) { ++pool->use_count_; }
+  friend void intrusive_ptr_release(VertexPool* pool) {
+    assert(pool->use_count_ > 0 && "Missing reference counts.");
+    if (--pool->use_count_ == 0)
+      delete pool;
+  }
+  /// @}
+
+ public:
+#if SCRAM_WITH_HUGE_PAGES
+  static constexpr std::size_t kSlabSize = 1 << 21;  ///< Huge page slabs.
+#else
+  static constexpr std::size_t kSlabSize = 1 << 16;  ///< Slab size and alignment.
+#endif
+
+  VertexPool() = default;
+
+  /// Releases all the slabs.
+  ~VertexPool() {
+    while (slabs_) {
+      Slab* slab = slabs_;
+      slabs_ = slab->next;
+      ::operator delete(slab, std::align_val_t(kSlabSize));
+    }
+  }
+
+  /// Constructs a new vertex in the pool.
+  ///
+  /// @param[in] args  The arguments for the vertex constructor.
+  ///
+  /// @returns The raw pointer to the new vertex.
+  template <typename... Args>
+  T* Create(Args&&... args) {
+    void* block = nullptr;
+    if (free_) {
+      block = free_;
+      free_ = free_->next;
+    } else {
+      if (end_ - next_ < static_cast<std::ptrdiff_t>(kBlockSize))
+        AddSlab();
+      block = next_;
+      next_ += kBlockSize;
+    }
+    T* vertex = new (block) T(std::forward<Args>(args)...);
+    intrusive_ptr_add_ref(this);
+    return vertex;
+  }
+
+  /// Destroys a vertex and returns its memory to the owning pool.
+  ///
+  /// @param[in] vertex  The vertex created by any pool.
+  static void Destroy(T* vertex) {
+    auto* slab = reinterpret_cast<Slab*>(
+        reinterpret_cast<std::uintptr_t>(vertex) & ~(kSlabSize - 1));
+    VertexPool* pool = slab->pool;
+    vertex->~T();
+    pool->free_ = new (vertex) FreeBlock{pool->free_};
+    intrusive_ptr_release(pool);
+  }
+
+ private:
+  /// The header at the beginning of each slab.
+  struct Slab {
+    VertexPool* pool;  ///< The owner pool.
+    Slab* next;  ///< The list of slabs of the pool.
+  };
+
+  /// The memory of a destroyed vertex in the free list.
+  struct FreeBlock {
+    FreeBlock* next;  ///< The next free block.
+  };
+
+  /// The memory reserved for each vertex.
+  static constexpr std::size_t kBlockSize =
+      std::max(sizeof(T), sizeof(FreeBlock));
+  /// The offset of the first vertex in a slab.
+  static constexpr std::size_t kHeaderSize =
+      (sizeof(Slab) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+  static_assert(alignof(T) <= kSlabSize);
+  static_assert(kHeaderSize + kBlockSize <= kSlabSize);
+
+  /// Allocates a new slab for vertices.
+  void AddSlab() {
+    void* memory = ::operator new(kSlabSize, std::align_val_t(kSlabSize));
+#if SCRAM_WITH_HUGE_PAGES && defined(MADV_HUGEPAGE)
+    ::madvise(memory, kSlabSize, MADV_HUGEPAGE);  // Only a hint.
+#endif
+    slabs_ = new (memory) Slab{this, slabs_};
+    next_ = static_cast<char*>(memory) + kHeaderSize;
+    end_ = static_cast<char*>(memory) + kSlabSize;
+  }
+
+  int use_count_ = 0;  ///< The number of owners and live vertices.
+  Slab* slabs_ = nullptr;  ///< All the allocated slabs.
+  FreeBlock* free_ = nullptr;  ///< Memory of destroyed vertices.
+  char* next_ = nullptr;  ///< Unused memory in the last slab.
+  char* end_ = nullptr;  ///< The end of the last slab.
+};
+
+/// Shared ownership of vertex pools.
+///
+/// @tparam T  The type of the non-terminal vertex.
+template <class T>
+using VertexPoolPtr = boost::intrusive_ptr<VertexPool<T>>;
+
 /// Provides pointer and reference cast wrappers for intrusive Vertex pointers.
 ///
 /// @tparam T  The type of the main functional BDD vertex.
@@ -112,6 +247,13 @@ class WeakIntrusivePtr final : private boost::noncopyable {
       vertex_->table_ptr_ = nullptr;
   }
 
+  /// Unregisters the vertex.
+  void reset() {
+    if (vertex_)
+      vertex_->table_ptr_ = nullptr;
+    vertex_ = nullptr;
+  }
+
   /// @returns true if the managed vertex is deleted or not initialized.
   bool expired() const { return !vertex_; }
 
@@ -138,6 +280,7 @@ class Terminal;  // Forward declaration for Vertex to manage.
 ///
 /// @pre Vertices are managed by reference counted pointers
 ///      provided by this class' interface.
+/// @pre Non-terminal vertices are created by VertexPool.
 /// @pre Vertices are not shared among separate BDD instances.
 template <class T>
 class Vertex : private boost::noncopyable {
@@ -159,7 +302,7 @@ class Vertex : private boost::noncopyable {
     assert(ptr->use_count_ > 0 && "Missing reference counts.");
     if (--ptr->use_count_ == 0) {
       if (!ptr->terminal()) {  // Likely.
-        delete static_cast<T*>(ptr);
+        VertexPool<T>::Destroy(static_cast<T*>(ptr));
       } else {
         delete static_cast<Terminal<T>*>(ptr);
       }
@@ -273,6 +416,14 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
     return order_;
   }
 
+  /// Moves the vertex to another level in the variable ordering.
+  ///
+  /// @param[in] value  The new positive order.
+  void order(int value) {
+    assert(value > 0);
+    order_ = value;
+  }
+
   /// @returns true if this vertex represents a module gate.
   bool module() const { return module_; }
 
@@ -296,6 +447,26 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   /// @returns (0/False/else/right) branch vertex.
   const VertexPtr& low() const { return low_; }
 
+  /// Replaces the decision variable and branches of this vertex in place,
+  /// for example, upon the swap of adjacent variables in the ordering.
+  /// The module and coherence flags are cleared.
+  ///
+  /// @param[in] index  Index of the new variable.
+  /// @param[in] order  Order of the new variable.
+  /// @param[in] high  A new vertex for the (1/True/then/left) branch.
+  /// @param[in] low  A new vertex for the (0/False/else/right) branch.
+  ///
+  /// @pre The function of the graph rooted at this vertex is unchanged.
+  /// @pre The vertex is not registered in a unique table.
+  void Reset(int index, int order, const VertexPtr& high, const VertexPtr& low) {
+    index_ = index;
+    order_ = order;
+    high_ = high;
+    low_ = low;
+    module_ = false;
+    coherent_ = false;
+  }
+
   /// @returns The mark of this vertex.
   bool mark() const { return mark_; }
 
@@ -346,26 +517,17 @@ class Ite : public NonTerminal<Ite> {
   /// @param[in] flag  Indicator to treat the low branch as a complement.
   void complement_edge(bool flag) { complement_edge_ = flag; }
 
-  /// @returns The probability of the function graph.
-  double p() const { return p_; }
-
-  /// Sets the probability of the function graph.
-  ///
-  /// @param[in] value  Calculated value for the probability.
-  void p(double value) { p_ = value; }
-
-  /// @returns Saved results of importance factor calculations.
-  double factor() const { return factor_; }
+  /// @returns The position of the vertex in the compact BDD array.
+  std::uint32_t handle() const { return handle_; }
 
-  /// Memorized results of importance factor calculations.
+  /// Sets the position of the vertex in the compact BDD array.
   ///
-  /// @param[in] value  Calculation results for importance factor.
-  void factor(double value) { factor_ = value; }
+  /// @param[in] value  The position of the appended vertex.
+  void handle(std::uint32_t value) { handle_ = value; }
 
  private:
   bool complement_edge_ = false;  ///< Flag for complement edge.
-  double p_ = 0;  ///< Probability of the function graph.
-  double factor_ = 0;  ///< Importance factor calculation results.
+  std::uint32_t handle_ = 0;  ///< Fills the padding; valid upon compaction.
 };
 
 using ItePtr = IntrusivePtr<Ite>;  ///< Shared if-then-else vertices.
@@ -394,12 +556,18 @@ int GetPrimeNumber(int n);
 ///
 /// @tparam T  The type of the main functional BDD vertex.
 template <class T>
-class UniqueTable {
-  /// Convenient aliases and customization points.
-  /// @{
-  using Bucket = std::forward_list<WeakIntrusivePtr<T>>;
-  using Table = std::vector<Bucket>;
-  /// @}
+class UniqueTable : private boost::noncopyable {
+  /// An entry in the chain of a bucket.
+  struct Entry {
+    Entry* next;  ///< The next entry in the chain or the free list.
+    WeakIntrusivePtr<T> vertex;  ///< The unique vertex.
+  };
+
+  /// The table of buckets with chains of entries.
+  using Table = std::vector<Entry*>;
+
+  /// The number of entries allocated at once.
+  static constexpr int kSlabSize = 1024;
 
  public:
   /// Constructor for small graphs.
@@ -409,15 +577,20 @@ class UniqueTable {
       : capacity_(core::GetPrimeNumber(init_capacity)),
         size_(0),
         max_load_factor_(0.75),
-        table_(capacity_) {}
+        table_(capacity_, nullptr) {}
 
   /// @returns The current number of entries.
   int size() const { return size_; }
 
   /// Erases all entries.
   void clear() {
-    for (Bucket& chain : table_)
-      chain.clear();
+    for (Entry*& chain : table_) {
+      while (chain) {
+        Entry* entry = chain;
+        chain = entry->next;
+        Free(entry);
+      }
+    }
     size_ = 0;
   }
 
@@ -431,7 +604,11 @@ class UniqueTable {
   ///       considering the responsibilities of the BDD.
   ///       The release keeps the data about the table,
   ///       such as its size and capacity.
-  void Release() { table_ = Table(); }
+  void Release() {
+    table_ = Table();
+    free_ = nullptr;
+    slabs_.clear();  // The entries communicate their destruction.
+  }
 
   /// Finds an existing BDD vertex or
   /// inserts a default constructed weak pointer for a new vertex.
@@ -453,56 +630,134 @@ class UniqueTable {
       Rehash(GetNextCapacity(capacity_));
 
     int bucket_number = Hash(index, high_id, low_id) % capacity_;
-    Bucket& chain = table_[bucket_number];
-    auto it_prev = chain.before_begin();  // Parent.
-    for (auto it_cur = chain.begin(), it_end = chain.end(); it_cur != it_end;) {
-      if (it_cur->expired()) {
-        it_cur = chain.erase_after(it_prev);
+    Entry** link = &table_[bucket_number];  // The link to the current entry.
+    while (Entry* entry = *link) {
+      if (entry->vertex.expired()) {
+        *link = entry->next;
+        Free(entry);
         --size_;
       } else {
-        T* vertex = it_cur->get();
+        T* vertex = entry->vertex.get();
         if (index == vertex->index() && high_id == get_high_id(*vertex) &&
             low_id == get_low_id(*vertex)) {
-          return *it_cur;
+          return entry->vertex;
         }
-        it_prev = it_cur;
-        ++it_cur;
+        link = &entry->next;
       }
     }
     ++size_;
-    return *chain.emplace_after(it_prev);
+    Entry* entry = Allocate();
+    entry->next = nullptr;
+    *link = entry;
+    return entry->vertex;
+  }
+
+  /// Takes all the live vertices out of the table.
+  ///
+  /// @returns Reference-counted pointers to the unregistered vertices.
+  ///
+  /// @post The table is empty.
+  std::vector<IntrusivePtr<T>> Extract() {
+    std::vector<IntrusivePtr<T>> vertices;
+    vertices.reserve(size_);
+    for (Entry* entry : table_) {
+      for (; entry; entry = entry->next) {
+        if (!entry->vertex.expired())
+          vertices.push_back(entry->vertex.lock());
+      }
+    }
+    clear();
+    return vertices;
+  }
+
+  /// Takes over all the entries of another unique table.
+  ///
+  /// @param[in,out] other  The table with vertices of the same BDD.
+  ///
+  /// @pre The signatures of vertices in the tables are disjoint.
+  ///
+  /// @post The other table is empty.
+  void Merge(UniqueTable* other) {
+    int new_size = size_ + other->size_;
+    if (new_size >= (max_load_factor_ * capacity_))
+      Rehash(core::GetPrimeNumber(new_size / max_load_factor_ + 1));
+    size_ += Splice(&other->table_, &table_);
+    other->size_ = 0;
+    // The relinked entries stay in the memory of the other table.
+    std::move(other->slabs_.begin(), other->slabs_.end(),
+              std::back_inserter(slabs_));
+    other->slabs_.clear();
+    while (Entry* entry = other->free_) {
+      other->free_ = entry->next;
+      entry->next = free_;
+      free_ = entry;
+    }
   }
 
  private:
+  /// @returns A free entry with an expired pointer.
+  Entry* Allocate() {
+    if (!free_) {
+      auto& slab = slabs_.emplace_back(new Entry[kSlabSize]);
+      for (int i = 0; i < kSlabSize; ++i) {
+        slab[i].next = free_;
+        free_ = &slab[i];
+      }
+    }
+    Entry* entry = free_;
+    free_ = entry->next;
+    return entry;
+  }
+
+  /// Puts an entry into the free list.
+  ///
+  /// @param[in,out] entry  The entry removed from its chain.
+  void Free(Entry* entry) {
+    entry->vertex.reset();
+    entry->next = free_;
+    free_ = entry;
+  }
+
   /// Rehashes the table for the new number of buckets.
   /// Upon rehashing the expired nodes are not moved to the new table.
   ///
   /// @param[in] new_capacity  The desired number of buckets.
   void Rehash(int new_capacity) {
-    int new_size = 0;
-    Table new_table(new_capacity);
-    for (Bucket& chain : table_) {
-      for (auto it_prev = chain.before_begin(), it_cur = chain.begin(),
-                it_end = chain.end();
-           it_cur != it_end;) {
-        if (it_cur->expired()) {
-          it_prev = it_cur;
-          ++it_cur;
+    Table new_table(new_capacity, nullptr);
+    int new_size = Splice(&table_, &new_table);
+    table_.swap(new_table);
+    size_ = new_size;
+    capacity_ = new_capacity;
+  }
+
+  /// Moves the non-expired entries from one table into another.
+  /// The entries are relinked rather than copied,
+  /// so the vertices keep valid pointers to their entries.
+  /// The expired entries are freed.
+  ///
+  /// @param[in,out] source  The table to move the entries from.
+  /// @param[in,out] target  The non-empty destination table.
+  ///
+  /// @returns The number of moved entries.
+  int Splice(Table* source, Table* target) {
+    int num_moved = 0;
+    for (Entry*& chain : *source) {
+      while (Entry* entry = chain) {
+        chain = entry->next;
+        if (entry->vertex.expired()) {
+          Free(entry);
           continue;
         }
-        ++new_size;
-        T* vertex = it_cur->get();
+        ++num_moved;
+        T* vertex = entry->vertex.get();
         int bucket_number =
             Hash(vertex->index(), get_high_id(*vertex), get_low_id(*vertex)) %
-            new_capacity;
-        Bucket& new_chain = new_table[bucket_number];
-        new_chain.splice_after(new_chain.before_begin(), chain, it_prev,
-                               ++it_cur);
+            target->size();
+        entry->next = (*target)[bucket_number];
+        (*target)[bucket_number] = entry;
       }
     }
-    table_.swap(new_table);
-    size_ = new_size;
-    capacity_ = new_capacity;
+    return num_moved;
   }
 
   /// Computes the hash value of the key.
@@ -527,8 +782,11 @@ class UniqueTable {
   /// @returns The new capacity scaled by the growth factor function.
   ///
   /// @note The growth tries to take into account the growth patterns of BDD.
+  ///       Small tables grow fast,
+  ///       but large tables only double
+  ///       not to hold mostly empty buckets at the peak of BDD construction.
   int GetNextCapacity(int prev_capacity) {
-    const int kMaxScaleCapacity = 1e8;
+    const int kMaxScaleCapacity = 1e6;
     int scale_power = 1;  // The default power after the max scale capacity.
     if (prev_capacity < kMaxScaleCapacity) {
       scale_power += std::log10(kMaxScaleCapacity / prev_capacity);
@@ -542,6 +800,13 @@ class UniqueTable {
   int size_;  ///< The total number of elements in the table.
   double max_load_factor_;  ///< The limit on the avg. # of elements per bucket.
 
+  /// The entries of the table and the free list
+  /// are carved out of slabs
+  /// to avoid per-entry heap allocations.
+  /// The slabs are destroyed after the table that points into them.
+  std::vector<std::unique_ptr<Entry[]>> slabs_;
+  Entry* free_ = nullptr;  ///< The list of unused entries.
+
   /// A table of unique vertices is stored with weak pointers
   /// so that this hash table does not interfere
   /// with BDD node management with shared pointers.
@@ -551,6 +816,8 @@ class UniqueTable {
 /// A hash table without collision resolution.
 /// Instead of resolving the collision,
 /// the existing value is purged and replaced by the new entry.
+/// The table stops growing at its maximum capacity,
+/// so the results it keeps alive are bounded as well.
 ///
 /// This hash table is designed to store computation results of BDD Apply.
 /// The implementation of the table
@@ -580,10 +847,12 @@ class CacheTable {
 
   /// Constructor with average expectations for computations.
   ///
-  /// @param[in] init_capacity
-  explicit CacheTable(int init_capacity = 1000)
+  /// @param[in] init_capacity  The starting capacity for the table.
+  /// @param[in] max_capacity  The capacity after which the table stops growing.
+  explicit CacheTable(int init_capacity = 1000, int max_capacity = 1 << 18)
       : size_(0),
         max_load_factor_(0.75),
+        max_capacity_(max_capacity),
         table_(core::GetPrimeNumber(init_capacity)) {}
 
   /// @returns The number of entires in the table.
@@ -643,7 +912,8 @@ class CacheTable {
   void emplace(const key_type& key, const mapped_type& value) {
     assert(value && "Empty computation results!");
 
-    if (size_ >= (max_load_factor_ * table_.size()))
+    if (size_ >= (max_load_factor_ * table_.size()) &&
+        table_.size() < max_capacity_)
       Rehash(core::GetPrimeNumber(table_.size() * 2));
 
     int index = boost::hash_value(key) % table_.size();
@@ -677,6 +947,7 @@ class CacheTable {
 
   int size_;  ///< The total number of elements in the table.
   double max_load_factor_;  ///< The limit on (size / capacity) ratio.
+  std::size_t max_capacity_;  ///< The limit on the growth of the table.
   std::vector<value_type> table_;  ///< The main container.
 };
 
@@ -711,6 +982,25 @@ class Bdd : private boost::noncopyable {
     }
   };
 
+  /// If-then-else vertex of the compact representation.
+  /// Vertices are stored contiguously in the topological order
+  /// (branches and modules before their parents)
+  /// and addressed by 32-bit handles (positions in the array).
+  /// The terminal vertex has handle 0.
+  /// An edge is a handle shifted left
+  /// with the complement flag in the lowest bit.
+  struct Node {
+    std::uint32_t high;  ///< The handle of the high (then) branch.
+    std::uint32_t low;  ///< The edge to the low (else) branch.
+    std::uint32_t module;  ///< The edge to the module graph or kNoModule.
+    int index;  ///< The index of the variable or module.
+    int order;  ///< The order of the variable or module.
+  };
+
+  /// The module edge of variable vertices.
+  static constexpr std::uint32_t kNoModule =
+      std::numeric_limits<std::uint32_t>::max();
+
   /// Provides access to consensus calculation private facilities.
   class Consensus {
     friend class Zbdd;  // Access for calculation of prime implicants.
@@ -736,17 +1026,60 @@ class Bdd : private boost::noncopyable {
   /// @pre The PDAG has variable ordering.
   ///
   /// @note BDD construction may take considerable time.
-  Bdd(const Pdag* graph, const Settings& settings);
+  Bdd(const Pdag* graph, const Settings& settings)
+      : Bdd(FrozenPdag(*graph), settings) {}
+
+  /// Constructs the ROBDD from a snapshot of the PDAG,
+  /// which lets the PDAG be destroyed before the BDD construction.
+  /// A multi-root graph is converted into one BDD with a root per pin,
+  /// so the common gates of the roots are converted only once.
+  ///
+  /// @param[in] graph  The snapshot of the preprocessed PDAG.
+  /// @param[in] settings  The analysis settings.
+  Bdd(const FrozenPdag& graph, const Settings& settings);
 
   /// To handle incomplete ZBDD type with unique pointers.
   ~Bdd() ;
 
   /// @returns The root function of the ROBDD.
-  const Function& root() const { return root_; }
+  ///
+  /// @pre The BDD is not compact.
+  const Function& root() const { return roots_.front(); }
+
+  /// @returns The root functions in the order of the PDAG roots.
+  ///          A single-root graph has only one root function.
+  ///
+  /// @pre The BDD is not compact.
+  const std::vector<Function>& roots() const { return roots_; }
 
   /// @returns Mapping of PDAG modules and BDD graph vertices.
+  ///
+  /// @pre The BDD is not compact.
   const std::unordered_map<int, Function>& modules() const { return modules_; }
 
+  /// Converts the function graphs into the compact vertex array
+  /// and releases the if-then-else vertices.
+  /// Repeated calls have no effect.
+  ///
+  /// @pre The analysis of products is done.
+  /// @pre No more computations with if-then-else vertices.
+  void Compact();
+
+  /// @returns true if the BDD has been converted into the compact form.
+  bool compact() const { return !nodes_.empty(); }
+
+  /// @returns The vertices of the compact BDD.
+  ///
+  /// @pre The BDD is compact.
+  const std::vector<Node>& nodes() const { return nodes_; }
+
+  /// @param[in] root  The index of the root in the order of the PDAG roots.
+  ///
+  /// @returns The edge to the root of the compact BDD.
+  ///
+  /// @pre The BDD is compact.
+  std::uint32_t root_edge(int root = 0) const { return root_edges_[root]; }
+
   /// @returns Mapping of variable indices to their orders.
   const std::unordered_map<int, int>& index_to_order() const {
     return index_to_order_;
@@ -763,20 +1096,33 @@ class Bdd : private boost::noncopyable {
   ///
   /// @warning If the graph is discontinuously and partially marked,
   ///          this function will not help with the mess.
-  void ClearMarks(bool mark) { ClearMarks(root_.vertex, mark); }
+  void ClearMarks(bool mark) {
+    for (const Function& root : roots_)
+      ClearMarks(root.vertex, mark);
+  }
 
   /// Runs the Qualitative analysis
   /// with the representation of a PDAG as ROBDD.
   ///
   /// @param[in] graph  The optional PDAG with non-declarative substitutions.
+  ///
+  /// @post The BDD is compact
+  ///       if the products are followed by the exact probability analysis.
   void Analyze(const Pdag* graph = nullptr) ;
 
   /// @returns Products generated by the analysis.
   ///
   /// @pre Analysis is done.
-  const Zbdd& products() const {
-    assert(zbdd_ && "Analysis is not done.");
-    return *zbdd_;
+  const Zbdd& products() const { return products(0); }
+
+  /// @param[in] root  The index of the root in the order of the PDAG roots.
+  ///
+  /// @returns Products of the root generated by the analysis.
+  ///
+  /// @pre Analysis is done.
+  const Zbdd& products(int root) const {
+    assert(!zbdds_.empty() && "Analysis is not done.");
+    return *zbdds_[root];
   }
 
  private:
@@ -826,22 +1172,80 @@ class Bdd : private boost::noncopyable {
   /// @pre The gate is a module.
   ///
   /// @warning This function is not aware of reduction rules.
-  ItePtr FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                         const VertexPtr& low, bool complement_edge) ;
+  ItePtr FindOrAddVertex(const FrozenPdag::GateInfo& gate,
+                         const VertexPtr& high, const VertexPtr& low,
+                         bool complement_edge);
 
-  /// Converts all gates in the PDAG
+  /// Converts a range of gates in the topological order
   /// into function BDD graphs.
-  /// Registers processed gates.
+  /// The function of a gate is released
+  /// as soon as all its parents are converted.
   ///
-  /// @param[in] gate  The root or current parent gate of the graph.
-  /// @param[in,out] gates  Processed gates with use counts.
+  /// @param[in] graph  The snapshot of the PDAG.
+  /// @param[in] first  The position of the first gate to convert.
+  /// @param[in] last  The position past the last gate to convert.
+  /// @param[in,out] gates  The functions of gates with processed parent counts.
+  ///                        Gates with negative counts are skipped.
   ///
-  /// @returns The BDD function representing the gate.
+  /// @pre The arguments of the gates are converted or in the range.
+  void ConvertGates(const FrozenPdag& graph, int first, int last,
+                    std::vector<std::pair<Function, int>>* gates);
+
+  /// Constructs a worker BDD
+  /// to convert independent modules concurrently with other workers.
+  /// The worker has its own terminal vertex and tables,
+  /// so no vertex is shared between threads.
   ///
-  /// @pre The memoization container is not used outside of this function.
-  Function ConvertGraph(
-      const Gate& gate,
-      std::unordered_map<int, std::pair<Function, int>>* gates) ;
+  /// @param[in] host  The BDD to adopt the worker results.
+  explicit Bdd(Bdd* host);
+
+  /// Converts independent module gates of the PDAG
+  /// on separate threads ahead of the main graph conversion.
+  /// The converted vertices are merged into this BDD,
+  /// and the module functions are registered as already processed gates.
+  ///
+  /// @param[in] graph  The snapshot of the PDAG.
+  /// @param[in,out] gates  The functions of gates with processed parent counts.
+  ///
+  /// @returns The ascending positions of the converted modules.
+  ///
+  /// @pre More than one thread is available to the calling thread.
+  std::vector<int> ConvertModules(
+      const FrozenPdag& graph, std::vector<std::pair<Function, int>>* gates);
+
+  /// Marks the gates unreachable from the pinned roots of a multi-root graph
+  /// to be skipped by the conversion.
+  /// The arguments of the skipped gates count them as processed parents.
+  ///
+  /// @param[in] graph  The snapshot of the multi-root PDAG.
+  /// @param[in,out] gates  The functions of gates with processed parent counts.
+  static void SkipUnreachableGates(
+      const FrozenPdag& graph, std::vector<std::pair<Function, int>>* gates);
+
+  class Sifter;  // Dynamic reordering of variables.
+
+  /// Reorders the variables of the BDD with sifting
+  /// to reduce the number of vertices.
+  /// The functions of existing vertices do not change;
+  /// only the levels of the vertices and their branches do.
+  ///
+  /// @pre No Apply computations are in progress.
+  ///
+  /// @post Computation tables are cleared.
+  /// @post The threshold for the next reordering is set.
+  void Reorder();
+
+  /// @param[in] index  The index of a variable or module.
+  /// @param[in] order  The order of the variable or module in the PDAG.
+  ///
+  /// @returns The current order of the variable in the BDD.
+  int GetOrder(int index, int order) const {
+    auto it = orders_.find(index);
+    return it == orders_.end() ? order : it->second;
+  }
+
+  /// @returns A new unique identification for a function graph.
+  int NextId() { return host_ ? host_->NextId() : function_id_++; }
 
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
@@ -944,6 +1348,17 @@ class Bdd : private boost::noncopyable {
   /// @pre Non-terminal node marks are clear (false).
   void TestStructure(const VertexPtr& vertex) ;
 
+  /// Appends the function graph to the compact vertex array.
+  /// The appended vertices are unmarked
+  /// and keep their handles for the other parents.
+  ///
+  /// @param[in] vertex  The root vertex of the function graph.
+  ///
+  /// @returns The handle of the vertex in the compact array.
+  ///
+  /// @pre The vertices yet to be appended are marked.
+  std::uint32_t CompactGraph(const VertexPtr& vertex);
+
   /// Clears all memoization tables.
   void ClearTables()  {
     and_table_.clear();
@@ -962,7 +1377,7 @@ class Bdd : private boost::noncopyable {
   }
 
   const Settings kSettings_;  ///< Analysis settings.
-  Function root_;  ///< The root function of this BDD.
+  std::vector<Function> roots_;  ///< The root functions of this BDD.
   bool coherent_;  ///< Inherited coherence from PDAG.
 
   /// Table of unique if-then-else nodes denoting function graphs.
@@ -970,6 +1385,7 @@ class Bdd : private boost::noncopyable {
   /// where IDs are unique (id_high != id_low) identifications of
   /// unique reduced-ordered function graphs.
   UniqueTable<Ite> unique_table_;
+  VertexPoolPtr<Ite> pool_;  ///< The memory of if-then-else vertices.
 
   /// Tables of processed computations over functions.
   /// The argument functions are recorded with their IDs (not vertex indices).
@@ -983,9 +1399,17 @@ class Bdd : private boost::noncopyable {
 
   std::unordered_map<int, Function> modules_;  ///< Module graphs.
   std::unordered_map<int, int> index_to_order_;  ///< Indices and orders.
+  std::unordered_map<int, int> orders_;  ///< Orders changed by reordering.
+  double reorder_time_;  ///< The remaining time budget for reordering.
+  int reorder_threshold_;  ///< The unique table size to trigger reordering.
   const TerminalPtr kOne_;  ///< Terminal True.
-  int function_id_;  ///< Identification assignment for new function graphs.
-  std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
+  /// Identification assignment for new function graphs.
+  /// Workers draw identifications from their host.
+  std::atomic<int> function_id_;
+  Bdd* host_;  ///< The BDD adopting results of this worker BDD.
+  std::vector<std::unique_ptr<Zbdd>> zbdds_;  ///< ZBDD per root.
+  std::vector<Node> nodes_;  ///< The compact BDD.
+  std::vector<std::uint32_t> root_edges_;  ///< The roots of the compact BDD.
 };
 
 }  // namespace scram::core
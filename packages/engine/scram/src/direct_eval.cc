@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2025 OpenPRA ORG Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the bit-parallel Monte Carlo direct evaluation.
+
+#include "direct_eval.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/math/distributions/normal.hpp>
+
+#include "error.h"
+#include "logger.h"
+
+namespace scram::core {
+
+namespace {  // The xoshiro256** generator seeded with SplitMix64.
+
+/// @returns The next value of the SplitMix64 sequence.
+std::uint64_t SplitMix64(std::uint64_t* state) {
+  std::uint64_t z = (*state += 0x9E3779B97F4A7C15);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+/// Initializes the generator state from a user seed.
+void Seed(std::uint64_t (&state)[4], std::uint64_t seed) {
+  for (std::uint64_t& word : state)
+    word = SplitMix64(&seed);
+}
+
+/// @returns The next 64 random bits.
+std::uint64_t Next(std::uint64_t (&s)[4]) {
+  const std::uint64_t result = std::rotl(s[1] * 5, 7) * 9;
+  const std::uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = std::rotl(s[3], 45);
+  return result;
+}
+
+/// @returns A uniform random number in (0, 1].
+double NextUniform(std::uint64_t (&s)[4]) {
+  return static_cast<double>((Next(s) >> 11) + 1) * 0x1p-53;
+}
+
+/// Probabilities below this threshold are sampled
+/// by skipping geometrically distributed gaps between successes
+/// instead of drawing every bit.
+const double kSparseThreshold = 1.0 / 64;
+
+/// @returns The complement mask of an encoded argument.
+inline std::uint64_t Mask(int arg) {
+  return -static_cast<std::uint64_t>(arg & 1);
+}
+
+}  // namespace
+
+DirectEval::DirectEval(const Pdag* graph, const Settings& settings)
+    : kSettings_(settings), batch_size_(settings.batch_size()), rng_() {
+  TIMER(DEBUG3, "Compiling PDAG for direct evaluation");
+  Compile(*graph);
+  std::fill_n(slot(0), batch_size_, ~std::uint64_t(0));  // The constant TRUE.
+  LOG(DEBUG4) << "# of instructions: " << program_.size();
+  LOG(DEBUG4) << "# of sampled variables: " << variables_.size();
+}
+
+void DirectEval::Analyze(const Pdag* /*graph*/)  {
+  LOG(DEBUG3) << "Direct evaluation does not generate products.";
+}
+
+const Zbdd& DirectEval::products() const {
+  SCRAM_THROW(
+      IllegalOperation("Direct evaluation does not generate products."));
+}
+
+void DirectEval::Compile(const Pdag& graph)  {
+  assert(graph.constant()->index() == Pdag::kVariableStartIndex - 1);
+  // Slots: the constant, the variables by their index, then the gates.
+  const int num_vars = graph.basic_events().size();
+  int num_slots = num_vars + 1;
+  std::vector<bool> used(num_slots, false);
+  std::unordered_map<int, int> gate_slots;  // Compiled gates.
+  auto encode = [&gate_slots, &used](int arg) {
+    int index = std::abs(arg);
+    int arg_slot = 0;
+    if (auto it = gate_slots.find(index); it != gate_slots.end()) {
+      arg_slot = it->second;
+    } else {
+      arg_slot = index - 1;  // The constant or variable.
+      assert(arg_slot < used.size());
+      used[arg_slot] = true;
+    }
+    return arg_slot << 1 | (arg < 0);
+  };
+
+  // Post-order traversal with an explicit stack of (gate, expanded) entries.
+  // The roots of a multi-root graph are compiled through their pins
+  // because the graph root may have lost the roots to constant propagation.
+  std::vector<std::pair<const Gate*, bool>> stack;
+  if (graph.roots().empty()) {
+    stack.emplace_back(&graph.root(), false);
+  } else {
+    for (const GatePtr& pin : graph.roots()) {
+      for (const Gate::Arg<Gate>& arg : pin->args<Gate>())
+        stack.emplace_back(arg.second.get(), false);
+    }
+  }
+  while (!stack.empty()) {
+    auto& [gate, expanded] = stack.back();
+    if (gate_slots.count(gate->index())) {
+      stack.pop_back();
+      continue;
+    }
+    if (!expanded) {
+      expanded = true;
+      const Gate* parent = gate;  // The reference is invalidated on push.
+      for (const Gate::ConstArg<Gate>& arg : parent->args<Gate>()) {
+        if (!gate_slots.count(arg.second.index()))
+          stack.emplace_back(&arg.second, false);
+      }
+      continue;
+    }
+    Instruction instruction{gate->type(),
+                            gate->type() == kAtleast ? gate->min_number() : 0,
+                            num_slots,
+                            static_cast<std::uint32_t>(args_.size()), 0};
+    for (int arg : gate->args())
+      args_.push_back(encode(arg));
+    instruction.args_end = args_.size();
+    program_.push_back(instruction);
+    gate_slots.emplace(gate->index(), num_slots++);
+    stack.pop_back();
+  }
+  if (graph.roots().empty()) {
+    roots_.push_back((gate_slots.at(graph.root().index()) << 1) |
+                     graph.complement());
+  } else {
+    for (const GatePtr& pin : graph.roots()) {
+      assert(pin->type() == kNull && pin->args().size() == 1);
+      roots_.push_back(encode(*pin->args().begin()));
+    }
+  }
+  for (int i = 1; i <= num_vars; ++i) {
+    if (used[i])
+      variables_.push_back(i + 1);
+  }
+  words_.resize(static_cast<std::size_t>(num_slots) * batch_size_);
+}
+
+void DirectEval::SampleVariables(const Pdag::IndexMap<double>& p_vars)  {
+  const std::int64_t num_bits = 64 * static_cast<std::int64_t>(batch_size_);
+  for (int index : variables_) {
+    std::uint64_t* words = slot(index - 1);
+    const double p = p_vars[index];
+    if (p <= 0) {
+      std::fill_n(words, batch_size_, 0);
+    } else if (p >= 1) {
+      std::fill_n(words, batch_size_, ~std::uint64_t(0));
+    } else if (p < kSparseThreshold) {
+      std::fill_n(words, batch_size_, 0);
+      const double log_q = std::log1p(-p);
+      auto skip = [this, log_q, num_bits] {
+        double gap = std::floor(std::log(NextUniform(rng_)) / log_q);
+        return gap < num_bits ? static_cast<std::int64_t>(gap) : num_bits;
+      };
+      for (std::int64_t bit = skip(); bit < num_bits; bit += 1 + skip())
+        words[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+    } else {
+      // Bit-sliced comparison of 64 random 32-bit fractions with p.
+      // The comparison is resolved by the leading bits for most lanes,
+      // so only a few random words are consumed per sample word.
+      const auto threshold = static_cast<std::uint32_t>(std::ldexp(p, 32));
+      for (int w = 0; w < batch_size_; ++w) {
+        std::uint64_t less = 0;
+        std::uint64_t equal = ~std::uint64_t(0);
+        for (int bit = 31; bit >= 0 && equal; --bit) {
+          std::uint64_t random = Next(rng_);
+          if (threshold >> bit & 1) {
+            less |= equal & ~random;
+            equal &= random;
+          } else {
+            equal &= ~random;
+          }
+        }
+        words[w] = less;
+      }
+    }
+  }
+}
+
+void DirectEval::EvaluateBatch()  {
+  const int n = batch_size_;
+  std::vector<std::uint64_t> counters;  // Vote counters for ATLEAST gates.
+  for (const Instruction& instruction : program_) {
+    std::uint64_t* out = slot(instruction.output);
+    const int* first = args_.data() + instruction.args_begin;
+    const int* last = args_.data() + instruction.args_end;
+    auto load = [this](int arg) { return slot(arg >> 1); };
+    switch (instruction.type) {
+      case kAnd:
+      case kNand:
+        std::fill_n(out, n, ~std::uint64_t(0));
+        for (const int* arg = first; arg != last; ++arg) {
+          const std::uint64_t* in = load(*arg);
+          const std::uint64_t mask = Mask(*arg);
+          for (int w = 0; w < n; ++w)
+            out[w] &= in[w] ^ mask;
+        }
+        break;
+      case kOr:
+      case kNor:
+        std::fill_n(out, n, 0);
+        for (const int* arg = first; arg != last; ++arg) {
+          const std::uint64_t* in = load(*arg);
+          const std::uint64_t mask = Mask(*arg);
+          for (int w = 0; w < n; ++w)
+            out[w] |= in[w] ^ mask;
+        }
+        break;
+      case kXor:
+        std::fill_n(out, n, 0);
+        for (const int* arg = first; arg != last; ++arg) {
+          const std::uint64_t* in = load(*arg);
+          const std::uint64_t mask = Mask(*arg);
+          for (int w = 0; w < n; ++w)
+            out[w] ^= in[w] ^ mask;
+        }
+        break;
+      case kNot:
+      case kNull: {
+        assert(last - first == 1);
+        const std::uint64_t* in = load(*first);
+        const std::uint64_t mask = Mask(*first);
+        for (int w = 0; w < n; ++w)
+          out[w] = in[w] ^ mask;
+        break;
+      }
+      case kAtleast: {
+        // counters[j] marks the lanes with at least j + 1 true arguments.
+        const int k = instruction.min_number;
+        assert(k > 0);
+        counters.resize(k);
+        for (int w = 0; w < n; ++w) {
+          std::fill(counters.begin(), counters.end(), 0);
+          for (const int* arg = first; arg != last; ++arg) {
+            const std::uint64_t x = load(*arg)[w] ^ Mask(*arg);
+            for (int j = k - 1; j > 0; --j)
+              counters[j] |= counters[j - 1] & x;
+            counters[0] |= x;
+          }
+          out[w] = counters[k - 1];
+        }
+        break;
+      }
+    }
+    if (instruction.type == kNand || instruction.type == kNor ||
+        instruction.type == kNot) {
+      for (int w = 0; w < n; ++w)
+        out[w] = ~out[w];
+    }
+  }
+}
+
+std::int64_t DirectEval::CountSuccesses(int root)  {
+  std::int64_t successes = 0;
+  const std::uint64_t* words = slot(root >> 1);
+  const std::uint64_t mask = Mask(root);
+  for (int w = 0; w < batch_size_; ++w)
+    successes += std::popcount(words[w] ^ mask);
+  return successes;
+}
+
+ProbabilityEstimate DirectEval::Estimate(
+    const Pdag::IndexMap<double>& p_vars, int target)  {
+  assert(target >= 0 && target < roots_.size() && "Invalid target.");
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (estimates_.empty() || !std::ranges::equal(p_vars, p_vars_)) {
+    Sample(p_vars);
+    p_vars_ = p_vars;
+  }
+  return estimates_[target];
+}
+
+void DirectEval::Sample(const Pdag::IndexMap<double>& p_vars)  {
+  CLOCK(calc_time);
+  LOG(DEBUG4) << "Estimating probability with direct evaluation...";
+  Seed(rng_, kSettings_.seed());
+  const double confidence = kSettings_.confidence();
+  const double z =
+      boost::math::quantile(boost::math::normal(), 0.5 + confidence / 2);
+  estimates_.assign(roots_.size(), ProbabilityEstimate{});
+  for (ProbabilityEstimate& estimate : estimates_)
+    estimate.confidence = confidence;
+  // Wilson score interval; robust for rare events with few successes.
+  auto update = [z](ProbabilityEstimate* estimate) {
+    const double n = estimate->num_samples;
+    const double p = estimate->num_successes / n;
+    const double z2n = z * z / n;
+    const double center = (p + z2n / 2) / (1 + z2n);
+    const double half_width =
+        z * std::sqrt(p * (1 - p) / n + z2n / (4 * n)) / (1 + z2n);
+    estimate->value = p;
+    estimate->std_error = std::sqrt(p * (1 - p) / n);
+    estimate->lower_bound = estimate->num_successes == 0
+                                ? 0
+                                : std::max(0.0, center - half_width);
+    estimate->upper_bound = estimate->num_successes == estimate->num_samples
+                                ? 1
+                                : std::min(1.0, center + half_width);
+    return half_width;
+  };
+  const std::int64_t batch_samples = 64 * static_cast<std::int64_t>(batch_size_);
+  if (variables_.empty()) {  // Every trial has the same outcome.
+    EvaluateBatch();
+    for (int i = 0; i < roots_.size(); ++i) {
+      ProbabilityEstimate& estimate = estimates_[i];
+      estimate.num_samples = batch_samples;
+      estimate.num_successes = CountSuccesses(roots_[i]);
+      estimate.value = estimate.num_successes ? 1 : 0;
+      estimate.lower_bound = estimate.upper_bound = estimate.value;
+    }
+    return;
+  }
+  for (int batch = 0; batch < kSettings_.sample_size(); ++batch) {
+    SampleVariables(p_vars);
+    EvaluateBatch();
+    bool converged = kSettings_.delta() > 0;
+    for (int i = 0; i < roots_.size(); ++i) {
+      ProbabilityEstimate& estimate = estimates_[i];
+      estimate.num_successes += CountSuccesses(roots_[i]);
+      estimate.num_samples += batch_samples;
+      double half_width = update(&estimate);
+      if (!estimate.num_successes ||
+          half_width > kSettings_.delta() * estimate.value)
+        converged = false;
+    }
+    if (converged) {
+      LOG(DEBUG4) << "Reached the target precision after " << batch + 1
+                  << " batches.";
+      break;
+    }
+  }
+  LOG(DEBUG4) << "Estimated probabilities of " << roots_.size()
+              << " target(s) with " << estimates_.front().num_samples
+              << " samples in " << DUR(calc_time);
+}
+
+}  // namespace scram::core
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2025 OpenPRA ORG Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Monte Carlo direct evaluation of PDAG probabilities.
+/// The preprocessed graph is flattened into a straight-line program
+/// over bit-packed samples,
+/// so that every machine word evaluates 64 independent trials
+/// of the Boolean function with a handful of bitwise instructions.
+
+#pragma once
+
+#include <cstdint>
+
+#include <mutex>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "pdag.h"
+#include "settings.h"
+
+namespace scram::core {
+
+class Zbdd;
+
+/// Sampling estimate of a probability with its confidence interval.
+struct ProbabilityEstimate {
+  double value = 0;  ///< The point estimate (the fraction of successes).
+  double std_error = 0;  ///< The standard error of the point estimate.
+  double confidence = 0;  ///< The confidence level of the interval.
+  double lower_bound = 0;  ///< The lower bound of the confidence interval.
+  double upper_bound = 0;  ///< The upper bound of the confidence interval.
+  std::int64_t num_samples = 0;  ///< The number of evaluated trials.
+  std::int64_t num_successes = 0;  ///< The number of trials with the event.
+};
+
+/// Bit-parallel Monte Carlo evaluator of PDAG probabilities.
+///
+/// The evaluator serves two roles in the analysis pipeline:
+/// the qualitative algorithm for PDAG-only analysis
+/// (no products are generated),
+/// and the calculator of total probabilities
+/// for any preprocessed PDAG.
+///
+/// Multi-root graphs are compiled into one program,
+/// so all the roots are estimated from the same samples.
+class DirectEval : private boost::noncopyable {
+ public:
+  /// Compiles a PDAG into a flat evaluation program.
+  ///
+  /// @param[in] graph  Preprocessed PDAG.
+  /// @param[in] settings  The analysis settings with sampling parameters.
+  ///
+  /// @note The graph may contain any connectives and complements.
+  ///
+  /// @post The targets of estimation are the graph roots if any,
+  ///       or the single graph root otherwise.
+  DirectEval(const Pdag* graph, const Settings& settings);
+
+  /// @returns The number of estimation targets.
+  int num_targets() const { return roots_.size(); }
+
+  /// Direct evaluation does not generate products.
+  /// The function exists to fit the analysis algorithm interface.
+  ///
+  /// @param[in] graph  Unused.
+  void Analyze(const Pdag* graph = nullptr) ;
+
+  /// @throws IllegalOperation  Products are never available.
+  [[nodiscard]] const Zbdd& products() const;
+
+  /// @throws IllegalOperation  Products are never available.
+  [[nodiscard]] const Zbdd& products(int /*root*/) const { return products(); }
+
+  /// Estimates the probability of the graph function.
+  /// The generator is reseeded with the same seed upon every call,
+  /// so that repeated estimates with different variable probabilities
+  /// use common random numbers.
+  ///
+  /// All the targets are estimated together;
+  /// the results for the last variable probabilities are cached
+  /// for the consecutive requests of the other targets.
+  /// Concurrent requests are serialized.
+  ///
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  /// @param[in] target  The index of the estimation target.
+  ///
+  /// @returns The sampling estimate of the probability
+  ///          without the initiating event frequency.
+  ProbabilityEstimate Estimate(const Pdag::IndexMap<double>& p_vars,
+                               int target = 0);
+
+ private:
+  /// A single gate operation in topological order.
+  /// Arguments are encoded as (slot << 1 | complement).
+  struct Instruction {
+    Connective type;  ///< The gate logic.
+    int min_number;  ///< The vote number for ATLEAST gates.
+    int output;  ///< The slot for the result.
+    std::uint32_t args_begin;  ///< The first argument in the argument pool.
+    std::uint32_t args_end;  ///< One past the last argument.
+  };
+
+  /// Flattens the graph into instructions with an iterative post-order walk.
+  ///
+  /// @param[in] graph  The graph to compile.
+  void Compile(const Pdag& graph) ;
+
+  /// Fills the variable slots with Bernoulli samples.
+  ///
+  /// @param[in] p_vars  Probabilities of variables.
+  void SampleVariables(const Pdag::IndexMap<double>& p_vars) ;
+
+  /// Runs the program over the current batch of samples.
+  void EvaluateBatch() ;
+
+  /// @param[in] root  The encoded root argument.
+  ///
+  /// @returns The number of trials in the batch with the root function true.
+  std::int64_t CountSuccesses(int root) ;
+
+  /// Samples all the targets until the sample size or the target precision.
+  ///
+  /// @param[in] p_vars  Probabilities of variables.
+  void Sample(const Pdag::IndexMap<double>& p_vars) ;
+
+  /// @returns Pointer to the first word of the slot.
+  std::uint64_t* slot(int index) { return &words_[index * batch_size_]; }
+
+  const Settings kSettings_;  ///< Analysis settings.
+  int batch_size_;  ///< The number of 64-bit words per slot.
+  std::vector<int> roots_;  ///< The encoded arguments of the targets.
+  std::vector<int> variables_;  ///< Indices of variables used by the program.
+  std::vector<Instruction> program_;  ///< Gates in topological order.
+  std::vector<int> args_;  ///< The pool of encoded instruction arguments.
+  std::vector<std::uint64_t> words_;  ///< Slot values of the current batch.
+  std::uint64_t rng_[4];  ///< The state of the random number generator.
+  Pdag::IndexMap<double> p_vars_;  ///< The probabilities of the last estimate.
+  std::vector<ProbabilityEstimate> estimates_;  ///< The last estimates.
+  std::mutex mutex_;  ///< Serializes the estimation for shared evaluators.
+};
+
+}  // namespace scram::core
@@ -32,7 +32,17 @@ namespace scram::mef {
 Expression::Expression(std::vector<Expression*> args)
     : args_(std::move(args)), sampled_value_(0), sampled_(false) {}
 
+thread_local Expression::SampleTable* Expression::SampleTable::table_ =
+    nullptr;
+
 double Expression::Sample()  {
+  if (SampleTable* table = SampleTable::table_) {
+    auto [it, inserted] = table->values_.try_emplace(this);
+    double& value = it->second;  // Stable while the arguments are sampled.
+    if (inserted)
+      value = this->DoSample();
+    return value;
+  }
   if (!sampled_) {
     sampled_ = true;
     sampled_value_ = this->DoSample();
@@ -41,9 +51,14 @@ double Expression::Sample()  {
 }
 
 void Expression::Reset()  {
-  if (!sampled_)
-    return;
-  sampled_ = false;
+  if (SampleTable* table = SampleTable::table_) {
+    if (!table->values_.erase(this))
+      return;
+  } else {
+    if (!sampled_)
+      return;
+    sampled_ = false;
+  }
   for (Expression* arg : args_)
     arg->Reset();
 }
@@ -52,6 +67,11 @@ bool Expression::IsDeviate()  {
   return ext::any_of(args_, [](Expression* arg) { return arg->IsDeviate(); });
 }
 
+bool Expression::IsTimeDependent() {
+  return ext::any_of(args_,
+                     [](Expression* arg) { return arg->IsTimeDependent(); });
+}
+
 namespace detail {
 
 void EnsureMultivariateArgs(std::vector<Expression*> args) {
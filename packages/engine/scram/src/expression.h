@@ -23,6 +23,7 @@
 #pragma once
 
 #include <algorithm>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -66,6 +67,30 @@ inline bool IsPositive(const Interval& interval) {
 /// after validation phases.
 class Expression : private boost::noncopyable {
  public:
+  /// Storage of sampled values private to a thread.
+  /// While the table is alive,
+  /// Sample and Reset calls on its thread
+  /// work with the table instead of the shared expression state,
+  /// so that concurrent threads can sample the same expressions.
+  class SampleTable : private boost::noncopyable {
+    friend class Expression;  // The storage of the sampled values.
+
+   public:
+    /// Installs the table for the calling thread.
+    SampleTable() : previous_(table_) { table_ = this; }
+
+    /// Restores the previously installed table of the thread.
+    ~SampleTable() { table_ = previous_; }
+
+   private:
+    /// The current table of the thread.
+    static thread_local SampleTable* table_;
+
+    /// The sampled values of the expressions.
+    std::unordered_map<const Expression*, double> values_;
+    SampleTable* previous_;  ///< The table to restore.
+  };
+
   /// Constructor for use by derived classes
   /// to register their arguments.
   ///
@@ -106,6 +131,14 @@ class Expression : private boost::noncopyable {
   ///          may yield silent failure.
   virtual bool IsDeviate() ;
 
+  /// Determines if the value of the expression changes with the mission time.
+  /// The default logic is to check arguments for the system mission time,
+  /// which is the only source of the time dependence.
+  ///
+  /// @returns true if the expression's value is a function of time.
+  /// @returns false if the value can be reused for any mission time.
+  virtual bool IsTimeDependent();
+
   /// @returns A sampled value of this expression.
   double Sample() ;
 
@@ -24,6 +24,7 @@
 #include <cmath>
 
 #include <functional>
+#include <random>
 
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/math/special_functions/beta.hpp>
@@ -37,7 +38,8 @@
 
 namespace scram::mef {
 
-std::mt19937 RandomDeviate::rng_;
+std::uint64_t RandomDeviate::seed_ = 0;
+thread_local Philox RandomDeviate::rng_;
 
 UniformDeviate::UniformDeviate(Expression* min, Expression* max)
     : RandomDeviate({min, max}), min_(*min), max_(*max) {}
@@ -22,8 +22,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <memory>
-#include <random>
 #include <vector>
 
 #include <boost/range/iterator_range.hpp>
@@ -32,33 +34,105 @@
 
 namespace scram::mef {
 
+/// Counter-based Philox4x32-10 random number generator
+/// (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+/// The numbers are a pure function of the key and the counter,
+/// so any stream can be started in constant time
+/// without sharing state with other streams.
+class Philox {
+ public:
+  using result_type = std::uint32_t;  ///< UniformRandomBitGenerator.
+
+  /// @returns The smallest generated value.
+  static constexpr result_type min() { return 0; }
+  /// @returns The largest generated value.
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /// Starts a stream of numbers from its beginning.
+  ///
+  /// @param[in] key  The key (seed) of the generator.
+  /// @param[in] stream  The number of the stream for the key.
+  void seed(std::uint64_t key, std::uint64_t stream = 0) {
+    key_ = {static_cast<std::uint32_t>(key),
+            static_cast<std::uint32_t>(key >> 32)};
+    counter_ = {0, 0, static_cast<std::uint32_t>(stream),
+                static_cast<std::uint32_t>(stream >> 32)};
+    position_ = block_.size();
+  }
+
+  /// @returns The next 32 random bits of the stream.
+  result_type operator()() {
+    if (position_ == block_.size()) {
+      block_ = Encrypt(counter_, key_);
+      if (!++counter_[0])
+        ++counter_[1];
+      position_ = 0;
+    }
+    return block_[position_++];
+  }
+
+ private:
+  /// @returns The 10-round bijection of the counter with the key.
+  static std::array<std::uint32_t, 4> Encrypt(std::array<std::uint32_t, 4> x,
+                                              std::array<std::uint32_t, 2> k) {
+    for (int round = 0; round < 10; ++round) {
+      std::uint64_t p0 = std::uint64_t{0xD2511F53} * x[0];
+      std::uint64_t p1 = std::uint64_t{0xCD9E8D57} * x[2];
+      x = {static_cast<std::uint32_t>(p1 >> 32) ^ x[1] ^ k[0],
+           static_cast<std::uint32_t>(p1),
+           static_cast<std::uint32_t>(p0 >> 32) ^ x[3] ^ k[1],
+           static_cast<std::uint32_t>(p0)};
+      k[0] += 0x9E3779B9;
+      k[1] += 0xBB67AE85;
+    }
+    return x;
+  }
+
+  std::array<std::uint32_t, 2> key_{};  ///< The seed.
+  std::array<std::uint32_t, 4> counter_{};  ///< {position, stream}.
+  std::array<std::uint32_t, 4> block_{};  ///< The last generated numbers.
+  std::size_t position_ = 4;  ///< The next unused number in the block.
+};
+
 /// Abstract base class for all deviate expressions.
 /// These expressions provide quantification for uncertainty and sensitivity.
 ///
-/// @note Only single RNG is embedded for convenience.
-///       All the distributions share this RNG.
-///       This is not suitable for parallelized simulations!!!
-///
-/// @todo Parametrize with RNG (requires mef::Expression interface change).
+/// @note All the distributions on a thread share the RNG of the thread.
+///       The RNG streams are keyed by the seed and a stream number
+///       (e.g., a Monte Carlo trial),
+///       so sampled values do not depend on the thread that draws them.
 class RandomDeviate : public Expression {
  public:
   using Expression::Expression;
 
   bool IsDeviate()  override { return true; }
 
-  /// Sets the seed of the underlying random number generator.
+  /// Sets the seed of the underlying random number generators
+  /// and restarts the stream 0 of the calling thread.
   ///
   /// @param[in] seed  The seed for RNGs.
   ///
   /// @note This is static! Used by all the deriving deviates.
-  static void seed(unsigned seed)  { rng_.seed(seed); }
+  static void seed(unsigned seed) {
+    seed_ = seed;
+    rng_.seed(seed_);
+  }
+
+  /// Switches the RNG of the calling thread
+  /// to the beginning of a stream for the current seed.
+  ///
+  /// @param[in] stream  The number of the stream.
+  static void stream(std::uint64_t stream) { rng_.seed(seed_, stream); }
 
  protected:
   /// @returns RNG to be used by derived classes.
-  std::mt19937& rng() { return rng_; }
+  Philox& rng() { return rng_; }
 
  private:
-  static std::mt19937 rng_;  ///< The random number generator.
+  static std::uint64_t seed_;  ///< The seed shared by all threads.
+  static thread_local Philox rng_;  ///< The random number generator.
 };
 
 /// Uniform distribution.
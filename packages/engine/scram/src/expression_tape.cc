@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2025 OpenPRA ORG Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the expression register program.
+
+#include "expression_tape.h"
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+#include "event.h"
+#include "expression/constant.h"
+#include "expression/exponential.h"
+#include "expression/numerical.h"
+#include "parameter.h"
+
+namespace scram::core {
+
+ExpressionTape::ExpressionTape(
+    const Pdag::IndexMap<const mef::BasicEvent*>& basic_events,
+    mef::MissionTime* mission_time)
+    : mission_time_(mission_time) {
+  registers_.resize(kLanes);  // The input register.
+  time_dependent_registers_.push_back(true);
+  for (const mef::BasicEvent* event : basic_events) {
+    int reg = Compile(&event->expression());
+    if (time_dependent_registers_[reg])
+      time_dependent_outputs_.emplace_back(num_variables_, reg);
+    ++num_variables_;
+  }
+  // The tables are only needed for the compilation.
+  compiled_ = {};
+  constants_ = {};
+  instructions_ = {};
+}
+
+int ExpressionTape::Compile(mef::Expression* expression) {
+  if (auto it = compiled_.find(expression); it != compiled_.end())
+    return it->second;
+  int reg = Lower(expression);
+  compiled_.emplace(expression, reg);
+  return reg;
+}
+
+int ExpressionTape::Lower(mef::Expression* expression) {
+  if (expression == mission_time_)
+    return kTimeRegister;
+  if (auto* constant = dynamic_cast<mef::ConstantExpression*>(expression))
+    return Constant(constant->value());
+  if (dynamic_cast<mef::Parameter*>(expression))
+    return Compile(expression->args().front());
+
+  auto arg = [this, expression](int i) {
+    return Compile(expression->args()[i]);
+  };
+  if (dynamic_cast<mef::Exponential*>(expression))
+    return Emit(Op::kExponential, {arg(0), arg(1), -1, -1}, expression);
+  if (dynamic_cast<mef::Glm*>(expression))
+    return Emit(Op::kGlm, {arg(0), arg(1), arg(2), arg(3)}, expression);
+  if (dynamic_cast<mef::Weibull*>(expression))
+    return Emit(Op::kWeibull, {arg(0), arg(1), arg(2), arg(3)}, expression);
+  if (dynamic_cast<mef::Add*>(expression))
+    return Fold(Op::kAdd, expression);
+  if (dynamic_cast<mef::Sub*>(expression))
+    return Fold(Op::kSub, expression);
+  if (dynamic_cast<mef::Mul*>(expression))
+    return Fold(Op::kMul, expression);
+  if (dynamic_cast<mef::Div*>(expression))
+    return Fold(Op::kDiv, expression);
+  if (dynamic_cast<mef::Min*>(expression))
+    return Fold(Op::kMin, expression);
+  if (dynamic_cast<mef::Max*>(expression))
+    return Fold(Op::kMax, expression);
+  if (dynamic_cast<mef::Pow*>(expression))
+    return Emit(Op::kPow, {arg(0), arg(1), -1, -1});
+  if (dynamic_cast<mef::Neg*>(expression))
+    return Emit(Op::kNeg, {arg(0), -1, -1, -1});
+  if (dynamic_cast<mef::Abs*>(expression))
+    return Emit(Op::kAbs, {arg(0), -1, -1, -1});
+  if (dynamic_cast<mef::Exp*>(expression))
+    return Emit(Op::kExp, {arg(0), -1, -1, -1});
+  if (dynamic_cast<mef::Log*>(expression))
+    return Emit(Op::kLog, {arg(0), -1, -1, -1});
+  if (dynamic_cast<mef::Sqrt*>(expression))
+    return Emit(Op::kSqrt, {arg(0), -1, -1, -1});
+
+  return Emit(Op::kOpaque, {-1, -1, -1, -1}, expression);
+}
+
+int ExpressionTape::Fold(Op op, mef::Expression* expression) {
+  auto it = expression->args().begin();
+  int result = Compile(*it);
+  for (++it; it != expression->args().end(); ++it)
+    result = Emit(op, {result, Compile(*it), -1, -1});
+  return result;
+}
+
+int ExpressionTape::Constant(double value) {
+  auto [it, inserted] =
+      constants_.emplace(std::bit_cast<std::uint64_t>(value), num_registers());
+  if (inserted) {
+    registers_.insert(registers_.end(), kLanes, value);
+    time_dependent_registers_.push_back(false);
+  }
+  return it->second;
+}
+
+int ExpressionTape::Emit(Op op, std::array<int, 4> args,
+                         mef::Expression* expression) {
+  bool time_dependent = false;
+  if (op == Op::kOpaque) {
+    time_dependent = expression->IsTimeDependent();
+    sets_mission_time_ |= time_dependent;
+  } else {
+    std::array<int, 5> key = {static_cast<int>(op), args[0], args[1], args[2],
+                              args[3]};
+    if (auto it = instructions_.find(key); it != instructions_.end())
+      return it->second;
+    instructions_.emplace(key, num_registers());
+    time_dependent = std::any_of(args.begin(), args.end(), [this](int reg) {
+      return reg >= 0 && time_dependent_registers_[reg];
+    });
+  }
+  int result = num_registers();
+  registers_.resize(registers_.size() + kLanes);
+  time_dependent_registers_.push_back(time_dependent);
+  (time_dependent ? time_dependent_ : invariant_)
+      .push_back({op, result, args, expression});
+  return result;
+}
+
+void ExpressionTape::Evaluate(std::span<const double> times) {
+  assert(!times.empty() && times.size() <= kLanes);
+  num_lanes_ = times.size();
+  double* time = lanes(kTimeRegister);
+  for (int i = 0; i < kLanes; ++i)  // The spare lanes repeat the last time.
+    time[i] = times[std::min(i, num_lanes_ - 1)];
+
+  if (!cached_) {
+    for (const Instruction& instruction : invariant_)
+      Execute(instruction);
+    cached_ = true;
+  }
+  double mission_time = mission_time_->value();
+  for (const Instruction& instruction : time_dependent_)
+    Execute(instruction);
+  mission_time_->value(mission_time);
+}
+
+void ExpressionTape::Load(int lane, Pdag::IndexMap<double>* p_vars) const {
+  assert(lane < num_lanes_);
+  assert(p_vars->size() == num_variables_);
+  for (const auto& [position, reg] : time_dependent_outputs_)
+    *(p_vars->begin() + position) = registers_[reg * kLanes + lane];
+}
+
+void ExpressionTape::Execute(const Instruction& instruction) {
+  double* result = lanes(instruction.result);
+  const auto& [a, b, c, d] = instruction.args;
+  auto unary = [this, result, a](auto&& op) {
+    const double* x = lanes(a);
+    for (int i = 0; i < kLanes; ++i)
+      result[i] = op(x[i]);
+  };
+  auto binary = [this, result, a, b](auto&& op) {
+    const double* x = lanes(a);
+    const double* y = lanes(b);
+    for (int i = 0; i < kLanes; ++i)
+      result[i] = op(x[i], y[i]);
+  };
+  // The formulas are evaluated with the expression functions
+  // to keep the results identical to the virtual evaluation.
+  auto formula = [this, result, a, b, c, d](auto* expression) {
+    const double* x = lanes(a);
+    const double* y = lanes(b);
+    const double* z = lanes(c);
+    const double* t = lanes(d);
+    for (int i = 0; i < kLanes; ++i)
+      result[i] = expression->Compute(x[i], y[i], z[i], t[i]);
+  };
+
+  switch (instruction.op) {
+    case Op::kOpaque:
+      if (!time_dependent_registers_[instruction.result]) {
+        std::fill_n(result, kLanes, instruction.expression->value());
+      } else {
+        const double* time = lanes(kTimeRegister);
+        for (int i = 0; i < kLanes; ++i) {
+          if (i < num_lanes_) {
+            mission_time_->value(time[i]);
+            result[i] = instruction.expression->value();
+          } else {
+            result[i] = result[num_lanes_ - 1];
+          }
+        }
+      }
+      break;
+    case Op::kNeg:
+      unary(std::negate<>());
+      break;
+    case Op::kAdd:
+      binary(std::plus<>());
+      break;
+    case Op::kSub:
+      binary(std::minus<>());
+      break;
+    case Op::kMul:
+      binary(std::multiplies<>());
+      break;
+    case Op::kDiv:
+      binary(std::divides<>());
+      break;
+    case Op::kMin:
+      binary([](double x, double y) { return std::fmin(x, y); });
+      break;
+    case Op::kMax:
+      binary([](double x, double y) { return std::fmax(x, y); });
+      break;
+    case Op::kAbs:
+      unary([](double x) { return std::abs(x); });
+      break;
+    case Op::kExp:
+      unary([](double x) { return std::exp(x); });
+      break;
+    case Op::kLog:
+      unary([](double x) { return std::log(x); });
+      break;
+    case Op::kSqrt:
+      unary([](double x) { return std::sqrt(x); });
+      break;
+    case Op::kPow:
+      binary([](double x, double y) { return std::pow(x, y); });
+      break;
+    case Op::kExponential: {
+      auto* expression = static_cast<mef::Exponential*>(instruction.expression);
+      binary([expression](double lambda, double time) {
+        return expression->Compute(lambda, time);
+      });
+      break;
+    }
+    case Op::kGlm:
+      formula(static_cast<mef::Glm*>(instruction.expression));
+      break;
+    case Op::kWeibull:
+      formula(static_cast<mef::Weibull*>(instruction.expression));
+      break;
+  }
+}
+
+}  // namespace scram::core
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2025 OpenPRA ORG Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Flat evaluation of basic event probability expressions.
+/// The expression trees of all the PDAG variables are lowered
+/// into one linear register program,
+/// which evaluates the probabilities
+/// for several mission time points at once.
+
+#pragma once
+
+#include <cstdint>
+
+#include <array>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "pdag.h"
+
+namespace scram::mef {
+class Expression;
+class MissionTime;
+}  // namespace scram::mef
+
+namespace scram::core {
+
+/// Register program for the probability expressions of basic events.
+///
+/// Every distinct expression node becomes one register
+/// with a value per lane (a mission time point).
+/// Structurally identical subexpressions and equal constants
+/// share the same register,
+/// and the mission time is the only input of the program.
+/// The instructions that do not depend on the mission time
+/// are evaluated once for all the lanes and evaluations
+/// until the tape is invalidated.
+///
+/// Expressions without a lowering
+/// (tests, conditionals, deviates, extern functions, etc.)
+/// are evaluated through their virtual interface
+/// as opaque instructions of the tape.
+class ExpressionTape : private boost::noncopyable {
+ public:
+  /// The number of mission time points evaluated per call.
+  static constexpr int kLanes = 8;
+
+  /// Compiles the probability expressions of the basic events.
+  ///
+  /// @param[in] basic_events  The PDAG variables in the order of indices.
+  /// @param[in,out] mission_time  The model mission time expression
+  ///                              to be treated as the input.
+  ExpressionTape(const Pdag::IndexMap<const mef::BasicEvent*>& basic_events,
+                 mef::MissionTime* mission_time);
+
+  /// @returns The number of instructions in the tape.
+  int num_instructions() const {
+    return invariant_.size() + time_dependent_.size();
+  }
+
+  /// @returns The number of instructions depending on the mission time.
+  int num_time_dependent() const { return time_dependent_.size(); }
+
+  /// @returns The number of registers including constants and the input.
+  int num_registers() const { return registers_.size() / kLanes; }
+
+  /// @returns The number of variables with time-dependent probabilities.
+  int num_time_dependent_variables() const {
+    return time_dependent_outputs_.size();
+  }
+
+  /// @returns true if the evaluation temporarily changes the mission time
+  ///          for opaque time-dependent expressions.
+  bool sets_mission_time() const { return sets_mission_time_; }
+
+  /// Drops the cached values of the time-independent instructions
+  /// after changes in the model parameters or the event-tree context.
+  void Invalidate() { cached_ = false; }
+
+  /// Evaluates the probabilities of the basic events.
+  ///
+  /// @param[in] times  The mission time points (lanes) to evaluate at.
+  ///
+  /// @pre 0 < times.size() <= kLanes
+  ///
+  /// @post The mission time value is left intact.
+  void Evaluate(std::span<const double> times);
+
+  /// Copies the evaluated time-dependent probabilities of one lane.
+  ///
+  /// @param[in] lane  The position of the time point in the last evaluation.
+  /// @param[in,out] p_vars  The probabilities of the graph variables
+  ///                        with the time-independent values already in place.
+  void Load(int lane, Pdag::IndexMap<double>* p_vars) const;
+
+ private:
+  /// Operations of the tape.
+  enum class Op : std::uint8_t {
+    kOpaque,  ///< The virtual value of the expression.
+    kNeg,
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kMin,
+    kMax,
+    kAbs,
+    kExp,
+    kLog,
+    kSqrt,
+    kPow,
+    kExponential,
+    kGlm,
+    kWeibull
+  };
+
+  /// Three-address(-ish) code of the tape.
+  struct Instruction {
+    Op op;  ///< The operation to apply.
+    int result;  ///< The destination register.
+    std::array<int, 4> args;  ///< The source registers (-1 for none).
+    /// The source expression for opaque and formula instructions.
+    mef::Expression* expression;
+  };
+
+  static constexpr int kTimeRegister = 0;  ///< The input register.
+
+  /// @returns The register holding the value of an expression.
+  int Compile(mef::Expression* expression);
+
+  /// Lowers an expression not yet compiled.
+  int Lower(mef::Expression* expression);
+
+  /// Lowers a left fold of a multivariate expression.
+  int Fold(Op op, mef::Expression* expression);
+
+  /// @returns The register with a constant value.
+  int Constant(double value);
+
+  /// Appends an instruction unless the same one is already on the tape.
+  ///
+  /// @returns The result register of the instruction.
+  int Emit(Op op, std::array<int, 4> args,
+           mef::Expression* expression = nullptr);
+
+  /// Runs the instruction for all the lanes.
+  void Execute(const Instruction& instruction);
+
+  /// @returns The lane values of a register.
+  double* lanes(int reg) { return &registers_[reg * kLanes]; }
+
+  mef::MissionTime* mission_time_;  ///< The input of the program.
+  std::vector<double> registers_;  ///< The register file, kLanes per value.
+  std::vector<bool> time_dependent_registers_;  ///< Per register.
+  std::vector<Instruction> invariant_;  ///< The time-independent part.
+  std::vector<Instruction> time_dependent_;  ///< The time-dependent part.
+  /// The positions and registers of the time-dependent variables.
+  std::vector<std::pair<int, int>> time_dependent_outputs_;
+  int num_variables_ = 0;  ///< The number of the PDAG variables.
+  int num_lanes_ = 0;  ///< The number of lanes in the last evaluation.
+  bool cached_ = false;  ///< The time-independent registers are up to date.
+  bool sets_mission_time_ = false;  ///< Opaque time-dependent instructions.
+
+  /// Compilation tables.
+  /// @{
+  std::unordered_map<mef::Expression*, int> compiled_;
+  std::unordered_map<std::uint64_t, int> constants_;
+  std::unordered_map<std::array<int, 5>, int,
+                     boost::hash<std::array<int, 5>>>
+      instructions_;
+  /// @}
+};
+
+}  // namespace scram::core
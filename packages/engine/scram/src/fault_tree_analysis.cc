@@ -178,6 +178,47 @@ namespace scram::core {
         return Iterator(graph_, products_.end());
     }
 
+    double ProductContainer::LiteralProbability(int literal) const {
+        const mef::BasicEvent &event = *graph_.basic_events()[std::abs(literal)];
+        return literal < 0 ? 1 - event.p() : event.p();
+    }
+
+    std::vector<Zbdd::ScoredProduct> ProductContainer::TopProducts(int limit) const {
+        std::vector<Zbdd::ScoredProduct> products;
+        if (filtered_products_) {
+            for (const std::vector<int> &data: *filtered_products_)
+                products.emplace_back(data, Product(data, graph_).p());
+            auto top = products.begin() + std::min<std::size_t>(std::max(limit, 0), products.size());
+            std::partial_sort(products.begin(), top, products.end(),
+                              [](const auto &lhs, const auto &rhs) { return lhs.second > rhs.second; });
+            products.erase(top, products.end());
+            return products;
+        }
+        products = products_.TopProducts(limit, VariableProbabilities());
+        for (Zbdd::ScoredProduct &product: products)
+            product.second *= graph_.initiating_event_frequency();
+        return products;
+    }
+
+    double ProductContainer::CalculateSumOfProducts() const {
+        if (filtered_products_) {
+            double sum = 0;
+            for (const std::vector<int> &data: *filtered_products_)
+                sum += Product(data, graph_).p();
+            return sum;
+        }
+        return products_.CalculateSumOfProducts(VariableProbabilities()) *
+               graph_.initiating_event_frequency();
+    }
+
+    Pdag::IndexMap<double> ProductContainer::VariableProbabilities() const {
+        Pdag::IndexMap<double> p_vars;
+        p_vars.reserve(graph_.basic_events().size());
+        for (const mef::BasicEvent *event: graph_.basic_events())
+            p_vars.push_back(event->p());
+        return p_vars;
+    }
+
     double Product::p() const {
         double p = 1;
         for (const Literal &literal: *this) {
@@ -195,14 +236,27 @@ namespace scram::core {
         CLOCK(analysis_time);
         graph_ = std::make_unique<Pdag>(top_event_, Analysis::settings().ccf_analysis(), model_);
         graph_->initiating_event_frequency(initiating_event_frequency_);
-        adaptive_mode_used_ = false;
-        adaptive_target_probability_ = -1.0;
-        last_summary_.reset();
-        this->Preprocess(graph_.get());
+        preprocessor_passes_ = this->Preprocess(graph_.get());
 #ifndef NDEBUG
         if (Analysis::settings().preprocessor)
             return;  // Preprocessor only option.
 #endif
+        AnalyzeProducts(analysis_time);
+    }
+
+    void FaultTreeAnalysis::Adopt(std::shared_ptr<Pdag> graph)  {
+        CLOCK(analysis_time);
+        assert(graph && !graph->roots().empty() && "Expected a shared graph.");
+        graph_ = std::move(graph);
+        initiating_event_frequency_ = graph_->initiating_event_frequency();
+        LOG(DEBUG2) << "Using the shared PDAG for " << top_event_.id();
+        AnalyzeProducts(analysis_time);
+    }
+
+    void FaultTreeAnalysis::AnalyzeProducts(std::uint64_t analysis_time)  {
+        adaptive_mode_used_ = false;
+        adaptive_target_probability_ = -1.0;
+        last_summary_.reset();
         // If products are required (most cases), run the algorithm to enumerate.
         // Otherwise (BDD probability-only kNone), skip product generation.
         if (Analysis::settings().requires_products()) {
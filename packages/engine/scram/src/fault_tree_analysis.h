@@ -21,10 +21,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
 
+#include <algorithm>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include <boost/iterator/iterator_facade.hpp>
@@ -82,7 +85,7 @@ class Product {
   ///
   /// @param[in] data  The underlying set.
   /// @param[in] graph  The graph with indices to events map.
-  Product(const std::vector<int>& data, const Pdag& graph)
+  Product(std::span<const int> data, const Pdag& graph)
       : data_(data), graph_(graph) {}
 
   /// @returns true for unity product with no literals.
@@ -114,7 +117,7 @@ class Product {
   }
 
  private:
-  const std::vector<int>& data_;  ///< The collection of event indices.
+  std::span<const int> data_;  ///< The collection of event indices.
   const Pdag& graph_;  ///< The host graph.
 };
 
@@ -179,6 +182,52 @@ class ProductContainer {
   Iterator end() const;
   /// @}
 
+  /// Visits products in the iteration order
+  /// without copies of the products.
+  ///
+  /// @tparam Visitor  Callable as void(const Product&, double).
+  ///
+  /// @param[in] visitor  The consumer of products
+  ///                     with their probabilities as in Product::p().
+  ///
+  /// @note The product is valid only within the visitor call.
+  template <class Visitor>
+  void Visit(Visitor&& visitor) const {
+    if (filtered_products_) {
+      for (const std::vector<int>& data : *filtered_products_) {
+        Product product(data, graph_);
+        visitor(product, product.p());
+      }
+      return;
+    }
+    double frequency = graph_.initiating_event_frequency();
+    products_.VisitProducts(
+        [this](int literal) { return LiteralProbability(literal); },
+        [this, &visitor, frequency](std::span<const int> data, double p) {
+          visitor(Product(data, graph_), p * frequency);
+        });
+  }
+
+  /// Visits the most probable products
+  /// in non-increasing order of their probabilities.
+  ///
+  /// @tparam Visitor  Callable as void(const Product&, double).
+  ///
+  /// @param[in] limit  The maximum number of products to visit.
+  /// @param[in] visitor  The consumer of products
+  ///                     with their probabilities as in Product::p().
+  ///
+  /// @note The product is valid only within the visitor call.
+  template <class Visitor>
+  void VisitTop(int limit, Visitor&& visitor) const {
+    for (const Zbdd::ScoredProduct& product : TopProducts(limit))
+      visitor(Product(product.first, graph_), product.second);
+  }
+
+  /// @returns The sum of the product probabilities as in Product::p()
+  ///          over the products visited by Visit().
+  double CalculateSumOfProducts() const;
+
   /// @returns true if no products in the container.
   bool empty() const { return size_ == 0; }
 
@@ -189,6 +238,18 @@ class ProductContainer {
   const std::vector<int>& distribution() const { return distribution_; }
 
  private:
+  /// @returns The probability of a literal in products.
+  double LiteralProbability(int literal) const;
+
+  /// @returns The probabilities of the variables in the graph.
+  Pdag::IndexMap<double> VariableProbabilities() const;
+
+  /// @param[in] limit  The maximum number of products.
+  ///
+  /// @returns The most probable products with probabilities as in Product::p()
+  ///          in non-increasing order of the probabilities.
+  std::vector<Zbdd::ScoredProduct> TopProducts(int limit) const;
+
   const Zbdd& products_;  ///< Container of analysis results.
   const Pdag& graph_;  ///< The analysis graph.
   int size_;  ///< The number of products.
@@ -287,6 +348,11 @@ class FaultTreeAnalysis : public Analysis {
 
   [[nodiscard]] bool adaptive_mode_used() const { return adaptive_mode_used_; }
 
+  /// @returns The profiles of the preprocessing passes over the graph.
+  const std::vector<Preprocessor::PassMetrics>& preprocessor_passes() const {
+    return preprocessor_passes_;
+  }
+
   [[nodiscard]] double adaptive_target_probability() const { return adaptive_target_probability_; }
 
   /// Sets the initiating event frequency to be applied during analysis.
@@ -300,13 +366,31 @@ class FaultTreeAnalysis : public Analysis {
   /// @returns Pointer to the PDAG representing the fault tree.
   [[nodiscard]] Pdag* graph() const { return graph_.get(); }
 
+  /// Adopts a PDAG shared with other analysis targets
+  /// instead of constructing and preprocessing a dedicated one.
+  /// The products, if required, are taken from the shared analysis.
+  ///
+  /// @param[in] graph  The multi-root graph containing the top event.
+  ///
+  /// @note This function is expected to be called only once
+  ///       instead of the regular analysis.
+  void Adopt(std::shared_ptr<Pdag> graph) ;
+
  private:
+  /// Generates, filters, and stores the products of the analysis graph
+  /// if the settings require products.
+  ///
+  /// @param[in] analysis_time  The time stamp of the analysis start.
+  void AnalyzeProducts(std::uint64_t analysis_time) ;
+
   /// Preprocesses a PDAG for future analysis with a specific algorithm.
   ///
   /// @param[in,out] graph  A valid PDAG for analysis.
   ///
+  /// @returns The profiles of the preprocessing passes.
+  ///
   /// @post The graph transformation is semantically equivalent/isomorphic.
-  virtual void Preprocess(Pdag* graph)  = 0;
+  virtual std::vector<Preprocessor::PassMetrics> Preprocess(Pdag* graph) = 0;
 
   /// Generates a sum of products from a preprocessed PDAG.
   ///
@@ -332,9 +416,10 @@ class FaultTreeAnalysis : public Analysis {
 
   const mef::Gate& top_event_;  ///< The root of the graph under analysis.
   const mef::Model* model_;  ///< The optional Model with substitutions.
-  std::unique_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
+  std::shared_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
   std::unique_ptr<const ProductContainer> products_;  ///< Container of results.
   std::shared_ptr<const ProductSummary::ProductList> filtered_products_;
+  std::vector<Preprocessor::PassMetrics> preprocessor_passes_;  ///< Profiles.
   double initiating_event_frequency_ = 1.0;  ///< Initiating event frequency for event tree sequences.
   std::optional<ProductSummary> last_summary_;
   bool adaptive_mode_used_ = false;
@@ -349,27 +434,64 @@ template <class Algorithm>
 class FaultTreeAnalyzer : public FaultTreeAnalysis {
  public:
   using FaultTreeAnalysis::FaultTreeAnalysis;
+  using FaultTreeAnalysis::Analyze;
   using FaultTreeAnalysis::graph;  // Provide access to other analyses.
 
+  /// Analyzes the top event as a root of a graph shared by other targets.
+  ///
+  /// @param[in] graph  The preprocessed multi-root graph.
+  /// @param[in] algorithm  The algorithm analyzed with the graph
+  ///                       or nullptr if no products are required.
+  /// @param[in] root  The index of the top event in the graph roots.
+  ///
+  /// @note This function is expected to be called only once
+  ///       instead of the regular analysis.
+  void Analyze(std::shared_ptr<Pdag> graph,
+               std::shared_ptr<Algorithm> algorithm, int root) {
+    assert(root >= 0 && root < graph->roots().size());
+    algorithm_ = std::move(algorithm);
+    root_ = root;
+    FaultTreeAnalysis::Adopt(std::move(graph));
+  }
+
   /// @returns The analysis algorithm for use by other analyses.
   /// @{
   const Algorithm* algorithm() const { return algorithm_.get(); }
   Algorithm* algorithm() { return algorithm_.get(); }
+  const std::shared_ptr<Algorithm>& shared_algorithm() const {
+    return algorithm_;
+  }
   /// @}
 
+  /// @returns The index of the top event in the roots of the graph.
+  ///          0 for a dedicated graph.
+  int root() const { return std::max(root_, 0); }
+
+  /// @returns The products of the top event generated by the algorithm.
+  const Zbdd& algorithm_products() const {
+    return algorithm_->products(root());
+  }
+
  private:
-  void Preprocess(Pdag* graph)  override {
+  std::vector<Preprocessor::PassMetrics> Preprocess(Pdag* graph) override {
     std::optional<Settings>  settings_opt = std::optional<Settings>(settings());
-    CustomPreprocessor<Algorithm>{graph,settings_opt}();
+    CustomPreprocessor<Algorithm> preprocessor{graph, settings_opt};
+    preprocessor();
+    return preprocessor.passes();
   }
 
   const Zbdd& GenerateProducts(const Pdag* graph)  override {
-    algorithm_ = std::make_unique<Algorithm>(graph, Analysis::settings());
-    algorithm_->Analyze(graph);
-    return algorithm_->products();
+    if (root_ < 0) {
+      algorithm_ = std::make_shared<Algorithm>(graph, Analysis::settings());
+      algorithm_->Analyze(graph);
+    }
+    assert(algorithm_ && "The shared analysis has no products.");
+    return algorithm_products();
   }
 
-  std::unique_ptr<Algorithm> algorithm_;  ///< Analysis algorithm.
+  /// The analysis algorithm possibly shared with other targets.
+  std::shared_ptr<Algorithm> algorithm_;
+  int root_ = -1;  ///< The root of the shared graph or -1 if dedicated.
 };
 
 }  // namespace scram::core
@@ -23,6 +23,9 @@
 #include "importance_analysis.h"
 
 #include <cstdlib>
+#include <cstdint>
+
+#include <span>
 
 #include "event.h"
 #include "logger.h"
@@ -64,85 +67,56 @@ void ImportanceAnalysis::Analyze()  {
 
 std::vector<int> ImportanceAnalyzerBase::occurrences()  {
   Pdag::IndexMap<int> result(prob_analyzer_->graph()->basic_events().size());
-  for (const std::vector<int>& product : prob_analyzer_->products()) {
-    for (int index : product)
-      result[std::abs(index)]++;
-  }
+  prob_analyzer_->products().VisitProducts(
+      [&result](std::span<const int> product, double) {
+        for (int index : product)
+          result[std::abs(index)]++;
+      });
   return result;
 }
 
-double ImportanceAnalyzer<Bdd>::CalculateMif(int index)  {
-  index += Pdag::kVariableStartIndex;
-  const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
-  if (root->terminal())
-    return 0;
-  bool original_mark = Ite::Ref(root).mark();
-
-  int order = bdd_graph_->index_to_order().find(index)->second;
-  double mif = CalculateMif(root, order, !original_mark);
-  bdd_graph_->ClearMarks(original_mark);
-  return prob_analyzer()->ApplyInitiatingEventFrequency(mif);
-}
-
-double ImportanceAnalyzer<Bdd>::CalculateMif(const Bdd::VertexPtr& vertex,
-                                             int order, bool mark)  {
-  if (vertex->terminal())
-    return 0;
-  Ite& ite = Ite::Ref(vertex);
-  if (ite.mark() == mark)
-    return ite.factor();
-  ite.mark(mark);
-  if (ite.order() > order) {
-    if (!ite.module()) {
-      ite.factor(0);
-    } else {  /// @todo Detect if the variable is in the module.
-      // The assumption is
-      // that the order of a module is always larger
-      // than the order of its variables.
-      double high = RetrieveProbability(ite.high());
-      double low = RetrieveProbability(ite.low());
-      if (ite.complement_edge())
-        low = 1 - low;
-      const Bdd::Function& res =
-          bdd_graph_->modules().find(ite.index())->second;
-      double mif = CalculateMif(res.vertex, order, mark);
-      if (res.complement)
-        mif = -mif;
-      ite.factor((high - low) * mif);
-    }
-  } else if (ite.order() == order) {
-    assert(!ite.module() && "A variable can't be a module.");
-    double high = RetrieveProbability(ite.high());
-    double low = RetrieveProbability(ite.low());
-    if (ite.complement_edge())
-      low = 1 - low;
-    ite.factor(high - low);
-  } else {
-    assert(ite.order() < order);
-    double p_var = 0;
-    if (ite.module()) {
-      const Bdd::Function& res =
-          bdd_graph_->modules().find(ite.index())->second;
-      p_var = RetrieveProbability(res.vertex);
-      if (res.complement)
-        p_var = 1 - p_var;
-    } else {
-      p_var = prob_analyzer()->p_vars()[ite.index()];
+ImportanceAnalyzer<Bdd>::ImportanceAnalyzer(
+    ProbabilityAnalyzer<Bdd>* prob_analyzer)
+    : ImportanceAnalyzerBase(prob_analyzer),
+      mifs_(prob_analyzer->p_vars().size()) {
+  CLOCK(adjoint_time);
+  const std::vector<Bdd::Node>& nodes = prob_analyzer->bdd_graph()->nodes();
+  std::uint32_t root = prob_analyzer->root_edge() >> 1;
+  if (!root)
+    return;
+  const std::vector<double>& p_nodes = prob_analyzer->p_nodes();
+  const Pdag::IndexMap<double>& p_vars = prob_analyzer->p_vars();
+  auto p_edge = [&p_nodes](std::uint32_t edge) {
+    return edge & 1 ? 1 - p_nodes[edge >> 1] : p_nodes[edge >> 1];
+  };
+  // The derivatives of the total probability
+  // with respect to the probabilities of the vertices.
+  std::vector<double> adjoints(root + 1);
+  adjoints[root] = 1;  // The root complement is not part of the factor.
+  // Parents precede their branches and modules in the reverse order.
+  for (std::uint32_t i = root; i > 0; --i) {
+    double adjoint = adjoints[i];
+    if (!adjoint)
+      continue;  // No path to the root or cancelled out.
+    const Bdd::Node& node = nodes[i];
+    double p_var = node.module == Bdd::kNoModule ? p_vars[node.index]
+                                                 : p_edge(node.module);
+    adjoints[node.high] += adjoint * p_var;
+    adjoints[node.low >> 1] +=
+        node.low & 1 ? -adjoint * (1 - p_var) : adjoint * (1 - p_var);
+    double factor = adjoint * (p_nodes[node.high] - p_edge(node.low));
+    if (node.module == Bdd::kNoModule) {
+      mifs_[node.index] += factor;
+    } else {  // The chain rule through the module function.
+      adjoints[node.module >> 1] += node.module & 1 ? -factor : factor;
     }
-    double high = CalculateMif(ite.high(), order, mark);
-    double low = CalculateMif(ite.low(), order, mark);
-    if (ite.complement_edge())
-      low = -low;
-    ite.factor(p_var * high + (1 - p_var) * low);
   }
-  return ite.factor();
+  LOG(DEBUG4) << "Calculated MIF adjoints in " << DUR(adjoint_time);
 }
 
-double ImportanceAnalyzer<Bdd>::RetrieveProbability(
-    const Bdd::VertexPtr& vertex)  {
-  if (vertex->terminal())
-    return 1;
-  return Ite::Ref(vertex).p();
+double ImportanceAnalyzer<Bdd>::CalculateMif(int index) {
+  return prob_analyzer()->ApplyInitiatingEventFrequency(
+      mifs_[index + Pdag::kVariableStartIndex]);
 }
 
 }  // namespace scram::core
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "bdd.h"
@@ -166,36 +167,20 @@ class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
   /// Probability analyzer facilities are used
   /// to calculate the total and conditional probabilities for factors.
   ///
+  /// The MIF of all the variables are calculated at once
+  /// with a backward (adjoint) pass over the compact BDD
+  /// that propagates the derivatives of the total probability
+  /// through the module graphs with the chain rule.
+  ///
   /// @param[in] prob_analyzer  Instantiated probability analyzer.
-  explicit ImportanceAnalyzer(ProbabilityAnalyzer<Bdd>* prob_analyzer)
-      : ImportanceAnalyzerBase(prob_analyzer),
-        bdd_graph_(prob_analyzer->bdd_graph()) {}
+  ///
+  /// @pre The probability analysis is done.
+  explicit ImportanceAnalyzer(ProbabilityAnalyzer<Bdd>* prob_analyzer);
 
  private:
   double CalculateMif(int index)  override;
 
-  /// Calculates Marginal Importance Factor of a variable.
-  ///
-  /// @param[in] vertex  The root vertex of a function graph.
-  /// @param[in] order  The identifying order of the variable.
-  /// @param[in] mark  A flag to mark traversed vertices.
-  ///
-  /// @returns Importance factor value.
-  ///
-  /// @note Probability factor fields are used to save results.
-  /// @note The graph needs cleaning its marks after this function
-  ///       because the graph gets continuously-but-partially marked.
-  double CalculateMif(const Bdd::VertexPtr& vertex, int order,
-                      bool mark) ;
-
-  /// Retrieves memorized probability values for BDD function graphs.
-  ///
-  /// @param[in] vertex  Vertex with calculated probabilities.
-  ///
-  /// @returns Saved probability value of the vertex.
-  double RetrieveProbability(const Bdd::VertexPtr& vertex) ;
-
-  Bdd* bdd_graph_;  ///< Binary decision diagram for the analyzer.
+  Pdag::IndexMap<double> mifs_;  ///< The MIF values of all the variables.
 };
 
 }  // namespace scram::core
@@ -28,31 +28,161 @@
 
 #include "mocus.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram::core {
 
+/// Threads sharing a deque of module analyses.
+/// Idle threads take the oldest tasks, i.e., modules closer to the root.
+/// Threads waiting for their submodules run the newest tasks meanwhile,
+/// so the nested waits never exhaust the threads.
+class Mocus::ModulePool : private boost::noncopyable {
+ public:
+  /// Starts the helper threads.
+  ///
+  /// @param[in] num_threads  The total number of threads
+  ///                         including the threads calling Run.
+  explicit ModulePool(int num_threads) {
+    for (int i = 1; i < num_threads; ++i)
+      threads_.emplace_back([this] { Work(); });
+  }
+
+  /// Stops and joins the helper threads.
+  ~ModulePool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& thread : threads_)
+      thread.join();
+  }
+
+  /// Runs tasks concurrently and waits for their completion.
+  ///
+  /// @param[in] tasks  Independent tasks.
+  ///
+  /// @throws The first exception from the tasks after all tasks are done.
+  void Run(const std::vector<std::function<void()>>& tasks) {
+    Group group{static_cast<int>(tasks.size()), nullptr};
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const std::function<void()>& task : tasks)
+      queue_.push_back({&task, &group});
+    ready_.notify_all();
+    while (group.pending) {
+      if (queue_.empty()) {
+        done_.wait(lock);
+        continue;
+      }
+      Task task = queue_.back();
+      queue_.pop_back();
+      Execute(task, &lock);
+    }
+    if (group.error)
+      std::rethrow_exception(group.error);
+  }
+
+ private:
+  /// Tasks submitted by a single Run call.
+  struct Group {
+    int pending;  ///< The number of unfinished tasks.
+    std::exception_ptr error;  ///< The first failure.
+  };
+
+  /// A queued task with its group.
+  struct Task {
+    const std::function<void()>* run;  ///< Owned by the waiting Run call.
+    Group* group;  ///< The group to notify upon completion.
+  };
+
+  /// Takes tasks from the front of the queue until the pool stops.
+  void Work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      Task task = queue_.front();
+      queue_.pop_front();
+      Execute(task, &lock);
+    }
+  }
+
+  /// Runs a task with the lock released.
+  ///
+  /// @param[in] task  The task taken off the queue.
+  /// @param[in,out] lock  The lock on the pool mutex.
+  void Execute(const Task& task, std::unique_lock<std::mutex>* lock) {
+    lock->unlock();
+    std::exception_ptr error;
+    try {
+      (*task.run)();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    lock->lock();
+    if (error && !task.group->error)
+      task.group->error = error;
+    if (--task.group->pending == 0)
+      done_.notify_all();
+  }
+
+  std::vector<std::thread> threads_;  ///< The helper threads.
+  std::mutex mutex_;  ///< The guard of the queue and groups.
+  std::condition_variable ready_;  ///< Signals new tasks or the stop.
+  std::condition_variable done_;  ///< Signals completed groups.
+  std::deque<Task> queue_;  ///< Tasks yet to start.
+  bool stop_ = false;  ///< The indication to finish the helper threads.
+};
+
 Mocus::Mocus(const Pdag* graph, const Settings& settings)
     : graph_(graph), kSettings_(settings) {
   assert(!graph->complement() && "Complements must be propagated.");
 }
 
+Mocus::~Mocus() = default;
+
 void Mocus::Analyze(const Pdag*)  {
+  for (int i = 0; i < graph_->roots().size(); ++i) {
+    const Gate& pin = *graph_->roots()[i];
+    if (pin.args<Gate>().empty()) {
+      zbdds_.push_back(std::make_unique<Zbdd>(graph_, i, kSettings_));
+      continue;
+    }
+    TIMER(DEBUG2, "Minimal cut set generation");
+    assert(*pin.args().begin() > 0 && "Complements must be propagated.");
+    zbdds_.push_back(AnalyzeModule(pin.args<Gate>().begin()->second,
+                                   kSettings_));
+    zbdds_.back()->Analyze(graph_);
+  }
+  if (!graph_->roots().empty())
+    return;
+
   if (graph_->IsTrivial()) {
     LOG(DEBUG2) << "The PDAG is trivial!";
-    zbdd_ = std::make_unique<Zbdd>(graph_, kSettings_);
+    zbdds_.push_back(std::make_unique<Zbdd>(graph_, kSettings_));
     return;
   }
 
   TIMER(DEBUG2, "Minimal cut set generation");
-  zbdd_ = AnalyzeModule(graph_->root(), kSettings_);
+  zbdds_.push_back(AnalyzeModule(graph_->root(), kSettings_));
   LOG(DEBUG2) << "Delegating cut set extraction to ZBDD.";
-  zbdd_->Analyze(graph_);
+  zbdds_.back()->Analyze(graph_);
 }
 
 std::unique_ptr<zbdd::CutSetContainer>
 Mocus::AnalyzeModule(const Gate& gate, const Settings& settings)  {
-  assert(gate.module() && "Expected only module gates.");
+  assert((gate.module() || graph_->NumPins(gate)) &&
+         "Expected only module and root gates.");
   CLOCK(gen_time);
   LOG(DEBUG3) << "Finding cut sets from module: G" << gate.index();
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
@@ -83,6 +213,11 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings)  {
     container->EliminateComplements();
     container->Minimize();
   }
+  // Modules share only the read-only PDAG,
+  // so their analyses may run concurrently
+  // and join the container afterwards in the index order.
+  std::vector<std::pair<int, std::unique_ptr<zbdd::CutSetContainer>>> modules;
+  std::vector<std::function<void()>> tasks;
   for (const auto& entry : container->GatherModules()) {
     int index = entry.first;
     assert(index > 0 && "No complement modules are expected.");
@@ -90,16 +225,36 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings)  {
     assert(limit >= 0 && "Order cut-off is not strict.");
     bool coherent = entry.second.first;
     if (limit == 0 && coherent) {  // Unity is impossible.
-      auto empty_zbdd = std::make_unique<zbdd::CutSetContainer>(
-          kSettings_, index, kMaxVariableIndex, graph_);
-      container->JoinModule(index, std::move(empty_zbdd));
+      modules.emplace_back(index, std::make_unique<zbdd::CutSetContainer>(
+                                      kSettings_, index, kMaxVariableIndex,
+                                      graph_));
       continue;
     }
     Settings adjusted(settings);
     adjusted.limit_order(limit);
-    container->JoinModule(index,
-                          AnalyzeModule(*gates.find(index)->second, adjusted));
+    tasks.emplace_back([this, &modules, i = modules.size(),
+                        &gate = *gates.find(index)->second, adjusted] {
+      modules[i].second = AnalyzeModule(gate, adjusted);
+    });
+    modules.emplace_back(index, nullptr);
+  }
+  // The pool is sized by the threads available to the analysis,
+  // so concurrent analyses of targets do not multiply the threads.
+  if (!pool_ && tasks.size() > 1) {  // Only the main thread runs before the pool.
+    if (int num_threads = ThreadBudget::Available(kSettings_.num_threads());
+        num_threads > 1) {
+      LOG(DEBUG3) << "Analyzing modules on " << num_threads << " threads...";
+      pool_ = std::make_unique<ModulePool>(num_threads);
+    }
+  }
+  if (tasks.size() > 1 && pool_) {
+    pool_->Run(tasks);
+  } else {
+    for (const std::function<void()>& task : tasks)
+      task();
   }
+  for (auto& module : modules)
+    container->JoinModule(module.first, std::move(module.second));
   container->EliminateConstantModules();
   container->Minimize();
   return container;
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "pdag.h"
 #include "settings.h"
 #include "zbdd.h"
@@ -46,20 +48,31 @@ class Mocus : private boost::noncopyable {
   ///      that is, it contains only positive AND/OR gates.
   Mocus(const Pdag* graph, const Settings& settings);
 
+  ~Mocus();
+
   /// Finds minimal cut sets from the PDAG.
   ///
   /// @param[in] graph  The optional PDAG with non-declarative substitutions.
   void Analyze(const Pdag* graph = nullptr) ;
 
   /// @returns Generated minimal cut sets with basic event indices.
-  [[nodiscard]] const Zbdd& products() const {
-    assert(zbdd_ && "Analysis is not done.");
-    return *zbdd_;
+  [[nodiscard]] const Zbdd& products() const { return products(0); }
+
+  /// @param[in] root  The index of the root in the order of the PDAG roots.
+  ///
+  /// @returns Generated minimal cut sets of the root.
+  [[nodiscard]] const Zbdd& products(int root) const {
+    assert(!zbdds_.empty() && "Analysis is not done.");
+    return *zbdds_[root];
   }
 
  private:
+  class ModulePool;  ///< Threads to analyze independent modules.
+
   /// Runs analysis on a module gate.
   /// All submodules are analyzed and joined recursively.
+  /// Submodules are analyzed concurrently
+  /// if more than one thread is allowed by the settings.
   ///
   /// @param[in] gate  A PDAG gate for analysis.
   /// @param[in] settings  Settings for analysis.
@@ -70,7 +83,8 @@ class Mocus : private boost::noncopyable {
 
   const Pdag* graph_;  ///< The analysis PDAG.
   const Settings kSettings_;  ///< Analysis settings.
-  std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
+  std::vector<std::unique_ptr<Zbdd>> zbdds_;  ///< ZBDD per root of the PDAG.
+  std::unique_ptr<ModulePool> pool_;  ///< Started upon the first submodules.
 };
 
 }  // namespace scram::core
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025 OpenPRA ORG Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Concurrent loops over independent work items
+/// with a thread budget shared by the nested levels of parallelism.
+///
+/// The analyses nest their parallel loops
+/// (targets, modules, batches of probability calculations).
+/// Every thread of a loop is granted an equal share of the budget
+/// of the thread starting the loop,
+/// so the nested loops together never exceed the requested threads.
+
+#pragma once
+
+#include <cstddef>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace scram::core {
+
+/// Grants a number of threads to the calling thread
+/// for the lifetime of the object.
+class ThreadBudget : private boost::noncopyable {
+ public:
+  /// @param[in] num_threads  The number of threads
+  ///                         including the calling thread.
+  explicit ThreadBudget(int num_threads) : saved_(budget_) {
+    budget_ = std::max(num_threads, 1);
+  }
+
+  /// Restores the previous budget of the calling thread.
+  ~ThreadBudget() { budget_ = saved_; }
+
+  /// @param[in] num_threads  The requested number of threads.
+  ///
+  /// @returns The number of threads available to the calling thread.
+  static int Available(int num_threads) {
+    return budget_ ? std::min(num_threads, budget_) : num_threads;
+  }
+
+ private:
+  int saved_;  ///< The budget to restore.
+  /// The threads granted to the current thread; 0 for no limit.
+  static inline thread_local int budget_ = 0;
+};
+
+/// Runs work items on threads claiming consecutive chunks of the items,
+/// so long-running items do not hold back the other threads.
+///
+/// @tparam MakeWorker  The factory of per-thread item processors.
+///
+/// @param[in] num_items  The number of work items.
+/// @param[in] chunk_size  The number of consecutive items claimed at once.
+/// @param[in] num_threads  The requested number of threads
+///                         including the calling thread.
+/// @param[in] make_worker  Called once per thread with the actual number of threads
+///                         to create a processor of item ranges [first, last).
+///
+/// @returns The actual number of threads.
+///
+/// @throws The first exception of the workers
+///         after all the threads finish;
+///         the items yet to be claimed are cancelled.
+template <class MakeWorker>
+int ParallelFor(std::size_t num_items, std::size_t chunk_size,
+                int num_threads, const MakeWorker& make_worker) {
+  std::size_t num_chunks = (num_items + chunk_size - 1) / chunk_size;
+  const int total = ThreadBudget::Available(num_threads);
+  num_threads = std::clamp<int>(total, 1, std::max<std::size_t>(num_chunks, 1));
+  if (num_threads < 2) {
+    auto worker = make_worker(1);
+    for (std::size_t first = 0; first < num_items; first += chunk_size)
+      worker(first, std::min(num_items, first + chunk_size));
+    return 1;
+  }
+  const int share = total / num_threads;  // For the nested loops.
+  std::atomic<std::size_t> next_item = 0;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto run = [&] {
+    ThreadBudget budget(share);
+    try {
+      auto worker = make_worker(num_threads);
+      for (std::size_t first = next_item.fetch_add(chunk_size);
+           first < num_items; first = next_item.fetch_add(chunk_size))
+        worker(first, std::min(num_items, first + chunk_size));
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = std::current_exception();
+      next_item = num_items;  // Cancel the remaining items.
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i)
+    threads.emplace_back(run);
+  run();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+  return num_threads;
+}
+
+}  // namespace scram::core
@@ -23,6 +23,8 @@
 
 #include <cstdint>
 
+#include <optional>
+
 #include "element.h"
 #include "expression.h"
 
@@ -71,6 +73,7 @@ class MissionTime : public Expression {
   double value()  override { return value_; }
   Interval interval()  override { return Interval::closed(0, value_); }
   bool IsDeviate()  override { return false; }
+  bool IsTimeDependent() override { return true; }
 
  private:
   double DoSample()  override { return value_; }
@@ -104,14 +107,32 @@ class Parameter : public Expression, public Id, public NodeMark, public Usage {
   /// @param[in] unit  A valid unit.
   void unit(Units unit) { unit_ = unit; }
 
-  double value()  override { return expression_->value(); }
-  Interval interval()  override { return expression_->interval(); }
+  /// Overrides the value of the parameter expression
+  /// for what-if (scenario) calculations.
+  ///
+  /// @param[in] value  The value to use instead of the expression
+  ///                   or std::nullopt to restore the expression.
+  void override_value(std::optional<double> value) { override_ = value; }
+
+  /// @returns The overriding value if any.
+  std::optional<double> override_value() const { return override_; }
+
+  double value()  override {
+    return override_ ? *override_ : expression_->value();
+  }
+  Interval interval()  override {
+    return override_ ? Interval::closed(*override_, *override_)
+                     : expression_->interval();
+  }
 
  private:
-  double DoSample()  override { return expression_->Sample(); }
+  double DoSample()  override {
+    return override_ ? *override_ : expression_->Sample();
+  }
 
   Units unit_ = kUnitless;  ///< Units of this parameter.
   Expression* expression_ = nullptr;  ///< Expression for this parameter.
+  std::optional<double> override_;  ///< The what-if value of the parameter.
 };
 
 }  // namespace scram::mef
@@ -115,8 +115,13 @@ GatePtr Gate::Clone()  {
 template <>
 void Gate::AddConstantArg<true>()  {
   switch (type_) {
-    case kNull:
     case kOr:
+      if (Node::graph().IsSyntheticRoot(*this) && !args_.empty()) {
+        ReduceLogic(kNull);  // Keep the other roots.
+        break;
+      }
+      [[fallthrough]];
+    case kNull:
       MakeConstant(true);
       break;
     case kNand:
@@ -435,9 +440,12 @@ void Gate::ProcessComplementArg(int index)  {
     case kAnd:
       MakeConstant(false);
       break;
+    case kOr:
+      if (Node::graph().IsSyntheticRoot(*this))
+        break;  // The existing argument keeps the root in the graph.
+      [[fallthrough]];
     case kNand:
     case kXor:
-    case kOr:
       MakeConstant(true);
       break;
     case kAtleast:
@@ -497,6 +505,64 @@ Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model)
   }
 }
 
+Pdag::Pdag(const std::vector<const mef::Gate*>& roots, bool ccf,
+           const mef::Model* model)
+    : Pdag() {
+  assert(!roots.empty() && "No roots for the shared graph.");
+  TIMER(DEBUG2, "Shared PDAG Construction");
+  ProcessedNodes nodes;
+  for (const mef::Gate* root : roots) {
+    if (nodes.gates.emplace(root, nullptr).second)
+      GatherVariables(root->formula(), ccf, &nodes);
+  }
+  if (model) {  // Process substitution variables.
+    for (const mef::Substitution& substitution : model->substitutions())
+      GatherVariables(substitution, ccf, &nodes);
+  }
+
+  for (const mef::Gate* root : roots) {
+    GatePtr& gate = nodes.gates.find(root)->second;
+    if (!gate)  // The root may have been reached as an argument of another.
+      gate = ConstructGate(root->formula(), ccf, &nodes);
+    roots_.push_back(gate);
+  }
+
+  if (model) {  // Process substitution application.
+    auto application = std::make_shared<Gate>(kAnd, this);
+    for (const mef::Substitution& substitution : model->substitutions()) {
+      if (substitution.declarative()) {
+        application->AddArg(ConstructSubstitution(substitution, ccf, &nodes));
+      } else {
+        CollectSubstitution(substitution, &nodes);
+      }
+    }
+    if (!application->args().empty()) {  // Shared by all the roots.
+      for (GatePtr& root : roots_) {
+        auto applied_root = std::make_shared<Gate>(kAnd, this);
+        applied_root->AddArg(application);
+        applied_root->AddArg(root);
+        root = std::move(applied_root);
+      }
+      coherent_ = false;
+    }
+  }
+
+  root_ = std::make_shared<Gate>(kOr, this);
+  for (GatePtr& root : roots_) {
+    if (!root_->args().count(root->index()))
+      root_->AddArg(root);
+    auto pin = std::make_shared<Gate>(kNull, this);  // Outside of the graph.
+    pin->AddArg(root);
+    root = std::move(pin);
+  }
+  if (root_->args().size() == 1)
+    root_->type(kNull);  // The only root is pulled up by the preprocessor.
+}
+
+bool Pdag::IsSyntheticRoot(const Gate& gate) const {
+  return !roots_.empty() && root_.get() == &gate && gate.parents().empty();
+}
+
 void Pdag::Print() {
   Clear<kVisit>();
   std::cerr << "\n" << this << std::endl;
@@ -652,8 +718,14 @@ GatePtr Pdag::ConstructGate(const mef::Formula& formula, bool ccf,
       coherent_ = false;
     AddArg(parent, arg.event, arg.complement, ccf, nodes);
   }
-
-  return parent;
+  // Structurally identical gates are shared (hash-consing)
+  // instead of being left for the preprocessor to detect.
+  // Watched gates keep their one-to-one MEF origins.
+  if (parent->type() == kNull || watched_gates_)
+    return parent;
+  std::vector<int> key = {parent->type(), parent->min_number()};
+  key.insert(key.end(), parent->args().begin(), parent->args().end());
+  return nodes->structures.emplace(std::move(key), parent).first->second;
 }
 
 GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
@@ -778,7 +850,8 @@ void Pdag::CollectSubstitution(const mef::Substitution& substitution,
 }
 
 bool Pdag::IsTrivial()  {
-  assert(root_.use_count() == 1 && "Graph gate pointers outside of the graph!");
+  assert(root_.use_count() == 1 + NumPins(*root_) &&
+         "Graph gate pointers outside of the graph!");
   /// @todo Enable the code by decoupling the order assignment!
   /* if (std::as_const(*this).IsTrivial()) */
   /*   return true; */
@@ -792,9 +865,10 @@ bool Pdag::IsTrivial()  {
   if (!root_->args<Gate>().empty()) {  // Pull the child gate to the root.
     int signed_index = root_->args<Gate>().begin()->first;
     root_ = root_->args<Gate>().begin()->second;  // Destroy the previous root.
-    assert(root_->parents().empty() && !root_->constant() &&
-           root_->type() != kNull);
-    complement() ^= signed_index < 0;
+    assert(static_cast<int>(root_->parents().size()) == NumPins(*root_) &&
+           !root_->constant() && root_->type() != kNull);
+    if (roots_.empty())  // The pins carry the signs of the multiple roots.
+      complement() ^= signed_index < 0;
     return false;
   }
   // Only one variable/constant argument.
@@ -950,6 +1024,68 @@ void Pdag::Log()  {
       << "Total # of constants: " << constant_->parents().size();
 }
 
+FrozenPdag::FrozenPdag(const Pdag& graph)
+    : coherent_(graph.coherent()),
+      complement_(graph.complement()),
+      trivial_(graph.IsTrivial()),
+      variable_offsets_{0},
+      gate_offsets_{0},
+      variable_orders_(graph.basic_events().size(), 0) {
+  std::unordered_map<int, int> positions;  // Gate indices to positions.
+  std::vector<int> firsts;  // The first positions of the entered gates.
+  TraverseGates(
+      graph.root_ptr(),
+      [&positions, &firsts, this](const GatePtr& gate) {
+        if (!positions.emplace(gate->index(), -1).second)
+          return false;
+        firsts.push_back(gates_.size());
+        return true;
+      },
+      [&positions, &firsts, this](const GatePtr& gate) {
+        int position = gates_.size();
+        positions.find(gate->index())->second = position;
+        gates_.push_back({gate->index(), gate->type(), gate->min_number(),
+                          gate->order(), 0, firsts.back(), gate->module(),
+                          gate->coherent(), gate->constant()});
+        firsts.pop_back();
+        for (const auto& arg : gate->args<Variable>()) {
+          int index = arg.second->index();
+          variable_args_.push_back(index << 1 | (arg.first < 0));
+          variable_orders_[index - Pdag::kVariableStartIndex] =
+              arg.second->order();
+        }
+        for (const auto& arg : gate->args<Gate>()) {
+          int arg_position = positions.find(arg.second->index())->second;
+          assert(arg_position >= 0 && "Cycle in the graph.");
+          gate_args_.push_back(arg_position << 1 | (arg.first < 0));
+          ++gates_[arg_position].num_parents;
+        }
+        variable_offsets_.push_back(variable_args_.size());
+        gate_offsets_.push_back(gate_args_.size());
+      });
+  if (gates_.back().constant) {
+    assert(trivial_ && "Unexpected constant gate!");
+    complement_ = *graph.root().args().begin() < 0;
+  }
+  for (const GatePtr& pin : graph.roots()) {
+    int arg = *pin->args().begin();
+    Root root{-1, 0, arg < 0};
+    if (!pin->args<Gate>().empty()) {
+      auto it = positions.find(std::abs(arg));
+      assert(it != positions.end() && "The root is detached from the graph.");
+      root.position = it->second;
+      ++gates_[root.position].num_parents;
+    } else if (!pin->args<Variable>().empty()) {
+      root.index = std::abs(arg);
+      assert(variable_order(root.index) && "The root is detached from the graph.");
+    }
+    roots_.push_back(root);
+  }
+  LOG(DEBUG4) << "Frozen PDAG with " << gates_.size() << " gates, "
+              << variable_args_.size() << " variable and " << gate_args_.size()
+              << " gate arguments";
+}
+
 #ifdef SCRAM_ENABLE_PDAG_STREAM_OUTPUT
 std::ostream& operator<<(std::ostream& os, const Constant& constant) {
   os << "s(H" << constant.index()
@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <iosfwd>
 #include <memory>
+#include <span>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -44,6 +45,7 @@
 #include <unordered_set>
 
 #include <boost/container/flat_set.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
 #include "ext/find_iterator.h"
@@ -885,6 +887,32 @@ class Pdag : private boost::noncopyable {
   explicit Pdag(const mef::Gate& root, bool ccf = false,
                 const mef::Model* model = nullptr) ;
 
+  /// Constructs a shared multi-root PDAG
+  /// from several top gates with common sub-formulas,
+  /// e.g., all the sequences of an initiating event.
+  /// Shared MEF gates and events map to the same PDAG nodes,
+  /// so that the common logic is processed only once.
+  ///
+  /// The root of the graph is a synthetic OR gate of all the roots,
+  /// which only serves graph traversals.
+  /// Every top gate is pinned by a pass-through gate outside of the graph,
+  /// which is a parent of the top gate like any other,
+  /// so that transformations replacing the top gate in its parents
+  /// (pass-through, constant, and duplicate gate removal)
+  /// carry the pin along.
+  ///
+  /// @param[in] roots  The non-empty top gates in the order of the analysis.
+  /// @param[in] ccf  Incorporation of CCF gates and events for CCF groups.
+  /// @param[in] model  The Model containing substitutions if any.
+  ///
+  /// @post roots()[i] pins roots[i].
+  ///
+  /// @note The function of the synthetic root is irrelevant;
+  ///       the root only keeps the pinned gates within the graph.
+  ///       The preprocessor keeps the functions of the pinned gates instead.
+  explicit Pdag(const std::vector<const mef::Gate*>& roots, bool ccf = false,
+                const mef::Model* model = nullptr) ;
+
   /// @returns Non-declarative substitutions to be applied by analysis.
   const std::vector<Substitution>& substitutions() const {
     return substitutions_;
@@ -930,6 +958,39 @@ class Pdag : private boost::noncopyable {
 
   const GatePtr& root_ptr() const { return root_; }
 
+  /// @returns The pass-through gates pinning the roots of the multi-root graph.
+  ///          The single argument of a pin is the current root function
+  ///          (a gate, a variable, or the constant).
+  ///          Empty for a single-root graph.
+  const std::vector<GatePtr>& roots() const { return roots_; }
+
+  /// @param[in] index  The index of a node in this graph.
+  ///
+  /// @returns true if the node is one of the root pins.
+  bool IsPin(int index) const {
+    return !roots_.empty() && index >= roots_.front()->index() &&
+           index <= roots_.back()->index();  // The pins are consecutive.
+  }
+
+  /// @param[in] node  A node in this graph.
+  ///
+  /// @returns The number of the root pins among the parents of the node.
+  int NumPins(const Node& node) const {
+    if (roots_.empty())
+      return 0;
+    return std::count_if(node.parents().begin(), node.parents().end(),
+                         [this](const Node::Parent& parent) {
+                           return IsPin(parent.first);
+                         });
+  }
+
+  /// @param[in] gate  A gate in this graph.
+  ///
+  /// @returns true if the gate is the root of a multi-root graph
+  ///          that is not itself pinned,
+  ///          i.e., the gate only keeps the pinned gates in the graph.
+  bool IsSyntheticRoot(const Gate& gate) const;
+
   /// Sets the root gate.
   /// This function is helpful for transformations.
   ///
@@ -952,7 +1013,15 @@ class Pdag : private boost::noncopyable {
   const ConstantPtr& constant() const { return constant_; }
 
   /// @returns true if the graph contains pass-through gates with a constant.
-  bool HasConstants() const { return !constant_->parents().empty(); }
+  ///
+  /// @note The root pins of a multi-root graph are not part of the graph.
+  bool HasConstants() const {
+    return std::any_of(constant_->parents().begin(), constant_->parents().end(),
+                       [this](const Node::Parent& member) {
+                         GatePtr gate = member.second.lock();
+                         return gate == root_ || !gate->parents().empty();
+                       });
+  }
 
   /// @returns true if the graph has at least one pass-through logic gate.
   bool HasNullGates() const { return !null_gates_.empty(); }
@@ -1056,6 +1125,9 @@ class Pdag : private boost::noncopyable {
   struct ProcessedNodes {  /// @{
     std::unordered_map<const mef::Gate*, GatePtr> gates;
     std::unordered_map<const mef::BasicEvent*, VariablePtr> variables;
+    /// Constructed gates keyed by their connective, vote number, and args.
+    std::unordered_map<std::vector<int>, GatePtr, boost::hash<std::vector<int>>>
+        structures;
   };  /// @}
 
   /// Gathers and initializes Variables from Basic Events.
@@ -1093,7 +1165,8 @@ class Pdag : private boost::noncopyable {
   /// @param[in] ccf  A flag to replace basic events with CCF gates.
   /// @param[in,out] nodes  The mapping of processed nodes.
   ///
-  /// @returns Pointer to the newly created indexed gate.
+  /// @returns Pointer to the newly created indexed gate
+  ///          or to an earlier gate with the same connective and arguments.
   ///
   /// @pre The Connective enum in the MEF is the same as in PDAG.
   GatePtr ConstructGate(const mef::Formula& formula, bool ccf,
@@ -1174,6 +1247,7 @@ class Pdag : private boost::noncopyable {
   bool normal_;  ///< Indication for the graph containing only OR and AND gates.
   bool register_null_gates_;  ///< Automatically register pass-through gates.
   GatePtr root_;  ///< The root gate of this graph.
+  std::vector<GatePtr> roots_;  ///< The root pins of a multi-root graph.
   ConstantPtr constant_;  ///< The single constant TRUE for the whole graph.
   /// Mapping for basic events and their Variable indices.
   IndexMap<const mef::BasicEvent*> basic_events_;
@@ -1189,6 +1263,149 @@ class Pdag : private boost::noncopyable {
   double initiating_event_frequency_ = 1.0;
 };
 
+/// Immutable snapshot of a preprocessed PDAG
+/// in the compressed sparse row layout.
+/// The gates are stored in the topological (post-)order,
+/// i.e., arguments before parents and the root last,
+/// and their arguments are stored in contiguous arrays per argument type.
+/// Arguments are encoded as (target << 1 | complement),
+/// where the target is the position of a gate argument
+/// or the index of a variable argument.
+///
+/// The snapshot does not refer to the PDAG nodes,
+/// so the PDAG can be destroyed as soon as the snapshot is taken.
+class FrozenPdag {
+ public:
+  /// The data of a gate without its arguments.
+  struct GateInfo {
+    int index;  ///< The index of the gate in the PDAG.
+    Connective type;  ///< The connective of the gate.
+    int min_number;  ///< The vote number for K/N gates.
+    int order;  ///< The topological order assigned by the preprocessor.
+    int num_parents;  ///< The number of parent gates and pins in the snapshot.
+    /// The position of the first gate reached through this gate.
+    /// The gates of a module occupy the range [first, module position].
+    int first;
+    bool module;  ///< The gate is a module.
+    bool coherent;  ///< The gate sub-graph is coherent.
+    bool constant;  ///< The gate is a pass-through of the constant TRUE.
+  };
+
+  /// The function of a root pinned in a multi-root graph.
+  struct Root {
+    int position;  ///< The position of the gate or -1 if not a gate.
+    int index;  ///< The variable index or 0 for the constant TRUE.
+    bool complement;  ///< The root is the complement of the function.
+  };
+
+  /// Takes a snapshot of the graph reachable from its root.
+  ///
+  /// @param[in] graph  The preprocessed graph.
+  ///
+  /// @pre The graph has variable ordering.
+  /// @pre The constant is only an argument of the trivial root gate
+  ///      or the root pins of a multi-root graph.
+  /// @pre The pinned roots of a multi-root graph are reachable from its root.
+  explicit FrozenPdag(const Pdag& graph);
+
+  /// @returns true if the snapshot graph is coherent.
+  bool coherent() const { return coherent_; }
+
+  /// @returns true if graph = ~root.
+  ///          For the trivial constant root,
+  ///          the graph is FALSE if complemented.
+  bool complement() const { return complement_; }
+
+  /// @returns true if the root is the only gate
+  ///          with a single variable or constant argument.
+  bool trivial() const { return trivial_; }
+
+  /// @returns The number of gates in the snapshot.
+  int num_gates() const { return gates_.size(); }
+
+  /// @returns The position of the root gate.
+  int root() const { return gates_.size() - 1; }
+
+  /// @returns The pinned roots of a multi-root graph in the order of the pins.
+  ///          The pins count as parents of the gates.
+  ///          Empty for a single-root graph.
+  const std::vector<Root>& roots() const { return roots_; }
+
+  /// @param[in] position  The position of the gate in the topological order.
+  ///
+  /// @returns The data of the gate.
+  const GateInfo& gate(int position) const { return gates_[position]; }
+
+  /// @param[in] position  The position of the gate in the topological order.
+  ///
+  /// @returns The encoded variable arguments of the gate.
+  std::span<const int> variable_args(int position) const {
+    return {variable_args_.data() + variable_offsets_[position],
+            variable_args_.data() + variable_offsets_[position + 1]};
+  }
+
+  /// @param[in] position  The position of the gate in the topological order.
+  ///
+  /// @returns The encoded gate arguments of the gate.
+  std::span<const int> gate_args(int position) const {
+    return {gate_args_.data() + gate_offsets_[position],
+            gate_args_.data() + gate_offsets_[position + 1]};
+  }
+
+  /// @param[in] index  The index of a variable in the snapshot.
+  ///
+  /// @returns The topological order of the variable.
+  int variable_order(int index) const {
+    return variable_orders_[index - Pdag::kVariableStartIndex];
+  }
+
+ private:
+  bool coherent_;  ///< The coherence of the whole graph.
+  bool complement_;  ///< The complement of the root.
+  bool trivial_;  ///< The graph is a constant or a single variable.
+  std::vector<GateInfo> gates_;  ///< The gates in the topological order.
+  std::vector<Root> roots_;  ///< The roots of a multi-root graph.
+  std::vector<std::uint32_t> variable_offsets_;  ///< Ranges of gates' args.
+  std::vector<std::uint32_t> gate_offsets_;  ///< Ranges of gates' args.
+  std::vector<int> variable_args_;  ///< The encoded variable arguments.
+  std::vector<int> gate_args_;  ///< The encoded gate arguments.
+  std::vector<int> variable_orders_;  ///< The orders by variable index.
+};
+
+/// Traverses gates depth-first with an explicit stack instead of recursion,
+/// so the depth of graphs is limited by the heap rather than the thread stack.
+///
+/// @tparam Enter  The callable as bool(const GatePtr&).
+/// @tparam Leave  The callable as void(const GatePtr&).
+///
+/// @param[in,out] gate  The starting gate.
+/// @param[in] enter  The visitor upon every encounter of a gate
+///                   that returns false to skip the gate and its arguments.
+/// @param[in] leave  The visitor of an entered gate
+///                   after all its gate arguments are traversed.
+///
+/// @pre The gate arguments of a gate do not change
+///      between the enter and leave of the gate.
+template <typename Enter, typename Leave>
+void TraverseGates(const GatePtr& gate, Enter&& enter, Leave&& leave)  {
+  if (!enter(gate))
+    return;
+  // The gates with the positions of their next gate arguments.
+  std::vector<std::pair<const GatePtr*, std::size_t>> stack = {{&gate, 0}};
+  while (!stack.empty()) {
+    auto& [node, next] = stack.back();
+    auto& args = (*node)->args<Gate>();
+    if (next < args.size()) {
+      const GatePtr& arg = args.begin()[next++].second;
+      if (enter(arg))
+        stack.emplace_back(&arg, 0);  // Invalidates the references.
+      continue;
+    }
+    leave(*node);
+    stack.pop_back();
+  }
+}
+
 /// Traverses and visits gates and nodes in the graph.
 ///
 /// @tparam Mark  The "visited" gate mark.
@@ -1200,28 +1417,34 @@ class Pdag : private boost::noncopyable {
 /// @{
 template <bool Mark = true, typename T>
 void TraverseGates(const GatePtr& gate, T&& visit)  {
-  if (gate->mark() == Mark)
-    return;
-  gate->mark(Mark);
-  visit(gate);
-  for (const auto& arg : gate->args<Gate>()) {
-    TraverseGates<Mark>(arg.second, visit);
-  }
+  TraverseGates(
+      gate,
+      [&visit](const GatePtr& arg) {
+        if (arg->mark() == Mark)
+          return false;
+        arg->mark(Mark);
+        visit(arg);
+        return true;
+      },
+      [](const GatePtr&) {});
 }
 template <typename T>
 void TraverseNodes(const GatePtr& gate, T&& visit)  {
-  if (gate->mark())
-    return;
-  gate->mark(true);
-  visit(gate);
-  for (const auto& arg : gate->args<Gate>()) {
-    TraverseNodes(arg.second, visit);
-  }
-  for (const auto& arg : gate->args<Variable>()) {
-    visit(arg.second);
-  }
+  TraverseGates(
+      gate,
+      [&visit](const GatePtr& arg) {
+        if (arg->mark())
+          return false;
+        arg->mark(true);
+        visit(arg);
+        return true;
+      },
+      [&visit](const GatePtr& arg) {
+        for (const auto& var : arg->args<Variable>()) {
+          visit(var.second);
+        }
+      });
 }
-
 static ext::bimap<int, const mef::Gate *> WalkAndCollectMefGatesWithIndices(Pdag *graph) {
     if (!graph)
         return {};
@@ -107,79 +107,61 @@ std::vector<T*> OrderArguments(Gate* gate)  {
 }
 
 void TopologicalOrder(Pdag* graph)  {
-  // Assigns the order starting from the given gate arguments.
-  auto topological_order = [](auto& self, Gate* root, int order) {
-    if (root->order())
-      return order;
-    for (Gate* arg : OrderArguments<Gate>(root)) {
-      order = self(self, arg, order);
+  // The gates with their ordered gate arguments
+  // and the positions of the next arguments.
+  struct Frame {
+    Gate* gate;
+    std::vector<Gate*> args;
+    std::size_t next;
+  };
+  std::vector<Frame> stack;
+  auto enter = [&stack](Gate* gate) {
+    if (!gate->order())
+      stack.push_back({gate, OrderArguments<Gate>(gate), 0});
+  };
+
+  graph->Clear<Pdag::kOrder>();
+  int order = 0;
+  enter(graph->root().get());
+  while (!stack.empty()) {
+    Frame& frame = stack.back();
+    if (frame.next < frame.args.size()) {
+      enter(frame.args[frame.next++]);  // Invalidates the frame.
+      continue;
     }
+    Gate* root = frame.gate;
+    stack.pop_back();
     for (Variable* arg : OrderArguments<Variable>(root)) {
       if (!arg->order())
         arg->order(++order);
     }
     assert(!root->constant());
     root->order(++order);
-    return order;
-  };
-
-  graph->Clear<Pdag::kOrder>();
-  topological_order(topological_order, graph->root().get(), 0);
+  }
 }
 
 void LayeredTopologicalOrder(Pdag* graph)  {
-    std::unordered_map<Node*, int> depths;
-
-    std::function<int(Node*)> compute_depth = [&](Node* node) -> int {
-        // Memoization check.
-        auto it = depths.find(node);
-        if (it != depths.end()) {
-            return it->second;
-        }
-
-        // Leaf node case.
-        if (dynamic_cast<Variable*>(node) || dynamic_cast<Constant*>(node)) {
-            node->order(0);
-            depths[node] = 0;
-            return 0;
-        }
-
-        // Gate node case.
-        Gate* gate = dynamic_cast<Gate*>(node);
-        assert(gate && "Node is neither a Variable, Constant, nor a Gate.");
-
-        int max_child_depth = -1;
-
-        // Compute depths of Variable arguments.
-        for (const Gate::Arg<Variable>& arg_pair : gate->args<Variable>()) {
-            Node* child = arg_pair.second.get();
-            int child_depth = compute_depth(child);
-            max_child_depth = std::max(max_child_depth, child_depth);
-        }
-
-        // Compute depths of Gate arguments.
-        for (const Gate::Arg<Gate>& arg_pair : gate->args<Gate>()) {
-            Node* child = arg_pair.second.get();
-            int child_depth = compute_depth(child);
-            max_child_depth = std::max(max_child_depth, child_depth);
-        }
-
-        // Assign depth and order to the gate.
-        int depth = max_child_depth + 1;
-        gate->order(depth);
-        depths[gate] = depth;
-        return depth;
-    };
-
-    graph->Clear<Pdag::kOrder>();
-    compute_depth(graph->root().get());
+  graph->Clear<Pdag::kOrder>();
+  graph->Clear<Pdag::kGateMark>();
+  TraverseGates(
+      graph->root(),
+      [](const GatePtr& gate) {
+        if (gate->mark())
+          return false;
+        gate->mark(true);
+        return true;
+      },
+      [](const GatePtr& gate) {
+        // Variables are at the depth 0.
+        int max_child_depth = gate->args<Variable>().empty() ? -1 : 0;
+        for (const Gate::Arg<Gate>& arg : gate->args<Gate>())
+          max_child_depth = std::max(max_child_depth, arg.second->order());
+        gate->order(max_child_depth + 1);
+      });
 }
 
 void MarkCoherence(Pdag* graph)  {
-  auto mark_coherence = [](auto& self, const GatePtr& gate) {
-    if (gate->mark())
-      return;
-    gate->mark(true);
+  auto mark_coherence = [](const GatePtr& gate) {
     bool coherent = true;  // Optimistic initialization.
     switch (gate->type()) {
       case kXor:
@@ -192,9 +174,10 @@ void MarkCoherence(Pdag* graph)  {
         assert(coherent);
     }
     for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
-      self(self, arg.second);
-      if (coherent && (arg.first < 0 || !arg.second->coherent()))
-        coherent = false;  // Must continue with all gates.
+      if (arg.first < 0 || !arg.second->coherent()) {
+        coherent = false;
+        break;
+      }
     }
     if (coherent) {
       for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
@@ -209,9 +192,21 @@ void MarkCoherence(Pdag* graph)  {
   };
 
   graph->Clear<Pdag::kGateMark>();
-  mark_coherence(mark_coherence, graph->root());
+  TraverseGates(
+      graph->root(),
+      [](const GatePtr& gate) {
+        if (gate->mark())
+          return false;
+        gate->mark(true);
+        return true;
+      },
+      mark_coherence);
   assert(!(graph->coherent() && !graph->root()->coherent()));
-  graph->coherent(!graph->complement() && graph->root()->coherent());
+  graph->coherent(!graph->complement() && graph->root()->coherent() &&
+                  std::none_of(graph->roots().begin(), graph->roots().end(),
+                               [](const GatePtr& pin) {
+                                 return *pin->args().begin() < 0;
+                               }));
 }
 
 }  // namespace pdag
@@ -221,7 +216,132 @@ Preprocessor::Preprocessor(Pdag *graph)  : graph_(graph) {}
 Preprocessor::Preprocessor(Pdag *graph, const std::optional<Settings> &settings) : graph_(graph), settings_(settings) {}
 void Preprocessor::operator()()  {
   TIMER(DEBUG2, "Preprocessing");
+  start_time_ = TIME_STAMP();
   this->Run();
+  for (const PassMetrics& pass : passes_) {
+    LOG(DEBUG3) << pass.name << ": " << pass.runs << " runs, " << pass.skips
+                << " skips in " << pass.seconds << " s; removed "
+                << pass.removed_gates << " gates and " << pass.removed_args
+                << " args; found " << pass.found_modules << " modules";
+  }
+}
+
+template <typename T>
+void Preprocessor::RunPass(const char* name, T&& pass, bool optional) {
+  auto it = boost::find_if(
+      passes_, [name](const PassMetrics& metrics) { return metrics.name == name; });
+  if (it == passes_.end())
+    it = passes_.insert(it, {name});
+  PassMetrics& metrics = *it;
+  if (optional) {
+    double budget = settings_ ? settings_->preprocessing_time() : 0;
+    bool over_budget = budget > 0 && DUR(start_time_) > budget;
+    if (metrics.stalled || over_budget) {
+      LOG(DEBUG3) << "Skipping " << name
+                  << (over_budget ? " over the time budget" : " without progress");
+      ++metrics.skips;
+      return;
+    }
+  }
+  GraphSize before = last_size_ ? *last_size_ : MeasureGraph();
+  CLOCK(pass_time);
+  pass();
+  KeepRootsInGraph();
+  metrics.seconds += DUR(pass_time);
+  ++metrics.runs;
+  GraphSize after = MeasureGraph();
+  metrics.removed_gates += before.gates - after.gates;
+  metrics.removed_args += before.args - after.args;
+  metrics.found_modules += after.modules - before.modules;
+  metrics.stalled = before.gates == after.gates && before.args == after.args;
+  last_size_ = after;
+}
+
+void Preprocessor::KeepRootsInGraph()  {
+  if (graph_->roots().empty())
+    return;
+  std::unordered_set<int> visited;  // Gate marks belong to the passes.
+  TraverseGates(
+      graph_->root(),
+      [&visited](const GatePtr& gate) {
+        if (!visited.insert(gate->index()).second)
+          return false;
+        for (const Gate::Arg<Variable>& arg : gate->args<Variable>())
+          visited.insert(arg.second->index());
+        return true;
+      },
+      [](const GatePtr&) {});
+  std::vector<GatePtr> detached;
+  std::vector<VariablePtr> detached_variables;
+  for (const GatePtr& pin : graph_->roots()) {
+    for (const Gate::Arg<Gate>& arg : pin->args<Gate>()) {
+      if (visited.insert(arg.second->index()).second)
+        detached.push_back(arg.second);
+    }
+    for (const Gate::Arg<Variable>& arg : pin->args<Variable>()) {
+      if (visited.insert(arg.second->index()).second)
+        detached_variables.push_back(arg.second);
+    }
+  }
+  if (detached.empty() && detached_variables.empty())
+    return;
+  LOG(DEBUG4) << "Reattaching "
+              << detached.size() + detached_variables.size()
+              << " root(s) to the graph";
+  GatePtr root = graph_->root();
+  if (graph_->IsSyntheticRoot(*root) && root->type() == kNull) {
+    if (root->constant())
+      root->EraseArgs();
+    root->type(kOr);
+  } else if (!graph_->IsSyntheticRoot(*root) || root->type() != kOr) {
+    assert(!graph_->complement() && "The pins carry the signs of the roots.");
+    if (root->module())
+      root->module(false);
+    root = std::make_shared<Gate>(kOr, graph_);
+    root->AddArg(graph_->root());
+    graph_->root(root);
+  }
+  for (const GatePtr& gate : detached)
+    root->AddArg(gate);
+  for (const VariablePtr& variable : detached_variables)
+    root->AddArg(variable);
+  if (root->args().size() == 1)
+    root->type(kNull);  // Pulled up by the next triviality check.
+  if (!root->module())
+    root->module(true);
+  // The detached gates may keep the marks of the pass that detached them,
+  // so the marks are cleared without relying on their continuity.
+  // The reattached subgraphs may share nodes with the modules of the graph;
+  // the modules are detected anew by the next module detection.
+  visited.clear();
+  TraverseGates(
+      root,
+      [&visited, &root](const GatePtr& gate) {
+        if (!visited.insert(gate->index()).second)
+          return false;
+        gate->mark(false);
+        if (gate != root && gate->module())
+          gate->module(false);
+        return true;
+      },
+      [](const GatePtr&) {});
+}
+
+Preprocessor::GraphSize Preprocessor::MeasureGraph() const {
+  GraphSize size{0, 0, 0};
+  std::unordered_set<int> visited;  // Gate marks belong to the passes.
+  TraverseGates(
+      graph_->root(),
+      [&size, &visited](const GatePtr& gate) {
+        if (!visited.insert(gate->index()).second)
+          return false;
+        ++size.gates;
+        size.args += gate->args().size();
+        size.modules += gate->module();
+        return true;
+      },
+      [](const GatePtr&) {});
+  return size;
 }
 
 void Preprocessor::Run()  {
@@ -359,13 +479,15 @@ class TestGateStructure {
 }  // namespace
 
 /// A collection of sanity checks between preprocessing phases.
-#define SANITY_ASSERT                                                      \
-  assert(graph_->root() && "Corrupted pointer to the root gate.");         \
-  assert(graph_->root()->parents().empty() && "Root can't have parents."); \
-  assert(!(graph_->coherent() && graph_->complement()));                   \
-  assert(!graph_->HasConstants() && "Const gate cleanup is broken!");      \
-  assert(!graph_->HasNullGates() && "Null gate cleanup is broken!");       \
-  assert(TestGateStructure()(*graph_->root()));                            \
+#define SANITY_ASSERT                                                       \
+  assert(graph_->root() && "Corrupted pointer to the root gate.");          \
+  assert(static_cast<int>(graph_->root()->parents().size()) ==             \
+             graph_->NumPins(*graph_->root()) &&                            \
+         "Root can't have parents.");                                       \
+  assert(!(graph_->coherent() && graph_->complement()));                    \
+  assert(!graph_->HasConstants() && "Const gate cleanup is broken!");       \
+  assert(!graph_->HasNullGates() && "Null gate cleanup is broken!");        \
+  assert(TestGateStructure()(*graph_->root()));                             \
   assert(TestGateMarks()(*graph_->root(), graph_->root()->mark()))
 
 void Preprocessor::RunPhaseOne()  {
@@ -379,7 +501,8 @@ void Preprocessor::RunPhaseOne()  {
   }
   SANITY_ASSERT;
   if (!graph_->coherent()) {
-    NormalizeGates(/*full=*/false);
+    RunPass("NormalizeGates", [this] { NormalizeGates(/*full=*/false); },
+            /*optional=*/false);
   }
 }
 
@@ -387,27 +510,43 @@ void Preprocessor::RunPhaseTwo()  {
   TIMER(DEBUG2, "Preprocessing Phase II");
   SANITY_ASSERT;
   graph_->Log();
+  last_size_.reset();
+  auto detect_modules = [this](Pdag*) {
+    RunPass("DetectModules", [this] { DetectModules(); }, /*optional=*/false);
+  };
+  auto coalesce_gates = [this](Pdag*) {
+    RunPass("CoalesceGates",
+            [this] {
+              while (CoalesceGates(/*common=*/false))
+                continue;
+            },
+            /*optional=*/false);
+  };
   pdag::Transform(graph_,
                   [this](Pdag*) {
-                    while (ProcessMultipleDefinitions())
-                      continue;
+                    RunPass("ProcessMultipleDefinitions", [this] {
+                      while (ProcessMultipleDefinitions())
+                        continue;
+                    });
+                  },
+                  detect_modules, coalesce_gates,
+                  [this](Pdag*) {
+                    RunPass("MergeCommonArgs", [this] { MergeCommonArgs(); });
+                  },
+                  [this](Pdag*) {
+                    RunPass("DetectDistributivity",
+                            [this] { DetectDistributivity(); });
                   },
-                  [this](Pdag*) { DetectModules(); },
+                  detect_modules,
                   [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
+                    RunPass("BooleanOptimization",
+                            [this] { BooleanOptimization(); });
                   },
-                  [this](Pdag*) { MergeCommonArgs(); },
-                  [this](Pdag*) { DetectDistributivity(); },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) { BooleanOptimization(); },
-                  [this](Pdag*) { DecomposeCommonNodes(); },
-                  [this](Pdag*) { DetectModules(); },
                   [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
+                    RunPass("DecomposeCommonNodes",
+                            [this] { DecomposeCommonNodes(); });
                   },
-                  [this](Pdag*) { DetectModules(); });
+                  detect_modules, coalesce_gates, detect_modules);
   graph_->Log();
 }
 
@@ -416,7 +555,9 @@ void Preprocessor::RunPhaseThree()  {
   SANITY_ASSERT;
   graph_->Log();
   assert(!graph_->normal());
-  NormalizeGates(/*full=*/true);
+  last_size_.reset();
+  RunPass("NormalizeGates", [this] { NormalizeGates(/*full=*/true); },
+          /*optional=*/false);
   graph_->normal(true);
 
   if (graph_->IsTrivial())
@@ -430,20 +571,28 @@ void Preprocessor::RunPhaseFour()  {
   SANITY_ASSERT;
   graph_->Log();
   assert(!graph_->coherent());
-  LOG(DEBUG3) << "Propagating complements...";
-  if (graph_->complement()) {
-    const GatePtr& root = graph_->root();
-    assert(root->type() == kOr || root->type() == kAnd ||
-           root->type() == kNull);
-    if (root->type() == kOr || root->type() == kAnd)
-      root->type(root->type() == kOr ? kAnd : kOr);
-    root->NegateArgs();
-    graph_->complement() = false;
-  }
-  std::unordered_map<int, GatePtr> complements;
-  graph_->Clear<Pdag::kGateMark>();
-  PropagateComplements(graph_->root(), false, &complements);
-  complements.clear();
+  last_size_.reset();
+  RunPass(
+      "PropagateComplements",
+      [this] {
+        if (graph_->complement()) {
+          const GatePtr& root = graph_->root();
+          assert(root->type() == kOr || root->type() == kAnd ||
+                 root->type() == kNull);
+          if (root->type() == kOr || root->type() == kAnd)
+            root->type(root->type() == kOr ? kAnd : kOr);
+          root->NegateArgs();
+          graph_->complement() = false;
+        }
+        std::unordered_map<int, GatePtr> complements;
+        graph_->Clear<Pdag::kGateMark>();
+        PropagateComplements(graph_->root(), false, &complements);
+        for (const GatePtr& pin : graph_->roots()) {  // Negative roots.
+          pin->mark(false);  // The pins are outside of the graph.
+          PropagateComplements(pin, false, &complements);
+        }
+      },
+      /*optional=*/false);
   LOG(DEBUG3) << "Complement propagation is done!";
 
   if (graph_->IsTrivial())
@@ -456,8 +605,16 @@ void Preprocessor::RunPhaseFive()  {
   TIMER(DEBUG2, "Preprocessing Phase V");
   SANITY_ASSERT;
   graph_->Log();
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  last_size_.reset();
+  auto coalesce_common_gates = [this] {
+    RunPass("CoalesceCommonGates",
+            [this] {
+              while (CoalesceGates(/*common=*/true))
+                continue;
+            },
+            /*optional=*/false);
+  };
+  coalesce_common_gates();
 
   if (graph_->IsTrivial())
     return;
@@ -466,8 +623,7 @@ void Preprocessor::RunPhaseFive()  {
   if (graph_->IsTrivial())
     return;
 
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  coalesce_common_gates();
 
   if (graph_->IsTrivial())
     return;
@@ -545,7 +701,8 @@ void Preprocessor::NormalizeGates(NormalizationType normalization_type)  {
     case kNor:
     case kNand:
     case kNot:
-      graph_->complement() ^= true;
+      if (graph_->roots().empty())  // The pins are processed below.
+        graph_->complement() ^= true;
       break;
     default:  // All other types keep the sign of the root.
       assert((type == kAnd || type == kOr || type == kAtleast || type == kXor ||
@@ -556,6 +713,8 @@ void Preprocessor::NormalizeGates(NormalizationType normalization_type)  {
   // Note that root's negative gate is processed in the above lines.
   graph_->Clear<Pdag::kGateMark>();
   NotifyParentsOfNegativeGates(root_gate);
+  for (const GatePtr& pin : graph_->roots())
+    pin->NegateNonCoherentGateArgs();
 
   graph_->Clear<Pdag::kGateMark>();
   NormalizeGate(root_gate, normalization_type);  // Registers null gates only.
@@ -695,24 +854,48 @@ void Preprocessor::NormalizeAtleastGate(const GatePtr& gate)  {
 void Preprocessor::PropagateComplements(
     const GatePtr& gate, bool keep_modules,
     std::unordered_map<int, GatePtr>* complements)  {
-  if (gate->mark())
-    return;
-  gate->mark(true);
-  // If the argument gate is complement,
-  // then create a new gate
-  // that propagates its sign to its arguments
-  // and itself becomes non-complement.
-  // Keep track of complement gates
-  // for optimization of repeated complements.
-  std::vector<std::pair<int, GatePtr>> to_swap;  // Gate args with negation.
-  for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
+  // The gates with the positions of their next gate arguments
+  // on the explicit stack instead of recursion.
+  struct Frame {
+    GatePtr gate;
+    std::size_t next;
+    std::vector<std::pair<int, GatePtr>> to_swap;  // Gate args with negation.
+  };
+  std::vector<Frame> stack;
+  auto enter = [&stack](const GatePtr& arg_gate) {
+    if (arg_gate->mark())
+      return;
+    arg_gate->mark(true);
+    stack.push_back({arg_gate, 0, {}});  // Invalidates the frames.
+  };
+  enter(gate);
+  while (!stack.empty()) {
+    Frame& frame = stack.back();
+    auto& args = frame.gate->args<Gate>();
+    if (frame.next == args.size()) {
+      for (const auto& arg : frame.to_swap) {
+        assert(arg.first < 0);
+        frame.gate->EraseArg(arg.first);
+        frame.gate->AddArg(arg.second);
+        assert(!frame.gate->constant() && "No duplicates are expected.");
+      }
+      stack.pop_back();
+      continue;
+    }
+    // If the argument gate is complement,
+    // then create a new gate
+    // that propagates its sign to its arguments
+    // and itself becomes non-complement.
+    // Keep track of complement gates
+    // for optimization of repeated complements.
+    const Gate::Arg<Gate>& arg = args.begin()[frame.next++];
     const GatePtr& arg_gate = arg.second;
     if ((arg.first > 0) || (keep_modules && arg_gate->module())) {
-      PropagateComplements(arg_gate, keep_modules, complements);
+      enter(arg_gate);
       continue;
     }  // arg is complement and (not keep_modules or arg is not module).
     if (auto it = ext::find(*complements, arg_gate->index())) {
-      to_swap.emplace_back(arg.first, it->second);
+      frame.to_swap.emplace_back(arg.first, it->second);
       assert(it->second->mark());
       continue;  // Existing complements are already processed.
     }
@@ -732,15 +915,8 @@ void Preprocessor::PropagateComplements(
       complement->NegateArgs();
       complements->emplace(arg_gate->index(), complement);
     }
-    to_swap.emplace_back(arg.first, complement);
-    PropagateComplements(complement, keep_modules, complements);
-  }
-
-  for (const auto& arg : to_swap) {
-    assert(arg.first < 0);
-    gate->EraseArg(arg.first);
-    gate->AddArg(arg.second);
-    assert(!gate->constant() && "No duplicates are expected.");
+    frame.to_swap.emplace_back(arg.first, complement);
+    enter(complement);
   }
 }
 
@@ -792,6 +968,8 @@ bool Preprocessor::CoalesceGates(const GatePtr& gate, bool common)  {
       continue;  // Preserve modules.
     if (!common && arg_gate->parents().size() > 1)
       continue;  // Check common.
+    if (graph_->NumPins(*arg_gate))
+      continue;  // Keep the roots of a multi-root graph.
 
     if (arg_gate->type() == target_type)
       to_join.push_back(arg_gate);
@@ -882,26 +1060,39 @@ void Preprocessor::DetectModules()  {
 }
 
 int Preprocessor::AssignTiming(int time, const GatePtr& gate)  {
-  if (gate->Visit(++time))
-    return time;  // Revisited gate.
-  assert(!gate->constant());
-
-  for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
-    time = AssignTiming(time, arg.second);
-  }
-  for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
-    arg.second->Visit(++time);  // Enter the leaf.
-    arg.second->Visit(time);  // Exit at the same time.
-  }
-  bool re_visited = gate->Visit(++time);  // Exiting the gate in second visit.
-  assert(!re_visited && "Detected a cycle!");  // No cyclic visiting.
+  TraverseGates(
+      gate,
+      [&time](const GatePtr& arg_gate) {
+        if (arg_gate->Visit(++time))
+          return false;  // Revisited gate.
+        assert(!arg_gate->constant());
+        return true;
+      },
+      [&time](const GatePtr& arg_gate) {
+        for (const Gate::Arg<Variable>& arg : arg_gate->args<Variable>()) {
+          arg.second->Visit(++time);  // Enter the leaf.
+          arg.second->Visit(time);  // Exit at the same time.
+        }
+        // Exiting the gate in second visit.
+        bool re_visited = arg_gate->Visit(++time);
+        assert(!re_visited && "Detected a cycle!");  // No cyclic visiting.
+      });
   return time;
 }
 
 void Preprocessor::FindModules(const GatePtr& gate)  {
-  if (gate->mark())
-    return;
-  gate->mark(true);
+  TraverseGates(
+      gate,
+      [](const GatePtr& arg_gate) {
+        if (arg_gate->mark())
+          return false;
+        arg_gate->mark(true);
+        return true;
+      },
+      [this](const GatePtr& arg_gate) { TestModularity(arg_gate); });
+}
+
+void Preprocessor::TestModularity(const GatePtr& gate)  {
   int enter_time = gate->EnterTime();
   int exit_time = gate->ExitTime();
   int min_time = enter_time;
@@ -913,9 +1104,8 @@ void Preprocessor::FindModules(const GatePtr& gate)  {
 
   for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
     const GatePtr& arg_gate = arg.second;
-    FindModules(arg_gate);
     if (arg_gate->module() && !arg_gate->Revisited()) {
-      assert(arg_gate->parents().size() == 1);
+      assert(arg_gate->parents().size() == 1 + graph_->NumPins(*arg_gate));
       assert(arg_gate->parents().count(gate->index()));
       assert(IsSubgraphWithinGraph(arg_gate, enter_time, exit_time));
 
@@ -1605,6 +1795,9 @@ bool Preprocessor::DetectDistributivity(const GatePtr& gate)  {
     default:
       distr_type = kNull;
   }
+  if (graph_->IsSyntheticRoot(*gate))
+    distr_type = kNull;  // The roots must stay arguments of the graph root.
+
   std::vector<GatePtr> candidates;
   // Collect child gates of distributivity type.
   for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
@@ -1873,7 +2066,7 @@ void Preprocessor::GatherCommonNodes(
         continue;
       arg_gate->Visit(1);
       gates_queue.push(arg_gate.get());
-      if (arg_gate->parents().size() > 1)
+      if (arg_gate->parents().size() > 1 + graph_->NumPins(*arg_gate))
         common_gates->push_back(arg_gate);
     }
     for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
@@ -1896,7 +2089,8 @@ void Preprocessor::ProcessCommonNode(
 
   std::shared_ptr<N> node = common_node.lock();
 
-  if (node->parents().size() == 1)
+  int mult_tot = node->parents().size() - graph_->NumPins(*node);
+  if (mult_tot == 1)
     return;  // The extra parent is deleted.
   GatePtr root;
   MarkAncestors(node, &root);
@@ -1906,8 +2100,7 @@ void Preprocessor::ProcessCommonNode(
   assert(!node->opti_value() && "Optimization values are corrupted.");
   node->opti_value(1);  // Setting for failure.
 
-  int mult_tot = node->parents().size();  // Total multiplicity.
-  assert(mult_tot > 1);
+  assert(mult_tot > 1);  // Total multiplicity.
   mult_tot += PropagateState(root, node);
   assert(!root->mark() && "Partial unmarking failed.");
   assert(root->descendant() == node->index() && "Ancestors are not indexed.");
@@ -1926,7 +2119,9 @@ void Preprocessor::ProcessCommonNode(
     assert(!destinations.empty());
     std::vector<GateWeakPtr> redundant_parents;
     CollectRedundantParents(node, &destinations, &redundant_parents);
-    if (!redundant_parents.empty()) {  // Note: empty destinations is OK!
+    // Note: empty destinations is OK!
+    if (!redundant_parents.empty() &&
+        PreservesRoots(root, redundant_parents, destinations)) {
       LOG(DEBUG4) << "Node " << node->index() << ": "
                   << redundant_parents.size() << " redundant parent(s) and "
                   << destinations.size() << " failure destination(s)";
@@ -1943,6 +2138,8 @@ void Preprocessor::MarkAncestors(const NodePtr& node,
                                  GatePtr* module)  {
   for (const Node::Parent& member : node->parents()) {
     assert(!member.second.expired());
+    if (graph_->IsPin(member.first))
+      continue;  // Outside of the graph.
     GatePtr parent = member.second.lock();
     if (parent->mark())
       continue;
@@ -1992,7 +2189,7 @@ int Preprocessor::PropagateState(const GatePtr& gate,
   }
   assert(!gate->constant());
   DetermineGateState(gate, num_failure, num_success);
-  int mult_add = gate->parents().size();
+  int mult_add = gate->parents().size() - graph_->NumPins(*gate);
   if (!gate->opti_value() || mult_add < 2)
     mult_add = 0;
   return mult_tot + mult_add;
@@ -2081,7 +2278,11 @@ void Preprocessor::CollectRedundantParents(
     std::vector<GateWeakPtr>* redundant_parents)  {
   for (const Node::Parent& member : node->parents()) {
     assert(!member.second.expired());
+    if (graph_->IsPin(member.first))
+      continue;  // The pins keep the root functions.
     GatePtr parent = member.second.lock();
+    if (graph_->IsSyntheticRoot(*parent))
+      continue;  // Keep the roots of a multi-root graph.
     assert(!parent->mark());
     if (parent->opti_value() == 2)
       continue;  // Non-redundant parent.
@@ -2113,6 +2314,33 @@ void Preprocessor::ProcessRedundantParents(
   }
 }
 
+bool Preprocessor::PreservesRoots(
+    const GatePtr& module, const std::vector<GateWeakPtr>& redundant_parents,
+    const std::unordered_map<int, GateWeakPtr>& destinations)  {
+  if (graph_->roots().empty())
+    return true;
+  if (destinations.count(graph_->root()->index()) &&
+      graph_->IsSyntheticRoot(*graph_->root()))
+    return false;  // The graph root must keep the roots as its arguments.
+  std::unordered_set<int> visited;
+  std::vector<GatePtr> ancestors;
+  for (const GateWeakPtr& ptr : redundant_parents)
+    ancestors.push_back(ptr.lock());
+  while (!ancestors.empty()) {
+    GatePtr gate = std::move(ancestors.back());
+    ancestors.pop_back();
+    if (gate == module || destinations.count(gate->index()))
+      continue;  // The function is preserved.
+    if (!visited.insert(gate->index()).second)
+      continue;
+    if (graph_->NumPins(*gate))
+      return false;
+    for (const Node::Parent& member : gate->parents())
+      ancestors.push_back(member.second.lock());
+  }
+  return true;
+}
+
 template <class N>
 void Preprocessor::ProcessStateDestinations(
     const std::shared_ptr<N>& node,
@@ -2137,11 +2365,10 @@ void Preprocessor::ProcessStateDestinations(
       target->module(false);
       new_gate->module(true);
     }
-    if (target == graph_->root()) {
+    if (target == graph_->root())
       graph_->root(new_gate);  // The sign is preserved.
-    } else {
-      ReplaceGate(target, new_gate);
-    }
+    if (!target->parents().empty())
+      ReplaceGate(target, new_gate);  // Including the root pins.
     new_gate->AddArg(target);  // Only after replacing target!
     new_gate->descendant(node->index());  // Preserve continuity.
   }
@@ -2199,9 +2426,10 @@ bool Preprocessor::DecompositionProcessor::operator()(  // clang-format confuse?
   if (common_node.expired())
     return false;  // The node has been deleted.
   node_ = common_node.lock();
-  if (node_->parents().size() < 2)
-    return false;  // Not common anymore.
   preprocessor_ = preprocessor;
+  const Pdag& graph = *preprocessor_->graph_;
+  if (node_->parents().size() < 2 + graph.NumPins(*node_))
+    return false;  // Not common anymore.
   assert(!preprocessor_->graph_->HasNullGates());
   // Determines whether decomposition is possible with a given type.
   auto is_decomposition_type = [](Connective type) {
@@ -2236,12 +2464,17 @@ bool Preprocessor::DecompositionProcessor::operator()(  // clang-format confuse?
   // Find destinations with particular setups.
   // If a parent gets marked upon destination search,
   // the parent is the destination.
+  // The pins of a multi-root graph have no visit times,
+  // so the pinned gates are never within the destination subgraph;
+  // these gates are cloned instead of getting modified in place.
+  // The synthetic graph root must keep the roots as its arguments.
   std::vector<GateWeakPtr> dest;
   for (const Node::Parent& member : node_->parents()) {
     assert(!member.second.expired());
     GatePtr parent = member.second.lock();
     if (parent->descendant() == node_->index() &&
-        is_decomposition_type(parent->type())) {
+        is_decomposition_type(parent->type()) &&
+        !graph.IsSyntheticRoot(*parent)) {
       dest.push_back(parent);
     }
   }
@@ -2259,6 +2492,8 @@ void Preprocessor::DecompositionProcessor::MarkDestinations(
     return;  // Limited with independent subgraphs.
   for (const Node::Parent& member : parent->parents()) {
     assert(!member.second.expired());
+    if (preprocessor_->graph_->IsPin(member.first))
+      continue;  // Outside of the graph.
     GatePtr ancestor = member.second.lock();
     if (ancestor->descendant() == node_->index())
       continue;  // Already marked.
@@ -2415,19 +2650,23 @@ void Preprocessor::GatherNodes(std::vector<GatePtr>* gates,
 
 void Preprocessor::GatherNodes(const GatePtr& gate, std::vector<GatePtr>* gates,
                                std::vector<VariablePtr>* variables)  {
-  if (gate->Visited())
-    return;
-  gate->Visit(1);
-  gates->push_back(gate);
-  for (const auto& arg : gate->args<Gate>()) {
-    GatherNodes(arg.second, gates, variables);
-  }
-  for (const auto& arg : gate->args<Variable>()) {
-    if (!arg.second->Visited()) {
-      arg.second->Visit(1);
-      variables->push_back(arg.second);
-    }
-  }
+  TraverseGates(
+      gate,
+      [gates](const GatePtr& arg_gate) {
+        if (arg_gate->Visited())
+          return false;
+        arg_gate->Visit(1);
+        gates->push_back(arg_gate);
+        return true;
+      },
+      [variables](const GatePtr& arg_gate) {
+        for (const auto& arg : arg_gate->args<Variable>()) {
+          if (!arg.second->Visited()) {
+            arg.second->Visit(1);
+            variables->push_back(arg.second);
+          }
+        }
+      });
 }
 
 void CustomPreprocessor<Bdd>::Run()  {
@@ -2472,4 +2711,6 @@ void CustomPreprocessor<Mocus>::InvertOrder()  {
     var->order(shift + var->order());
 }
 
+void CustomPreprocessor<DirectEval>::Run()  { Preprocessor::Run(); }
+
 }  // namespace scram::core
@@ -22,9 +22,11 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -120,9 +122,26 @@ class Preprocessor : private boost::noncopyable {
 
   virtual ~Preprocessor() = default;
 
+  /// Performance metrics of a preprocessing pass over all its runs.
+  /// The gate, argument, and module counts are net changes of the graph,
+  /// so a pass that restructures the graph may report negative removals.
+  struct PassMetrics {
+    std::string name;  ///< The name of the pass.
+    int runs = 0;  ///< The number of runs.
+    int skips = 0;  ///< The number of runs skipped by the scheduler.
+    double seconds = 0;  ///< The total time of the runs.
+    int removed_gates = 0;  ///< The number of gates removed from the graph.
+    int removed_args = 0;  ///< The number of gate arguments removed.
+    int found_modules = 0;  ///< The number of new module gates.
+    bool stalled = false;  ///< The last run did not change the graph size.
+  };
+
   /// Runs the graph preprocessing.
   void operator()() ;
 
+  /// @returns The metrics of the passes in the order of their first run.
+  const std::vector<PassMetrics>& passes() const { return passes_; }
+
  protected:
 
  enum NormalizationType {
@@ -192,6 +211,29 @@ class Preprocessor : private boost::noncopyable {
   /// alternating AND/OR gate layers.
   void RunPhaseFive() ;
 
+  /// Runs a preprocessing pass with profiling.
+  /// An optional pass is skipped
+  /// if its last run did not change the size of the graph
+  /// or if the preprocessing time budget in the settings is exhausted.
+  ///
+  /// @tparam T  The callable as void().
+  ///
+  /// @param[in] name  The name of the pass for the metrics.
+  /// @param[in] pass  The pass to run on the graph.
+  /// @param[in] optional  The pass is not required for the graph invariants.
+  template <typename T>
+  void RunPass(const char* name, T&& pass, bool optional = true);
+
+  /// Adds the pinned gates of a multi-root graph
+  /// that are no longer reachable from the graph root
+  /// back to the synthetic graph root.
+  /// The passes preserve the functions of the pinned gates,
+  /// but restructuring may detach the gates from the graph,
+  /// e.g., the complements of the negative roots.
+  ///
+  /// @note The module flags of the reattached gates are reset.
+  void KeepRootsInGraph() ;
+
   /// Normalizes the gates of the whole PDAG
   /// into OR, AND gates.
   ///
@@ -372,9 +414,18 @@ class Preprocessor : private boost::noncopyable {
   /// that have been already timed.
   /// This function can also create new modules from the existing graph.
   ///
-  /// @param[in,out] gate  The gate to test for modularity.
+  /// @param[in,out] gate  The root gate of the sub-graph to test.
+  ///
+  /// @warning Gate marks must be clear.
   void FindModules(const GatePtr& gate) ;
 
+  /// Determines if a gate is a module
+  /// after its gate arguments have been tested.
+  /// New modules may be created from the arguments of the gate.
+  ///
+  /// @param[in,out] gate  The gate to test for modularity.
+  void TestModularity(const GatePtr& gate) ;
+
   /// Processes gate arguments found during the module detection.
   ///
   /// @param[in,out] gate  The gate with the arguments.
@@ -830,6 +881,20 @@ class Preprocessor : private boost::noncopyable {
       const NodePtr& node,
       const std::vector<GateWeakPtr>& redundant_parents) ;
 
+  /// Checks if the failure propagation preserves
+  /// the functions of the pinned roots of a multi-root graph.
+  /// Only the ancestors of the redundant parents
+  /// below the destinations and the module root change their functions.
+  ///
+  /// @param[in] module  The module root of the common node.
+  /// @param[in] redundant_parents  The redundant parents of the common node.
+  /// @param[in] destinations  Destination gates for the state.
+  ///
+  /// @returns true if no pinned root changes its function.
+  bool PreservesRoots(
+      const GatePtr& module, const std::vector<GateWeakPtr>& redundant_parents,
+      const std::unordered_map<int, GateWeakPtr>& destinations) ;
+
   /// Transforms failure or success destination
   /// according to the logic and the common node.
   ///
@@ -1022,6 +1087,22 @@ class Preprocessor : private boost::noncopyable {
   Pdag* graph_;  ///< The PDAG to preprocess.
 
   std::optional<Settings> settings_; ///< optional settings, passed down to preprocessor
+
+ private:
+  /// The size of the graph reachable from the root.
+  struct GraphSize {
+    int gates;  ///< The number of gates.
+    int args;  ///< The number of gate arguments.
+    int modules;  ///< The number of module gates.
+  };
+
+  /// @returns The size of the current graph.
+  GraphSize MeasureGraph() const;
+
+  std::vector<PassMetrics> passes_;  ///< The profiles of the passes.
+  /// The graph size after the last pass if no other changes followed.
+  std::optional<GraphSize> last_size_;
+  std::uint64_t start_time_ = 0;  ///< The start of the preprocessing.
 };
 
 /// Undefined template class for specialization of Preprocessor
@@ -1092,4 +1173,19 @@ class CustomPreprocessor<Mocus> : public CustomPreprocessor<Zbdd> {
   void InvertOrder() ;
 };
 
+class DirectEval;
+
+/// Specialization of preprocessing for direct evaluation of PDAG.
+template <>
+class CustomPreprocessor<DirectEval> : public Preprocessor {
+ public:
+  using Preprocessor::Preprocessor;
+
+ private:
+  /// Performs the generic simplification of the graph.
+  /// Direct evaluation needs no variable ordering or normalization;
+  /// fewer and wider gates mean fewer passes over the sample words.
+  void Run()  override;
+};
+
 }  // namespace scram::core
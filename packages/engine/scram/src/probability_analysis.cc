@@ -21,10 +21,20 @@
 /// probability analysis.
 
 #include "probability_analysis.h"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
+#include "expression_tape.h"
+#include "ext/scope_guard.h"
 #include "logger.h"
+#include "parallel.h"
 #include "parameter.h"
 #include "product_filter.h"
 #include "settings.h"
@@ -48,6 +58,12 @@ namespace scram::core {
         }
         p_time_ = this->CalculateProbabilityOverTime();
         LOG(DEBUG3) << "Total probability: " << p_total_;
+        if (scenarios_ && !scenarios_->empty()) {
+            CLOCK(scenario_time);
+            p_scenarios_ = this->CalculateScenarios(*scenarios_);
+            LOG(DEBUG3) << "Calculated " << p_scenarios_.size() << " scenarios in "
+                        << DUR(scenario_time);
+        }
         if (Analysis::settings().safety_integrity_levels())
             ComputeSil();
         LOG(DEBUG3) << "Finished probability calculations in " << DUR(p_time);
@@ -170,13 +186,37 @@ namespace scram::core {
 
     namespace {
 
+        /// Passes the probabilities of ZBDD cut sets to the visitor
+        /// without the materialization of the cut sets.
+        template<typename Visitor>
+        void VisitCutSets(const Zbdd &cut_sets,
+                          CutSetProbabilityCalculator *,
+                          const Pdag::IndexMap<double> &p_vars,
+                          Visitor &&visitor) {
+            cut_sets.VisitProducts(
+                    [&p_vars](int member) {
+                        assert(member > 0 && "Complements in a cut set.");
+                        return p_vars[member];
+                    },
+                    [&visitor](std::span<const int>, double p) { visitor(p); });
+        }
+
+        /// Passes the probabilities of listed cut sets to the visitor.
+        template<typename Visitor>
+        void VisitCutSets(const ProductSummary::ProductList &cut_sets,
+                          CutSetProbabilityCalculator *calculator,
+                          const Pdag::IndexMap<double> &p_vars,
+                          Visitor &&visitor) {
+            for (const std::vector<int> &cut_set : cut_sets)
+                visitor(calculator->Calculate(cut_set, p_vars));
+        }
+
         template<typename ProductRange>
         double CalculateRareEventImpl(const ProductRange &cut_sets,
                                        CutSetProbabilityCalculator *calculator,
                                        const Pdag::IndexMap<double> &p_vars) {
             double sum = 0;
-            for (const std::vector<int> &cut_set : cut_sets)
-                sum += calculator->Calculate(cut_set, p_vars);
+            VisitCutSets(cut_sets, calculator, p_vars, [&sum](double p) { sum += p; });
             return sum > 1 ? 1 : sum;
         }
 
@@ -185,8 +225,7 @@ namespace scram::core {
                                   CutSetProbabilityCalculator *calculator,
                                   const Pdag::IndexMap<double> &p_vars) {
             double m = 1;
-            for (const std::vector<int> &cut_set : cut_sets)
-                m *= 1 - calculator->Calculate(cut_set, p_vars);
+            VisitCutSets(cut_sets, calculator, p_vars, [&m](double p) { m *= 1 - p; });
             return 1 - m;
         }
 
@@ -271,101 +310,378 @@ namespace scram::core {
                ProbabilityAnalysis::mission_time().value());
         double total_time = ProbabilityAnalysis::mission_time().value();
 
-        auto update = [this, &p_time](double time) {
-            mission_time().value(time);
-            auto it_p = p_vars_.begin();
-            for (const mef::BasicEvent *event: graph_->basic_events())
-                *it_p++ = event->p();
-            const double probability = this->CalculateTotalProbability(p_vars_);
-            p_time.emplace_back(ApplyInitiatingEventFrequency(probability), time);
-        };
-
+        std::vector<double> times;
         for (double time = 0; time < total_time; time += time_step)
-            update(time);
-        update(total_time);// Handle cases when total_time is not divisible by step.
+            times.push_back(time);
+        times.push_back(total_time);// Handle cases when total_time is not divisible by step.
+
+        static_assert(kBatchSize <= ExpressionTape::kLanes);
+        ExpressionTape tape(graph_->basic_events(), &mission_time());
+        LOG(DEBUG4) << "Expression tape: " << tape.num_instructions()
+                    << " instructions (" << tape.num_time_dependent()
+                    << " time-dependent), " << tape.num_registers()
+                    << " registers, " << tape.num_time_dependent_variables()
+                    << " time-dependent variables";
+        if (!tape.num_time_dependent_variables()) {// The same probability at any time.
+            double p_total = ApplyInitiatingEventFrequency(
+                    this->CalculateTotalProbability(p_vars_));
+            for (double time: times)
+                p_time.emplace_back(p_total, time);
+            return p_time;
+        }
+        // The batches are quantified concurrently,
+        // and the tape registers are shared under the lock.
+        // Opaque time-dependent expressions change the mission time,
+        // which product filters read through the basic events,
+        // so such tapes keep the calculations on one thread.
+        int num_batches = (times.size() + kBatchSize - 1) / kBatchSize;
+        int num_threads = tape.sets_mission_time()
+                                  ? 1
+                                  : std::clamp(this->num_threads(), 1, num_batches);
+        if (num_threads > 1)
+            LOG(DEBUG3) << "Calculating " << times.size() << " time points on "
+                        << num_threads << " threads...";
+        std::mutex tape_mutex;
+        // Only the time-dependent probabilities are refreshed in the batch.
+        std::vector<double> probabilities = CalculateBatches(
+                times.size(), num_threads,
+                [&](std::size_t first, std::vector<Pdag::IndexMap<double>> *batch) {
+                    std::span<const double> points(times.data() + first, batch->size());
+                    std::lock_guard<std::mutex> lock(tape_mutex);
+                    tape.Evaluate(points);
+                    for (std::size_t i = 0; i < points.size(); ++i)
+                        tape.Load(i, &(*batch)[i]);
+                });
+
+        for (std::size_t i = 0; i < times.size(); ++i)
+            p_time.emplace_back(ApplyInitiatingEventFrequency(probabilities[i]), times[i]);
         return p_time;
     }
 
+    std::vector<double> ProbabilityAnalyzerBase::CalculateScenarios(
+            const std::vector<Scenario> &scenarios) {
+        // The overrides are applied to the shared model one scenario at a time,
+        // and only the differences in the variable probabilities are kept.
+        std::unordered_map<const mef::BasicEvent *, int> indices;
+        for (int i = Pdag::kVariableStartIndex;
+             i < Pdag::kVariableStartIndex + graph_->basic_events().size(); ++i)
+            indices.emplace(graph_->basic_events()[i], i);
+
+        std::vector<std::vector<std::pair<int, double>>> changes(scenarios.size());
+        for (std::size_t s = 0; s < scenarios.size(); ++s) {
+            const Scenario &scenario = scenarios[s];
+            std::vector<std::pair<int, double>> &delta = changes[s];
+            if (!scenario.parameters.empty()) {
+                ext::scope_guard restorator([&scenario] {
+                    for (const auto &[parameter, value]: scenario.parameters)
+                        parameter->override_value(std::nullopt);
+                });
+                for (const auto &[parameter, value]: scenario.parameters)
+                    parameter->override_value(value);
+                for (const auto &[event, index]: indices) {
+                    if (double p = event->p(); p != p_vars_[index])
+                        delta.emplace_back(index, p);
+                }
+            }
+            for (const auto &[event, p]: scenario.basic_events) {
+                if (auto it = indices.find(event); it != indices.end())
+                    delta.emplace_back(it->second, p);
+            }
+        }
+
+        int num_batches = (scenarios.size() + kBatchSize - 1) / kBatchSize;
+        int num_threads = std::clamp(this->num_threads(), 1, num_batches);
+        if (num_threads > 1)
+            LOG(DEBUG3) << "Calculating " << scenarios.size() << " scenarios on "
+                        << num_threads << " threads...";
+        std::vector<double> probabilities = CalculateBatches(
+                scenarios.size(), num_threads,
+                [this, &changes](std::size_t first, std::vector<Pdag::IndexMap<double>> *batch) {
+                    for (std::size_t i = 0; i < batch->size(); ++i) {
+                        Pdag::IndexMap<double> &p_vars = (*batch)[i];
+                        p_vars = p_vars_;
+                        for (const auto &[index, p]: changes[first + i])
+                            p_vars[index] = p;
+                    }
+                });
+        for (double &p: probabilities)
+            p = ApplyInitiatingEventFrequency(p);
+        return probabilities;
+    }
+
+    std::vector<double> ProbabilityAnalyzerBase::CalculateBatches(
+            std::size_t num_sets, int num_threads,
+            const std::function<void(std::size_t, std::vector<Pdag::IndexMap<double>> *)> &load) {
+        std::vector<double> probabilities(num_sets);
+        ParallelFor(num_sets, kBatchSize, num_threads, [&](int) {
+            return [&, batch = std::vector<Pdag::IndexMap<double>>(kBatchSize, p_vars_)](
+                           std::size_t first, std::size_t last) mutable {
+                batch.resize(last - first);
+                load(first, &batch);
+                std::vector<double> results = this->CalculateTotalProbabilities(batch);
+                std::copy(results.begin(), results.end(), probabilities.begin() + first);
+            };
+        });
+        return probabilities;
+    }
+
+    double ProbabilityAnalyzerBase::UpdateTotalProbability(
+            const std::vector<std::pair<int, double>> &changes) {
+        for (const auto &[index, p]: changes)
+            p_vars_[index] = p;
+        return ApplyInitiatingEventFrequency(this->CalculateTotalProbability(p_vars_));
+    }
+
+    std::vector<double> ProbabilityAnalyzerBase::CalculateTotalProbabilities(
+            const std::vector<Pdag::IndexMap<double>> &p_vars) {
+        std::vector<double> results;
+        results.reserve(p_vars.size());
+        for (const Pdag::IndexMap<double> &set: p_vars)
+            results.push_back(this->CalculateTotalProbability(set));
+        return results;
+    }
+
     ProbabilityAnalyzer<Bdd>::ProbabilityAnalyzer(FaultTreeAnalyzer<Bdd> *fta,
                                                   mef::MissionTime *mission_time)
-        : ProbabilityAnalyzerBase(fta, mission_time), owner_(false) {
-        if (!Analysis::settings().requires_products() || fta->algorithm() == nullptr) {
-            // No BDD constructed in FTA (no products path) or algorithm absent; build our own.
-            owner_ = true;
+        : ProbabilityAnalyzerBase(fta, mission_time) {
+        // The borrowed BDD is compacted by its owner after the products;
+        // otherwise, its graph may still be in use.
+        if (!Analysis::settings().requires_products() || fta->algorithm() == nullptr ||
+            !fta->algorithm()->compact()) {
             CreateBdd(*fta);
-            const Bdd::VertexPtr &root = bdd_graph_->root().vertex;
-            current_mark_ = root->terminal() ? false : Ite::Ref(root).mark();
             LOG(DEBUG2) << "Created BDD in ProbabilityAnalyzer (no product reuse).";
         } else {
             LOG(DEBUG2) << "Re-using BDD from FaultTreeAnalyzer for ProbabilityAnalyzer";
-            bdd_graph_ = fta->algorithm();
-            const Bdd::VertexPtr &root = bdd_graph_->root().vertex;
-            current_mark_ = root->terminal() ? false : Ite::Ref(root).mark();
+            bdd_graph_ = fta->shared_algorithm();
+            root_ = fta->root();
         }
     }
 
-    ProbabilityAnalyzer<Bdd>::~ProbabilityAnalyzer()  {
-        if (owner_)
-            delete bdd_graph_;
-    }
-
     double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
-            const Pdag::IndexMap<double> &p_vars)  {
+            const Pdag::IndexMap<double> &p_vars,
+            std::vector<double> *p_nodes) const {
         CLOCK(calc_time);// BDD based calculation time.
         LOG(DEBUG4) << "Calculating probability with BDD...";
-        current_mark_ = !current_mark_;
-        double prob =
-                CalculateProbability(bdd_graph_->root().vertex, current_mark_, p_vars);
-        if (bdd_graph_->root().complement)
-            prob = 1 - prob;
+        const std::vector<Bdd::Node> &nodes = bdd_graph_->nodes();
+        std::vector<double> &p = *p_nodes;
+        auto p_edge = [&p](std::uint32_t edge) {
+            return edge & 1 ? 1 - p[edge >> 1] : p[edge >> 1];
+        };
+        p.resize(nodes.size());
+        p[0] = 1;// The terminal vertex.
+        // The vertices of other roots of a shared BDD follow the target root.
+        const std::size_t end = (root_edge() >> 1) + 1;
+        for (std::size_t i = 1; i < end; ++i) {
+            const Bdd::Node &node = nodes[i];
+            double p_var = node.module == Bdd::kNoModule ? p_vars[node.index]
+                                                         : p_edge(node.module);
+            p[i] = p_var * p[node.high] + (1 - p_var) * p_edge(node.low);
+        }
+        double prob = p_edge(root_edge());
         LOG(DEBUG4) << "Calculated probability " << prob << " in " << DUR(calc_time);
         return prob;
     }
 
+    void ProbabilityAnalyzer<Bdd>::CalculateTotalProbabilities(
+            const std::vector<Pdag::IndexMap<double>> &p_vars, double *results,
+            std::vector<double> *workspace) const {
+        constexpr int kLanes = kBatchSize;
+        const std::vector<Bdd::Node> &nodes = bdd_graph_->nodes();
+        const int num_vars = graph_->basic_events().size();
+        // The vertex probabilities followed by the variable probabilities.
+        workspace->resize((nodes.size() + num_vars) * kLanes);
+        double *p = workspace->data();
+        double *vars = p + nodes.size() * kLanes;
+        for (std::size_t first = 0; first < p_vars.size(); first += kLanes) {
+            const int num_sets = std::min<std::size_t>(kLanes, p_vars.size() - first);
+            for (int i = 0; i < num_vars; ++i) {
+                for (int k = 0; k < kLanes; ++k)
+                    vars[i * kLanes + k] =
+                            k < num_sets ? p_vars[first + k][i + Pdag::kVariableStartIndex] : 0;
+            }
+            std::fill_n(p, kLanes, 1);// The terminal vertex.
+            for (std::size_t i = 1; i <= root_edge() >> 1; ++i) {
+                const Bdd::Node &node = nodes[i];
+                // Complement edges as (1 - p) = base + sign * p.
+                const double *p_var = vars + (node.index - Pdag::kVariableStartIndex) * kLanes;
+                double var_base = 0;
+                double var_sign = 1;
+                if (node.module != Bdd::kNoModule) {
+                    p_var = p + (node.module >> 1) * kLanes;
+                    var_base = node.module & 1;
+                    var_sign = 1 - 2 * var_base;
+                }
+                const double *p_high = p + node.high * kLanes;
+                const double *p_low = p + (node.low >> 1) * kLanes;
+                const double low_base = node.low & 1;
+                const double low_sign = 1 - 2 * low_base;
+                double p_node[kLanes];// Local lanes keep the loop alias-free.
+                for (int k = 0; k < kLanes; ++k) {
+                    double var = var_base + var_sign * p_var[k];
+                    p_node[k] = var * p_high[k] +
+                                (1 - var) * (low_base + low_sign * p_low[k]);
+                }
+                std::copy_n(p_node, kLanes, p + i * kLanes);
+            }
+            std::uint32_t root = root_edge();
+            for (int k = 0; k < num_sets; ++k) {
+                double prob = p[(root >> 1) * kLanes + k];
+                results[first + k] = root & 1 ? 1 - prob : prob;
+            }
+        }
+    }
+
+    void ProbabilityAnalyzer<Bdd>::PrepareUpdates() {
+        const std::vector<Bdd::Node> &nodes = bdd_graph_->nodes();
+        const int num_vars = graph_->basic_events().size();
+        delta_ = std::make_unique<DeltaState>();
+        DeltaState &delta = *delta_;
+        // Counting sort of the links by the child vertices and variables.
+        delta.parent_offsets.assign(nodes.size() + 1, 0);
+        delta.vertex_offsets.assign(num_vars + 1, 0);
+        auto for_each_link = [&nodes](auto &&visit) {
+            for (std::uint32_t i = 1; i < nodes.size(); ++i) {
+                const Bdd::Node &node = nodes[i];
+                visit(node.high, i);
+                visit(node.low >> 1, i);
+                if (node.module != Bdd::kNoModule)
+                    visit(node.module >> 1, i);
+            }
+        };
+        for_each_link([&delta](std::uint32_t child, std::uint32_t) {
+            ++delta.parent_offsets[child + 1];
+        });
+        for (std::uint32_t i = 1; i < nodes.size(); ++i) {
+            if (nodes[i].module == Bdd::kNoModule)
+                ++delta.vertex_offsets[nodes[i].index - Pdag::kVariableStartIndex + 1];
+        }
+        std::partial_sum(delta.parent_offsets.begin(), delta.parent_offsets.end(),
+                         delta.parent_offsets.begin());
+        std::partial_sum(delta.vertex_offsets.begin(), delta.vertex_offsets.end(),
+                         delta.vertex_offsets.begin());
+        delta.parents.resize(delta.parent_offsets.back());
+        delta.vertices.resize(delta.vertex_offsets.back());
+        std::vector<std::uint32_t> fill(delta.parent_offsets.begin(),
+                                        delta.parent_offsets.end() - 1);
+        for_each_link([&delta, &fill](std::uint32_t child, std::uint32_t parent) {
+            delta.parents[fill[child]++] = parent;
+        });
+        fill.assign(delta.vertex_offsets.begin(), delta.vertex_offsets.end() - 1);
+        for (std::uint32_t i = 1; i < nodes.size(); ++i) {
+            if (nodes[i].module == Bdd::kNoModule)
+                delta.vertices[fill[nodes[i].index - Pdag::kVariableStartIndex]++] = i;
+        }
+        delta.dirty.assign(nodes.size(), false);
+        CalculateTotalProbability(p_vars_, &delta.p);
+    }
+
+    double ProbabilityAnalyzer<Bdd>::UpdateTotalProbability(
+            const std::vector<std::pair<int, double>> &changes) {
+        CLOCK(update_time);
+        if (!delta_)
+            PrepareUpdates();
+        DeltaState &delta = *delta_;
+        const std::vector<Bdd::Node> &nodes = bdd_graph_->nodes();
+        std::vector<double> &p = delta.p;
+        auto p_edge = [&p](std::uint32_t edge) {
+            return edge & 1 ? 1 - p[edge >> 1] : p[edge >> 1];
+        };
+        // The children precede their parents in the compact BDD,
+        // so one ascending sweep over the dirty range suffices.
+        std::uint32_t first = nodes.size();
+        std::uint32_t last = 0;
+        for (const auto &[index, p_var]: changes) {
+            if (p_vars_[index] == p_var)
+                continue;
+            p_vars_[index] = p_var;
+            int position = index - Pdag::kVariableStartIndex;
+            for (std::uint32_t k = delta.vertex_offsets[position];
+                 k < delta.vertex_offsets[position + 1]; ++k) {
+                std::uint32_t vertex = delta.vertices[k];
+                delta.dirty[vertex] = true;
+                first = std::min(first, vertex);
+                last = std::max(last, vertex);
+            }
+        }
+        auto calculate = [this, &nodes, &p, &p_edge](std::uint32_t i) {
+            const Bdd::Node &node = nodes[i];
+            double p_var = node.module == Bdd::kNoModule ? p_vars_[node.index]
+                                                         : p_edge(node.module);
+            return p_var * p[node.high] + (1 - p_var) * p_edge(node.low);
+        };
+        // Widespread changes are cheaper to finish without the bookkeeping.
+        const std::size_t max_updates = nodes.size() / 16;
+        std::size_t num_updated = 0;
+        for (std::uint32_t i = first; i <= last && i < nodes.size(); ++i) {
+            if (num_updated > max_updates) {
+                std::fill(delta.dirty.begin() + i, delta.dirty.begin() + last + 1, false);
+                for (; i < nodes.size(); ++i)
+                    p[i] = calculate(i);
+                num_updated = nodes.size();
+                break;
+            }
+            if (!delta.dirty[i])
+                continue;
+            delta.dirty[i] = false;
+            ++num_updated;
+            double p_node = calculate(i);
+            if (p_node == p[i])
+                continue;// The parents are not affected.
+            p[i] = p_node;
+            for (std::uint32_t k = delta.parent_offsets[i];
+                 k < delta.parent_offsets[i + 1]; ++k) {
+                std::uint32_t parent = delta.parents[k];
+                delta.dirty[parent] = true;
+                last = std::max(last, parent);
+            }
+        }
+        double prob = p_edge(root_edge());
+        LOG(DEBUG4) << "Updated " << num_updated << " of " << nodes.size()
+                    << " BDD vertices in " << DUR(update_time);
+        return ApplyInitiatingEventFrequency(prob);
+    }
+
     void ProbabilityAnalyzer<Bdd>::CreateBdd(
             const FaultTreeAnalysis &fta)  {
         CLOCK(total_time);
 
-        CLOCK(ft_creation);
-        Pdag graph(fta.top_event(), Analysis::settings().ccf_analysis());
-        LOG(DEBUG2) << "PDAG is created in " << DUR(ft_creation);
-
-        CLOCK(prep_time);// Overall preprocessing time.
-        LOG(DEBUG2) << "Preprocessing...";
-        CustomPreprocessor<Bdd>{&graph}();
-        LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
+        // The PDAG is only kept until its snapshot is taken
+        // to release the graph memory before the BDD construction.
+        std::optional<FrozenPdag> snapshot;
+        {
+            CLOCK(ft_creation);
+            Pdag graph(fta.top_event(), Analysis::settings().ccf_analysis());
+            LOG(DEBUG2) << "PDAG is created in " << DUR(ft_creation);
+
+            CLOCK(prep_time);// Overall preprocessing time.
+            LOG(DEBUG2) << "Preprocessing...";
+            CustomPreprocessor<Bdd>{&graph, Analysis::settings()}();
+            LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
+            snapshot.emplace(graph);
+        }
 
         CLOCK(bdd_time);// BDD based calculation time.
         LOG(DEBUG2) << "Creating BDD for Probability Analysis...";
-        bdd_graph_ = new Bdd(&graph, Analysis::settings());
+        bdd_graph_ = std::make_shared<Bdd>(*snapshot, Analysis::settings());
+        bdd_graph_->Compact();
         LOG(DEBUG2) << "BDD is created in " << DUR(bdd_time);
 
         Analysis::AddAnalysisTime(DUR(total_time));
     }
 
-    double ProbabilityAnalyzer<Bdd>::CalculateProbability(
-            const Bdd::VertexPtr &vertex, bool mark,
+    double ProbabilityAnalyzer<DirectEval>::CalculateTotalProbability(
             const Pdag::IndexMap<double> &p_vars)  {
-        if (vertex->terminal())
-            return 1;
-        Ite &ite = Ite::Ref(vertex);
-        if (ite.mark() == mark)
-            return ite.p();
-        ite.mark(mark);
-        double p_var = 0;
-        if (ite.module()) {
-            const Bdd::Function &res = bdd_graph_->modules().find(ite.index())->second;
-            p_var = CalculateProbability(res.vertex, mark, p_vars);
-            if (res.complement)
-                p_var = 1 - p_var;
-        } else {
-            p_var = p_vars[ite.index()];
-        }
-        double high = CalculateProbability(ite.high(), mark, p_vars);
-        double low = CalculateProbability(ite.low(), mark, p_vars);
-        if (ite.complement_edge())
-            low = 1 - low;
-        ite.p(p_var * high + (1 - p_var) * low);
-        return ite.p();
+        return direct_eval_->Estimate(p_vars, target_).value;
+    }
+
+    double ProbabilityAnalyzer<DirectEval>::CalculateTotalProbability()  {
+        ProbabilityEstimate result = direct_eval_->Estimate(p_vars_, target_);
+        const double frequency = initiating_event_frequency();
+        result.value *= frequency;
+        result.std_error *= frequency;
+        result.lower_bound *= frequency;
+        result.upper_bound *= frequency;
+        ProbabilityAnalysis::estimate(result);
+        return result.value;
     }
 }// namespace scram::core
@@ -21,18 +21,23 @@
 
 #pragma once
 
+#include <functional>
+#include <string>
 #include <utility>
 #include <vector>
 #include <memory>
+#include <optional>
 
 #include "analysis.h"
 #include "bdd.h"
+#include "direct_eval.h"
 #include "fault_tree_analysis.h"
 #include "logger.h"
 #include "pdag.h"
 
 namespace scram::mef {
 class MissionTime;
+class Parameter;
 } // namespace scram::mef
 
 namespace scram::core {
@@ -56,6 +61,18 @@ namespace scram::core {
         /// @}
     };
 
+    /// What-if scenario with overridden values of the model.
+    /// Scenarios are quantified with the products or diagrams
+    /// of the analysis without rebuilding them.
+    struct Scenario {
+        std::string name;///< The identifier of the scenario in reports.
+        /// The parameters and their values in the scenario.
+        std::vector<std::pair<mef::Parameter *, double>> parameters;
+        /// The basic events and their probabilities in the scenario.
+        /// The basic event overrides take precedence over the parameters.
+        std::vector<std::pair<const mef::BasicEvent *, double>> basic_events;
+    };
+
     /// Main quantitative analysis class.
     class ProbabilityAnalysis : public Analysis {
     public:
@@ -91,6 +108,26 @@ namespace scram::core {
             return p_time_;
         }
 
+        /// Requests the quantification of what-if scenarios
+        /// after the total probability.
+        ///
+        /// @param[in] scenarios  The scenarios to quantify or nullptr.
+        ///
+        /// @pre The scenarios outlive the analysis.
+        void scenarios(const std::vector<Scenario> *scenarios) {
+            scenarios_ = scenarios;
+        }
+
+        /// @returns The requested what-if scenarios (may be nullptr).
+        const std::vector<Scenario> *scenarios() const { return scenarios_; }
+
+        /// @returns The total probabilities of the what-if scenarios
+        ///          in the order of the scenarios.
+        ///          The empty container implies no calculation has been done.
+        ///
+        /// @pre The analysis is done.
+        const std::vector<double> &p_scenarios() const { return p_scenarios_; }
+
         /// @returns The Safety Integrity Level calculation results.
         ///
         /// @pre The analysis is done with a request for the SIL.
@@ -99,10 +136,21 @@ namespace scram::core {
             return *sil_;
         }
 
+        /// @returns The sampling estimate of the total probability
+        ///          if the analysis is done with Monte Carlo simulation.
+        const std::optional<ProbabilityEstimate> &estimate() const {
+            return estimate_;
+        }
+
     protected:
         /// @returns The mission time expression of the model.
         mef::MissionTime &mission_time() { return *mission_time_; }
 
+        /// Records the sampling estimate of the total probability.
+        ///
+        /// @param[in] value  The estimate with the frequency applied.
+        void estimate(const ProbabilityEstimate &value) { estimate_ = value; }
+
     private:
         /// Calculates the total probability.
         ///
@@ -115,6 +163,16 @@ namespace scram::core {
         virtual std::vector<std::pair<double, double>>
         CalculateProbabilityOverTime()  = 0;
 
+        /// Calculates the total probabilities of what-if scenarios.
+        ///
+        /// @param[in] scenarios  The non-empty collection of scenarios.
+        ///
+        /// @returns The total probabilities in the order of the scenarios.
+        ///
+        /// @post The model values are restored.
+        virtual std::vector<double>
+        CalculateScenarios(const std::vector<Scenario> &scenarios) = 0;
+
         /// Computes probability metrics related to the SIL.
         void ComputeSil() ;
 
@@ -122,6 +180,9 @@ namespace scram::core {
         mef::MissionTime *mission_time_;               ///< The mission time expression.
         std::vector<std::pair<double, double>> p_time_;///< {probability, time}.
         std::unique_ptr<Sil> sil_;                     ///< The Safety Integrity Level results.
+        const std::vector<Scenario> *scenarios_ = nullptr;///< The what-if requests.
+        std::vector<double> p_scenarios_;              ///< The what-if results.
+        std::optional<ProbabilityEstimate> estimate_;  ///< The Monte Carlo estimate.
     };
 
     /// Quantitative calculator of a probability value of a single cut set.
@@ -204,7 +265,7 @@ namespace scram::core {
                       graph_(fta->graph()),
                       fta_(fta) {
                     if (!settings().skip_products() && settings().requires_products()) {
-                        const Zbdd& zbdd = (fta->algorithm()->products());
+                        const Zbdd& zbdd = fta->algorithm_products();
                         products_ = &zbdd;
                     }
                     ExtractVariableProbabilities();
@@ -222,6 +283,25 @@ namespace scram::core {
         /// @returns Pointer to the originating fault tree analysis.
         [[nodiscard]] const FaultTreeAnalysis *fault_tree_analysis() const { return fta_; }
 
+        /// Recalculates the total probability
+        /// after changes in the probabilities of a few variables
+        /// for what-if studies.
+        /// The changes are kept in the variable probabilities
+        /// for the following updates.
+        ///
+        /// @param[in] changes  The variable indices and their new probabilities.
+        ///
+        /// @returns The total probability (frequency) with the changes.
+        ///
+        /// @note Analyzers without incremental quantification
+        ///       recalculate the total probability from scratch.
+        virtual double
+        UpdateTotalProbability(const std::vector<std::pair<int, double>> &changes);
+
+        /// The number of sets of probability values
+        /// calculated together in a batch.
+        static constexpr int kBatchSize = 8;
+
     protected:
         ~ProbabilityAnalyzerBase() override = default;
 
@@ -238,6 +318,22 @@ namespace scram::core {
         virtual double
         CalculateTotalProbability(const Pdag::IndexMap<double> &p_vars) = 0;
 
+        /// Calculates the total probabilities
+        /// for a batch of different sets of probability values.
+        ///
+        /// @param[in] p_vars  Maps of probabilities of the graph variables.
+        ///
+        /// @returns The total probabilities in the order of the sets.
+        virtual std::vector<double>
+        CalculateTotalProbabilities(const std::vector<Pdag::IndexMap<double>> &p_vars);
+
+        /// @returns The number of threads to calculate batches with.
+        ///          Concurrent calls of CalculateTotalProbabilities
+        ///          must be safe for more than one thread.
+        virtual int num_threads() const {
+            return Analysis::settings().num_threads();
+        }
+
         double CalculateTotalProbability()  override {
             return ApplyInitiatingEventFrequency(
                 this->CalculateTotalProbability(p_vars_));
@@ -246,6 +342,29 @@ namespace scram::core {
         std::vector<std::pair<double, double>>
         CalculateProbabilityOverTime()  override;
 
+        /// Collects the changes of the variable probabilities per scenario
+        /// and quantifies the scenarios in batches
+        /// like the probabilities over time.
+        std::vector<double>
+        CalculateScenarios(const std::vector<Scenario> &scenarios) override;
+
+        /// Calculates the total probabilities of many sets of probabilities
+        /// in batches of kBatchSize sets, concurrently if possible.
+        ///
+        /// @param[in] num_sets  The number of probability sets.
+        /// @param[in] num_threads  The maximum number of threads.
+        /// @param[in] load  The function (first, batch) loading the sets
+        ///                  starting at the first index into the batch.
+        ///                  The loader is called concurrently.
+        ///
+        /// @returns The total probabilities of the sets
+        ///          without the initiating event frequency.
+        ///
+        /// @throws The first exception thrown by the loader or calculations.
+        std::vector<double> CalculateBatches(
+                std::size_t num_sets, int num_threads,
+                const std::function<void(std::size_t, std::vector<Pdag::IndexMap<double>> *)> &load);
+
         /// Upon construction of the probability analysis,
         /// stores the variable probabilities in a continuous container
         /// for retrieval by their indices instead of pointers.
@@ -267,7 +386,7 @@ namespace scram::core {
 
     protected:
         Pdag *graph_;            ///< PDAG from the fault tree analysis.
-        const Zbdd *products_;  ///< A collection of products.
+        const Zbdd *products_ = nullptr;  ///< A collection of products.
         Pdag::IndexMap<double> p_vars_;///< Variable probabilities.
         const FaultTreeAnalysis *fta_ = nullptr; ///< Pointer back to qualitative analysis.
     };
@@ -302,12 +421,28 @@ namespace scram::core {
         template<class Algorithm>
         ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm> *fta,
                             mef::MissionTime *mission_time)
-            : ProbabilityAnalyzerBase(fta, mission_time),
-              current_mark_(false),
-              owner_(true) {
+            : ProbabilityAnalyzerBase(fta, mission_time) {
             CreateBdd(*fta);
         }
 
+        /// Constructs probability analyzer for one root of a shared BDD.
+        ///
+        /// @tparam Algorithm  Fault tree analysis algorithm.
+        ///
+        /// @param[in] fta  Fault tree analyzer with the shared graph.
+        /// @param[in] mission_time  The mission time expression of the model.
+        /// @param[in] bdd  The compact BDD of the shared graph.
+        /// @param[in] root  The index of the root in the shared graph.
+        template<class Algorithm>
+        ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm> *fta,
+                            mef::MissionTime *mission_time,
+                            std::shared_ptr<Bdd> bdd, int root)
+            : ProbabilityAnalyzerBase(fta, mission_time),
+              bdd_graph_(std::move(bdd)),
+              root_(root) {
+            assert(bdd_graph_->compact() && "Shared BDD is compacted once.");
+        }
+
         /// Reuses BDD structures from Fault tree analyzer.
         ///
         /// @copydetails ProbabilityAnalysis::ProbabilityAnalysis
@@ -316,20 +451,93 @@ namespace scram::core {
         ///
         /// @post FaultTreeAnalyzer is not corrupted
         ///       by use of its BDD internals.
+        ///       The BDD is only reused if its owner has compacted it;
+        ///       otherwise, a new BDD is created.
         ProbabilityAnalyzer(FaultTreeAnalyzer<Bdd> *fta,
                             mef::MissionTime *mission_time);
 
-        /// Deletes the PDAG and BDD
-        /// only if ProbabilityAnalyzer is the owner of them.
-        ~ProbabilityAnalyzer() ;
-
         /// @returns Binary decision diagram used for calculations.
-        Bdd *bdd_graph() { return bdd_graph_; }
+        Bdd *bdd_graph() { return bdd_graph_.get(); }
+
+        /// @returns The edge to the root of the analysis target
+        ///          in the compact BDD.
+        std::uint32_t root_edge() const { return bdd_graph_->root_edge(root_); }
+
+        /// @returns The probabilities of the compact BDD vertices
+        ///          from the last calculation.
+        const std::vector<double> &p_nodes() const { return p_nodes_; }
 
         double CalculateTotalProbability(
-                const Pdag::IndexMap<double> &p_vars)  final;
+                const Pdag::IndexMap<double> &p_vars)  final {
+            return CalculateTotalProbability(p_vars, &p_nodes_);
+        }
+
+        /// Calculates the total probability into the caller's storage,
+        /// so that concurrent calls are safe.
+        ///
+        /// @param[in] p_vars  A map of probabilities of the graph variables.
+        /// @param[out] p_nodes  The probabilities of the compact BDD vertices.
+        ///
+        /// @returns The total probability calculated with the given values.
+        double CalculateTotalProbability(const Pdag::IndexMap<double> &p_vars,
+                                         std::vector<double> *p_nodes) const;
+
+        std::vector<double> CalculateTotalProbabilities(
+                const std::vector<Pdag::IndexMap<double>> &p_vars)  final {
+            std::vector<double> results(p_vars.size());
+            std::vector<double> workspace;
+            CalculateTotalProbabilities(p_vars, results.data(), &workspace);
+            return results;
+        }
+
+        /// Calculates the total probabilities for a batch of probability sets
+        /// with one pass over the compact BDD per kBatchSize sets.
+        /// The vertex probabilities of the sets are laid out side by side
+        /// for vectorization of the calculations.
+        /// Concurrent calls are safe.
+        ///
+        /// @param[in] p_vars  Maps of probabilities of the graph variables.
+        /// @param[out] results  The total probabilities in the order of the sets.
+        /// @param[in,out] workspace  Storage for the vertex probabilities.
+        void CalculateTotalProbabilities(
+                const std::vector<Pdag::IndexMap<double>> &p_vars, double *results,
+                std::vector<double> *workspace) const;
+
+        /// Propagates the changes in the variable probabilities
+        /// only through the compact BDD vertices
+        /// on the paths from the changed variables to the root
+        /// (including the vertices of the affected modules).
+        /// The propagation stops at vertices with unchanged probabilities.
+        /// The vertex probabilities and the parent links are kept
+        /// between the updates.
+        ///
+        /// @copydetails ProbabilityAnalyzerBase::UpdateTotalProbability
+        ///
+        /// @warning Concurrent updates are not safe.
+        double UpdateTotalProbability(
+                const std::vector<std::pair<int, double>> &changes) override;
 
     private:
+        /// Bookkeeping for the incremental quantification.
+        struct DeltaState {
+            /// The parent vertices of the compact BDD vertices in CSR format.
+            /// @{
+            std::vector<std::uint32_t> parent_offsets;
+            std::vector<std::uint32_t> parents;
+            /// @}
+            /// The vertices of the variables in the order of indices.
+            /// @{
+            std::vector<std::uint32_t> vertex_offsets;
+            std::vector<std::uint32_t> vertices;
+            /// @}
+            std::vector<double> p;///< The up-to-date vertex probabilities.
+            std::vector<std::uint8_t> dirty;///< The vertices to recalculate.
+        };
+
+        /// Indexes the parents and variables of the compact BDD
+        /// and calculates the vertex probabilities for the first update.
+        void PrepareUpdates();
+
         /// Creates a new BDD for use by the analyzer.
         ///
         /// @param[in] fta  The fault tree analysis providing the root gate.
@@ -337,24 +545,60 @@ namespace scram::core {
         /// @pre The function is called in the constructor only once.
         void CreateBdd(const FaultTreeAnalysis &fta) ;
 
-        /// Calculates exact probability
-        /// of a function graph represented by its root BDD vertex.
+        std::shared_ptr<Bdd> bdd_graph_;///< The BDD possibly shared by targets.
+        int root_ = 0;///< The root of the target in the BDD.
+        std::vector<double> p_nodes_;///< Probabilities of compact BDD vertices.
+        std::unique_ptr<DeltaState> delta_;///< Lazy state of the updates.
+    };
+
+    /// Specialization of probability analyzer with Monte Carlo direct evaluation.
+    /// The preprocessed PDAG of the fault tree analysis is sampled directly;
+    /// products, if any, are not used for quantification.
+    template<>
+    class ProbabilityAnalyzer<DirectEval> : public ProbabilityAnalyzerBase {
+    public:
+        /// Constructs probability analyzer from a fault tree analyzer
+        /// with any algorithm.
+        ///
+        /// @tparam Algorithm  Fault tree analysis algorithm.
         ///
-        /// @param[in] vertex  The root vertex of a function graph.
-        /// @param[in] mark  A flag to mark traversed vertices.
-        /// @param[in] p_vars  The probabilities of the variables
-        ///                    mapped by their indices.
+        /// @copydetails ProbabilityAnalysis::ProbabilityAnalysis
+        template<class Algorithm>
+        ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm> *fta,
+                            mef::MissionTime *mission_time)
+            : ProbabilityAnalyzerBase(fta, mission_time),
+              direct_eval_(std::make_shared<DirectEval>(fta->graph(),
+                                                        Analysis::settings())) {}
+
+        /// Constructs probability analyzer for one root of a shared graph.
         ///
-        /// @returns Probability value.
+        /// @tparam Algorithm  Fault tree analysis algorithm.
         ///
-        /// @warning If a vertex is already marked with the input mark,
-        ///          it will not be traversed and updated with a probability value.
-        double CalculateProbability(const Bdd::VertexPtr &vertex, bool mark,
-                                    const Pdag::IndexMap<double> &p_vars) ;
+        /// @param[in] fta  Fault tree analyzer with the shared graph.
+        /// @param[in] mission_time  The mission time expression of the model.
+        /// @param[in] direct_eval  The evaluator compiled from the shared graph.
+        /// @param[in] target  The index of the root in the shared graph.
+        template<class Algorithm>
+        ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm> *fta,
+                            mef::MissionTime *mission_time,
+                            std::shared_ptr<DirectEval> direct_eval, int target)
+            : ProbabilityAnalyzerBase(fta, mission_time),
+              direct_eval_(std::move(direct_eval)),
+              target_(target) {}
+
+        double CalculateTotalProbability(
+                const Pdag::IndexMap<double> &p_vars)  final;
+
+    private:
+        /// Estimates the total probability
+        /// and records the estimate for reporting.
+        double CalculateTotalProbability()  override;
+
+        /// The direct evaluation shares its sampling state between calls.
+        int num_threads() const override { return 1; }
 
-        Bdd *bdd_graph_;   ///< The main BDD graph for analysis.
-        bool current_mark_;///< To keep track of BDD current mark.
-        bool owner_;       ///< Indication that pointers are handles.
+        std::shared_ptr<DirectEval> direct_eval_;///< The compiled PDAG.
+        int target_ = 0;///< The estimation target of the compiled PDAG.
     };
 
 }// namespace scram::core
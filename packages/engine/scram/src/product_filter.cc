@@ -32,22 +32,28 @@ struct ScoredProduct {
     double probability;
 };
 
+/// @returns The probability of a literal in a product.
+/// @returns 1 for indices outside of the basic events.
+double LiteralProbability(int literal, const Pdag &graph) {
+    const int kFirstIndex = Pdag::kVariableStartIndex;
+    const int kLastIndexExclusive =
+        kFirstIndex + static_cast<int>(graph.basic_events().size());
+    const int index = std::abs(literal);
+    if (index < kFirstIndex || index >= kLastIndexExclusive)
+        return 1.0;
+    const mef::BasicEvent *event = graph.basic_events()[index];
+    const double event_probability = event ? event->p() : 0.0;
+    return literal < 0 ? 1.0 - event_probability : event_probability;
+}
+
 } // namespace
 
-double CalculateProductProbability(const std::vector<int> &product,
+double CalculateProductProbability(std::span<const int> product,
                                     const Pdag &graph,
                                     double stop_threshold) {
-    const int kFirstIndex = Pdag::kVariableStartIndex;
-    const int kLastIndexExclusive =
-        kFirstIndex + static_cast<int>(graph.basic_events().size());
     double probability = 1.0;
     for (int literal : product) {
-        const int index = std::abs(literal);
-        if (index < kFirstIndex || index >= kLastIndexExclusive)
-            continue;
-        const mef::BasicEvent *event = graph.basic_events()[index];
-        const double event_probability = event ? event->p() : 0.0;
-        probability *= literal < 0 ? 1.0 - event_probability : event_probability;
+        probability *= LiteralProbability(literal, graph);
         if (stop_threshold >= 0.0 && probability < stop_threshold)
             break;
     }
@@ -63,55 +69,48 @@ ProductSummary FilterProducts(const Zbdd &products,
     const bool enforce_order = options.limit_order > 0;
     const bool enforce_cut_off = options.cut_off > 0.0;
     const bool adaptive_active = options.adaptive && options.adaptive_target > 0.0;
-    const bool filtering_requested = enforce_order || enforce_cut_off || adaptive_active;
     const bool requires_probability = enforce_cut_off || adaptive_active;
 
-    if (!filtering_requested) {
-        Pdag::IndexMap<bool> seen_events(graph.basic_events().size());
+    if (!requires_probability) {
+        // The products already respect the order limit,
+        // so the summary is counted without the enumeration of products.
+        const ProductCounter counter(products);
+        auto to_int = [](const ProductCounter::Count &count) {
+            return count > std::numeric_limits<int>::max()
+                       ? std::numeric_limits<int>::max()
+                       : static_cast<int>(count);
+        };
+        summary.original_product_count = to_int(counter.size());
+        summary.product_count = summary.original_product_count;
+        for (const ProductCounter::Count &count : counter.distribution())
+            summary.distribution.push_back(to_int(count));
+
         const int kFirstIndex = Pdag::kVariableStartIndex;
         const int kLastIndexExclusive = kFirstIndex + static_cast<int>(graph.basic_events().size());
-
-        for (const std::vector<int> &product : products) {
-            summary.original_product_count++;
-            summary.product_count++;
-            const int order_index = product.empty() ? 0 : static_cast<int>(product.size()) - 1;
-            if (static_cast<int>(summary.distribution.size()) <= order_index)
-                summary.distribution.resize(order_index + 1, 0);
-            summary.distribution[order_index]++;
-
-            for (int literal : product) {
-                const int index = std::abs(literal);
-                if (index < kFirstIndex || index >= kLastIndexExclusive)
-                    continue;
-                if (seen_events[index])
-                    continue;
-                seen_events[index] = true;
+        for (int index : counter.GatherEvents()) {
+            if (index >= kFirstIndex && index < kLastIndexExclusive)
                 summary.event_indices.push_back(index);
-            }
         }
-
-        boost::sort(summary.event_indices);
         return summary;
     }
 
     std::vector<ScoredProduct> retained;
     retained.reserve(64);
 
-    for (const std::vector<int> &product : products) {
+    // The running product probabilities come with the traversal;
+    // the traversal already skips the branches below the ZBDD cut-off.
+    const double frequency = graph.initiating_event_frequency();
+    auto literal_probability = [&graph](int literal) {
+        return LiteralProbability(literal, graph);
+    };
+    products.VisitProducts(literal_probability, [&](std::span<const int> product,
+                                                    double probability) {
         summary.original_product_count++;
 
         if (enforce_order && static_cast<int>(product.size()) > options.limit_order)
-            continue;
+            return;
 
-        double probability = 0.0;
-        if (requires_probability || adaptive_active) {
-            if (options.exact_quantification) {
-                const double stop_threshold = enforce_cut_off ? options.cut_off : -1.0;
-                probability = CalculateProductProbability(product, graph, stop_threshold);
-            } else {
-                probability = CalculateProductProbability(product, graph);
-            }
-        }
+        probability *= frequency;
 
         // Filter based on the mean of probability and machine epsilon.
         double epsilon = std::numeric_limits<double>::epsilon();
@@ -132,13 +131,13 @@ ProductSummary FilterProducts(const Zbdd &products,
         // threshold = std::sqrt(probability * epsilon);
 
         if (probability <= threshold)
-            continue;
+            return;
 
         if (enforce_cut_off && probability < options.cut_off)
-            continue;
+            return;
 
-        retained.push_back({product, probability});
-    }
+        retained.push_back({{product.begin(), product.end()}, probability});
+    });
 
     double applied_cut_off = enforce_cut_off ? options.cut_off : 0.0;
 
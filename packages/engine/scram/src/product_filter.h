@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <limits>
+#include <span>
 #include <vector>
 
 #include "fault_tree_analysis.h"
@@ -39,7 +40,7 @@ struct FilterOptions {
 
 /// Calculates the probability of a product, optionally short-circuiting
 /// when it falls below a stop threshold.
-double CalculateProductProbability(const std::vector<int> &product,
+double CalculateProductProbability(std::span<const int> product,
                                     const Pdag &graph,
                                     double stop_threshold = -1.0);
 
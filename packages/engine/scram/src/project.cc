@@ -176,6 +176,9 @@ void Project::SetLimits(const xml::Element& limits) {
     } else if (name == "cut-off") {
       settings_.cut_off(limit.text<double>());
 
+    } else if (name == "top-products") {
+      settings_.top_products(limit.text<int>());
+
     } else if (name == "mission-time") {
       settings_.mission_time(limit.text<double>());
 
@@ -191,6 +194,18 @@ void Project::SetLimits(const xml::Element& limits) {
     } else if (name == "number-of-bins") {
       settings_.num_bins(limit.text<int>());
 
+    } else if (name == "batch-size") {
+      settings_.batch_size(limit.text<int>());
+
+    } else if (name == "sample-size") {
+      settings_.sample_size(limit.text<int>());
+
+    } else if (name == "confidence") {
+      settings_.confidence(limit.text<double>());
+
+    } else if (name == "delta") {
+      settings_.delta(limit.text<double>());
+
     } else if (name == "seed") {
       settings_.seed(limit.text<int>());
     }
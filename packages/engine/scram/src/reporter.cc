@@ -196,10 +196,14 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
         break;
+      case core::Algorithm::kPdag:
+        methods.SetAttribute("name", "Direct Evaluation");
+        break;
     }
-    methods.AddChild("limits")
-        .AddChild("product-order")
-        .AddText(settings.limit_order());
+    xml::StreamElement limits = methods.AddChild("limits");
+    limits.AddChild("product-order").AddText(settings.limit_order());
+    if (settings.top_products())
+      limits.AddChild("top-products").AddText(settings.top_products());
   }
   if (settings.ccf_analysis()) {
     information->AddChild("calculated-quantity")
@@ -233,6 +237,9 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
     case core::Approximation::kMcub:
       methods.SetAttribute("name", "MCUB Approximation");
       break;
+    case core::Approximation::kMonteCarlo:
+      methods.SetAttribute("name", "Monte Carlo Direct Evaluation");
+      break;
   }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("mission-time").AddText(settings.mission_time());
@@ -385,6 +392,22 @@ void Reporter::ReportPerformance(
     if (result.preprocessing_seconds)
       calc_time.AddChild("preprocessing")
           .AddText(*result.preprocessing_seconds);
+
+    if (result.fault_tree_analysis &&
+        !result.fault_tree_analysis->preprocessor_passes().empty()) {
+      xml::StreamElement passes = calc_time.AddChild("preprocessing-passes");
+      for (const core::Preprocessor::PassMetrics& pass :
+           result.fault_tree_analysis->preprocessor_passes()) {
+        passes.AddChild("pass")
+            .SetAttribute("name", pass.name)
+            .SetAttribute("runs", pass.runs)
+            .SetAttribute("skips", pass.skips)
+            .SetAttribute("seconds", pass.seconds)
+            .SetAttribute("removed-gates", pass.removed_gates)
+            .SetAttribute("removed-args", pass.removed_args)
+            .SetAttribute("modules", pass.found_modules);
+      }
+    }
     
     if (result.fault_tree_analysis)
       calc_time.AddChild("products")
@@ -519,6 +542,15 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   if (prob_analysis)
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
 
+  if (prob_analysis && prob_analysis->estimate()) {
+    const core::ProbabilityEstimate& estimate = *prob_analysis->estimate();
+    sum_of_products.SetAttribute("standard-error", estimate.std_error)
+        .SetAttribute("confidence", estimate.confidence)
+        .SetAttribute("lower-bound", estimate.lower_bound)
+        .SetAttribute("upper-bound", estimate.upper_bound)
+        .SetAttribute("samples", static_cast<std::size_t>(estimate.num_samples));
+  }
+
   if (has_products && fta.products().empty() == false) {
     sum_of_products.SetAttribute(
         "distribution",
@@ -632,15 +664,13 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
       return;
     }
 
-    if (prob_analysis) {
-      for (const core::Product& product_set : fta.products())
-        sum += product_set.p();
-    }
-    for (const core::Product& product_set : fta.products()) {
+    if (prob_analysis)
+      sum = fta.products().CalculateSumOfProducts();  // No enumeration.
+
+    auto report = [&](const core::Product& product_set, double prob) {
       xml::StreamElement product = sum_of_products.AddChild("product");
       product.SetAttribute("order", product_set.order());
       if (prob_analysis) {
-        double prob = product_set.p();
         product.SetAttribute("probability", prob);
         if (sum != 0)
           product.SetAttribute("contribution", prob / sum);
@@ -648,6 +678,11 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
       for (const core::Literal& literal : product_set) {
         ReportLiteral(literal, &product);
       }
+    };
+    if (int limit = fta.settings().top_products()) {
+      fta.products().VisitTop(limit, report);  // The most probable first.
+    } else {
+      fta.products().Visit(report);
     }
   }
 }
@@ -669,6 +704,18 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
     }
   }
 
+  if (!prob_analysis.p_scenarios().empty()) {
+    xml::StreamElement scenarios = results->AddChild("scenarios");
+    scram::PutId(id, &scenarios);
+    const std::vector<core::Scenario>& requests = *prob_analysis.scenarios();
+    scenarios.SetAttribute("number", requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+      scenarios.AddChild("scenario")
+          .SetAttribute("name", requests[i].name)
+          .SetAttribute("value", prob_analysis.p_scenarios()[i]);
+    }
+  }
+
   if (prob_analysis.settings().safety_integrity_levels()) {
     xml::StreamElement sil = results->AddChild("safety-integrity-levels");
     scram::PutId(id, &sil);
@@ -23,17 +23,22 @@
 
 #include <iostream>
 #include "bdd.h"
+#include "direct_eval.h"
 #include "event.h"
 #include "expression/random_deviate.h"
 #include "ext/scope_guard.h"
 #include "fault_tree.h"
 #include "logger.h"
 #include "mocus.h"
+#include "parallel.h"
 #include "pdag.h"
+#include "preprocessor.h"
 #include "zbdd.h"
 
-#include <unordered_set>
+#include <algorithm>
 #include <string>
+#include <type_traits>
+#include <unordered_set>
 
 namespace scram::core {
 
@@ -89,9 +94,13 @@ void RiskAnalysis::RunAnalysis(const std::optional<Context> &context) {
     }
   }
 
-  // todo:: combine all initiating events and linked event trees into a unified PDAG if using MonteCarlo DirectEval Probability
+  // todo:: combine all initiating events (not only the sequences of one) and linked event trees into a unified PDAG
   // note:: multiple initiating events may point to the same event tree, which is totally fine, it should be a simple
   // link in the PDAG
+  // Independent analyses of targets in the order of their results.
+  // Event tree walks are sequential
+  // because they communicate through the model context.
+  std::vector<std::function<void()>> tasks;
   for (const mef::InitiatingEvent& initiating_event : model_->initiating_events()) {
     if (initiating_event.event_tree()) {
       const double initiating_frequency = initiating_event.frequency_value();
@@ -99,28 +108,43 @@ void RiskAnalysis::RunAnalysis(const std::optional<Context> &context) {
       auto eta = std::make_unique<EventTreeAnalysis>(initiating_event, Analysis::settings(), model_->context());
       eta->Analyze();
 
-      for (EventTreeAnalysis::Result& result : eta->sequences()) {
-          const mef::Sequence& sequence = result.sequence;
+      // All the sequences are analyzed in one shared graph,
+      // so the common fault-tree logic is preprocessed and converted once.
+      SequenceAnalysis shared_analysis;
+      if (!eta->sequences().empty()) {
+        std::vector<const mef::Gate*> roots;
+        for (const EventTreeAnalysis::Result& result : eta->sequences())
+          roots.push_back(result.gate.get());
+        shared_analysis = PrepareSequences(roots, initiating_frequency);
+      }
+
+      for (int i = 0; i < eta->sequences().size(); ++i) {
+        EventTreeAnalysis::Result* result = &eta->sequences()[i];
+        const mef::Sequence& sequence = result->sequence;
+        results_.push_back({{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{initiating_event, sequence}, context}});
+        tasks.emplace_back([this, result, index = results_.size() - 1, i,
+                            shared_analysis] {
+          const mef::Sequence& sequence = result->sequence;
           LOG(INFO) << "Running analysis for sequence: " << sequence.name();
-          
           CLOCK(sequence_analysis_time);
-          results_.push_back({{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{initiating_event, sequence}, context}});
-          RunAnalysis(*result.gate, &results_.back(), initiating_frequency);
+          Result& target_result = results_[index];
+          shared_analysis(*result->gate, i, &target_result);
 
-          if (result.is_expression_only) {
-            results_.back().fault_tree_analysis = nullptr;
-            results_.back().importance_analysis = nullptr;
+          if (result->is_expression_only) {
+            target_result.fault_tree_analysis = nullptr;
+            target_result.importance_analysis = nullptr;
           }
           if (Analysis::settings().probability_analysis()) {
             // p_total() already includes initiating_frequency since it was set in the PDAG
-            result.p_sequence = results_.back().probability_analysis->p_total();
+            result->p_sequence = target_result.probability_analysis->p_total();
           }
           const double sequence_total_time = DUR(sequence_analysis_time);
           // Store the total preprocessing/analysis time for this sequence
-          results_.back().preprocessing_seconds = sequence_total_time;
-          
-          LOG(INFO) << "Finished analysis for sequence: " << sequence.name() 
+          target_result.preprocessing_seconds = sequence_total_time;
+
+          LOG(INFO) << "Finished analysis for sequence: " << sequence.name()
                     << " in " << sequence_total_time << " seconds";
+        });
       }
       event_tree_results_.push_back({initiating_event, context, std::move(eta)});
       LOG(INFO) << "Finished event tree analysis: " << initiating_event.name();
@@ -145,20 +169,47 @@ void RiskAnalysis::RunAnalysis(const std::optional<Context> &context) {
   for (const mef::FaultTree& ft : model_->fault_trees()) {
     for (const mef::Gate* target : ft.top_events()) {
       if (!gate_results.contains(target)) {
-          LOG(INFO) << "Running analysis for gate: " << target->id();
-          CLOCK(gate_analysis_time);
           results_.push_back({{target, context}});
-          RunAnalysis(*target, &results_.back());
-          const double gate_total_time = DUR(gate_analysis_time);
-          // Store the total preprocessing/analysis time for this gate
-          results_.back().preprocessing_seconds = gate_total_time;
-          LOG(INFO) << "Finished analysis for gate: " << target->id() 
-                    << " in " << gate_total_time << " seconds";
+          tasks.emplace_back([this, target, index = results_.size() - 1] {
+            LOG(INFO) << "Running analysis for gate: " << target->id();
+            CLOCK(gate_analysis_time);
+            RunAnalysis(*target, &results_[index]);
+            const double gate_total_time = DUR(gate_analysis_time);
+            // Store the total preprocessing/analysis time for this gate
+            results_[index].preprocessing_seconds = gate_total_time;
+            LOG(INFO) << "Finished analysis for gate: " << target->id()
+                      << " in " << gate_total_time << " seconds";
+          });
       } else {
           LOG(INFO) << "Not re-running analysis for gate: " << target->id();
       }
     }
   }
+  RunTasks(tasks);
+}
+
+void RiskAnalysis::RunTasks(const std::vector<std::function<void()>>& tasks) {
+  int num_threads = Analysis::settings().num_threads();
+  if (num_threads > 1 && tasks.size() > 1 &&
+      (Analysis::settings().uncertainty_analysis() ||
+       Analysis::settings().time_step() || !scenarios_.empty())) {
+    // All mutate the shared model
+    // (sampled expressions, mission time, parameter overrides).
+    LOG(WARNING) << "Uncertainty, time-step, and scenario analyses"
+                    " run on a single thread.";
+    num_threads = 1;
+  }
+  // Each thread claims the next unstarted task,
+  // so long-running targets do not hold back the others.
+  num_threads = ParallelFor(tasks.size(), 1, num_threads, [&tasks](int) {
+    return [&tasks](std::size_t first, std::size_t last) {
+      for (std::size_t i = first; i < last; ++i)
+        tasks[i]();
+    };
+  });
+  if (num_threads > 1)
+    LOG(INFO) << "Ran " << tasks.size() << " analyses on " << num_threads
+              << " threads";
 }
 
 void RiskAnalysis::RunAnalysis(const mef::Gate& target, Result* result, double initiating_frequency)  {
@@ -169,9 +220,90 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target, Result* result, double i
       return RunAnalysis<Zbdd>(target, result, initiating_frequency);
     case Algorithm::kMocus:
         return RunAnalysis<Mocus>(target, result, initiating_frequency);
+    case Algorithm::kPdag:
+      return RunAnalysis<DirectEval>(target, result, initiating_frequency);
   }
 }
 
+RiskAnalysis::SequenceAnalysis RiskAnalysis::PrepareSequences(
+    const std::vector<const mef::Gate*>& roots, double initiating_frequency)  {
+  switch (Analysis::settings().algorithm()) {
+    case Algorithm::kBdd:
+      return PrepareSequences<Bdd>(roots, initiating_frequency);
+    case Algorithm::kZbdd:
+      return PrepareSequences<Zbdd>(roots, initiating_frequency);
+    case Algorithm::kMocus:
+      return PrepareSequences<Mocus>(roots, initiating_frequency);
+    case Algorithm::kPdag:
+      return PrepareSequences<DirectEval>(roots, initiating_frequency);
+  }
+  assert(false && "Unexpected algorithm.");
+  return {};
+}
+
+template <class Algorithm>
+RiskAnalysis::SequenceAnalysis RiskAnalysis::PrepareSequences(
+    const std::vector<const mef::Gate*>& roots, double initiating_frequency)  {
+  CLOCK(shared_time);
+  const Settings& settings = Analysis::settings();
+  auto graph = std::make_shared<Pdag>(roots, settings.ccf_analysis(), model_);
+  graph->initiating_event_frequency(initiating_frequency);
+  CustomPreprocessor<Algorithm>{graph.get(), settings}();
+  std::shared_ptr<Algorithm> algorithm;
+  if (settings.requires_products()) {
+    algorithm = std::make_shared<Algorithm>(graph.get(), settings);
+    algorithm->Analyze(graph.get());
+  }
+  // The calculators with their own structures share them as well.
+  std::shared_ptr<Bdd> bdd;
+  std::shared_ptr<DirectEval> direct_eval;
+  if (settings.probability_analysis() &&
+      settings.approximation() == Approximation::kNone) {
+    if constexpr (std::is_same_v<Algorithm, Bdd>) {
+      bdd = algorithm ? algorithm : std::make_shared<Bdd>(graph.get(), settings);
+    } else {
+      Pdag bdd_graph(roots, settings.ccf_analysis(), model_);
+      CustomPreprocessor<Bdd>{&bdd_graph, settings}();
+      bdd = std::make_shared<Bdd>(&bdd_graph, settings);
+    }
+    bdd->Compact();  // Before the concurrent sequence analyses.
+  } else if (settings.probability_analysis() &&
+             settings.approximation() == Approximation::kMonteCarlo) {
+    direct_eval = std::make_shared<DirectEval>(graph.get(), settings);
+  }
+  LOG(INFO) << "Preprocessed and analyzed " << roots.size()
+            << " sequences in one PDAG in " << DUR(shared_time);
+
+  return [this, graph, algorithm, bdd, direct_eval](const mef::Gate& target,
+                                                    int index, Result* result) {
+    auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
+        target, Analysis::settings(), model_);
+    fta->Analyze(graph, algorithm, index);
+    if (Analysis::settings().probability_analysis()) {
+      switch (Analysis::settings().approximation()) {
+        case Approximation::kNone:
+          RunAnalysis(std::make_unique<ProbabilityAnalyzer<Bdd>>(
+                          fta.get(), &model_->mission_time(), bdd, index),
+                      result);
+          break;
+        case Approximation::kRareEvent:
+          RunAnalysis<Algorithm, RareEventCalculator>(fta.get(), result);
+          break;
+        case Approximation::kMcub:
+          RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
+          break;
+        case Approximation::kMonteCarlo:
+          RunAnalysis(std::make_unique<ProbabilityAnalyzer<DirectEval>>(
+                          fta.get(), &model_->mission_time(), direct_eval,
+                          index),
+                      result);
+          break;
+      }
+    }
+    result->fault_tree_analysis = std::move(fta);
+  };
+}
+
 template <class Algorithm>
 void RiskAnalysis::RunAnalysis(const mef::Gate& target,
                                Result* result, double initiating_frequency)  {
@@ -197,6 +329,10 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target,
         LOG(INFO) << "[RiskAnalysis::RunAnalysis] Running with MCUB approximation...";
         RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
         break;
+      case Approximation::kMonteCarlo:
+        LOG(INFO) << "[RiskAnalysis::RunAnalysis] Running with Monte Carlo direct evaluation...";
+        RunAnalysis<Algorithm, DirectEval>(fta.get(), result);
+        break;
     }
   }
   LOG(INFO) << "[RiskAnalysis::RunAnalysis] Moving fta to result...";
@@ -207,10 +343,22 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target,
 template <class Algorithm, class Calculator>
 void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
                                Result* result)  {
-  auto pa = std::make_unique<ProbabilityAnalyzer<Calculator>>(fta, &model_->mission_time());
+  RunAnalysis(std::make_unique<ProbabilityAnalyzer<Calculator>>(
+                  fta, &model_->mission_time()),
+              result);
+}
 
+template <class Calculator>
+void RiskAnalysis::RunAnalysis(std::unique_ptr<ProbabilityAnalyzer<Calculator>> pa,
+                               Result* result)  {
+  if (!scenarios_.empty())
+    pa->scenarios(&scenarios_);
   pa->Analyze();
-  if (Analysis::settings().importance_analysis()) {
+  if (Analysis::settings().importance_analysis() &&
+      !Analysis::settings().requires_products()) {
+    LOG(WARNING) << "Importance analysis requires products; skipping for "
+                 << pa->fault_tree_analysis()->top_event().id() << ".";
+  } else if (Analysis::settings().importance_analysis()) {
     auto ia = std::make_unique<ImportanceAnalyzer<Calculator>>(pa.get());
     ia->Analyze();
     result->importance_analysis = std::move(ia);
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -119,6 +120,19 @@ class RiskAnalysis : public Analysis {
   /// @returns The results of the analysis.
   const std::vector<Result>& results() const { return results_; }
 
+  /// Requests what-if scenarios to be quantified for every analysis target
+  /// with the products or diagrams of the target.
+  ///
+  /// @param[in] scenarios  The overrides of the model values.
+  ///
+  /// @pre The scenarios are set before the analysis.
+  void scenarios(std::vector<Scenario> scenarios) {
+    scenarios_ = std::move(scenarios);
+  }
+
+  /// @returns The what-if scenarios of the analysis.
+  const std::vector<Scenario>& scenarios() const { return scenarios_; }
+
   /// @returns The results of the event tree analysis.
   const std::vector<EtaResult>& event_tree_results() const {
     return event_tree_results_;
@@ -142,6 +156,14 @@ class RiskAnalysis : public Analysis {
   /// @post The model is restored to the original state.
   void RunAnalysis(const std::optional<Context> &context = {}) ;
 
+  /// Runs independent analyses of targets,
+  /// concurrently if requested in the settings.
+  ///
+  /// @param[in] tasks  The analyses writing into distinct results.
+  ///
+  /// @throws The first exception thrown by the tasks.
+  void RunTasks(const std::vector<std::function<void()>>& tasks) ;
+
   /// Runs all possible analysis on a given target.
   /// Analysis types are deduced from the settings.
   ///
@@ -174,9 +196,44 @@ class RiskAnalysis : public Analysis {
   template <class Algorithm, class Calculator>
   void RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta, Result* result) ;
 
+  /// Runs Quantitative analysis with the given probability analyzer.
+  ///
+  /// @tparam Calculator  Quantitative analysis algorithm.
+  ///
+  /// @param[in] pa  The probability analyzer to run and store.
+  /// @param[in,out] result  The result container element.
+  template <class Calculator>
+  void RunAnalysis(std::unique_ptr<ProbabilityAnalyzer<Calculator>> pa,
+                   Result* result) ;
+
+  /// The analysis of an event-tree sequence
+  /// as a root of the graph shared by the sequences of an initiating event.
+  /// The arguments are the sequence gate, the index of its root,
+  /// and the result container element.
+  using SequenceAnalysis = std::function<void(const mef::Gate&, int, Result*)>;
+
+  /// Preprocesses the sequences of an initiating event as one multi-root graph
+  /// and runs the analyses shared by the sequences,
+  /// so the logic common to the sequences is processed only once.
+  ///
+  /// @param[in] roots  The sequence gates in the order of the roots.
+  /// @param[in] initiating_frequency  The frequency of the initiating event.
+  ///
+  /// @returns The analysis of a sequence with the shared results.
+  SequenceAnalysis PrepareSequences(const std::vector<const mef::Gate*>& roots,
+                                    double initiating_frequency) ;
+
+  /// @copydoc PrepareSequences
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  template <class Algorithm>
+  SequenceAnalysis PrepareSequences(const std::vector<const mef::Gate*>& roots,
+                                    double initiating_frequency) ;
+
   mef::Model* model_;  ///< The model with constructs.
   std::vector<Result> results_;  ///< The analysis result storage.
   std::vector<EtaResult> event_tree_results_;  ///< Grouping of sequences.
+  std::vector<Scenario> scenarios_;  ///< The what-if requests for the targets.
 
   std::optional<RuntimeMetrics> runtime_metrics_;
 };
@@ -33,6 +33,11 @@ Settings& Settings::algorithm(Algorithm value)  {
     case Algorithm::kBdd:
       approximation(Approximation::kNone);
       break;
+    case Algorithm::kPdag:
+      if (prime_implicants_)
+        prime_implicants(false);
+      approximation(Approximation::kMonteCarlo);
+      break;
     default:
       if (approximation_ == Approximation::kNone)
         approximation(Approximation::kRareEvent);
@@ -57,6 +62,10 @@ Settings& Settings::approximation(Approximation value) {
     if (prime_implicants_ && (value == Approximation::kMcub || value == Approximation::kRareEvent)) {
         SCRAM_THROW(SettingsError("Prime implicants cannot be computed when using mcub or rare-event approximations."));
     }
+  if (algorithm_ == Algorithm::kPdag && value != Approximation::kMonteCarlo)
+    SCRAM_THROW(SettingsError(
+        "The PDAG algorithm requires the Monte Carlo approximation."))
+        << errinfo_value(kApproximationToString[static_cast<int>(value)]);
   approximation_ = value;
   return *this;
 }
@@ -73,8 +82,8 @@ Settings& Settings::approximation(std::string_view value) {
 }
 
 Settings& Settings::prime_implicants(bool flag) {
-  if (flag && (algorithm_ == Algorithm::kMocus || algorithm_ == Algorithm::kZbdd))
-    SCRAM_THROW(SettingsError("Prime implicants can only be calculated with BDD or PDAG"));
+  if (flag && algorithm_ != Algorithm::kBdd)
+    SCRAM_THROW(SettingsError("Prime implicants can only be calculated with BDD"));
   prime_implicants_ = flag;
   return *this;
 }
@@ -99,6 +108,33 @@ Settings& Settings::cut_off(double prob) {
   return *this;
 }
 
+Settings& Settings::top_products(int n) {
+  if (n < 0)
+    SCRAM_THROW(SettingsError("The number of top products cannot be negative."))
+        << errinfo_value(std::to_string(n));
+
+  top_products_ = n;
+  return *this;
+}
+
+Settings& Settings::reorder_time(double time) {
+  if (time < 0)
+    SCRAM_THROW(SettingsError("The reordering time cannot be negative."))
+        << errinfo_value(std::to_string(time));
+
+  reorder_time_ = time;
+  return *this;
+}
+
+Settings& Settings::preprocessing_time(double time) {
+  if (time < 0)
+    SCRAM_THROW(SettingsError("The preprocessing time cannot be negative."))
+        << errinfo_value(std::to_string(time));
+
+  preprocessing_time_ = time;
+  return *this;
+}
+
 Settings& Settings::num_quantiles(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of quantiles cannot be less than 1."))
@@ -126,6 +162,52 @@ Settings& Settings::num_trials(int n) {
   return *this;
 }
 
+Settings& Settings::batch_size(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The batch size cannot be less than 1."))
+        << errinfo_value(std::to_string(n));
+
+  batch_size_ = n;
+  return *this;
+}
+
+Settings& Settings::sample_size(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The sample size cannot be less than 1."))
+        << errinfo_value(std::to_string(n));
+
+  sample_size_ = n;
+  return *this;
+}
+
+Settings& Settings::confidence(double level) {
+  if (level <= 0 || level >= 1)
+    SCRAM_THROW(
+        SettingsError("The confidence level must be in the (0, 1) range."))
+        << errinfo_value(std::to_string(level));
+
+  confidence_ = level;
+  return *this;
+}
+
+Settings& Settings::delta(double value) {
+  if (value < 0)
+    SCRAM_THROW(SettingsError("The relative precision cannot be negative."))
+        << errinfo_value(std::to_string(value));
+
+  delta_ = value;
+  return *this;
+}
+
+Settings& Settings::num_threads(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The number of threads cannot be less than 1."))
+        << errinfo_value(std::to_string(n));
+
+  num_threads_ = n;
+  return *this;
+}
+
 Settings& Settings::seed(int s) {
   if (s < 0)
     SCRAM_THROW(SettingsError("The seed for PRNG cannot be negative."))
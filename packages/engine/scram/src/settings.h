@@ -36,16 +36,25 @@
 namespace scram::core {
 
 /// Qualitative analysis algorithms.
-enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus };
+///
+/// The PDAG algorithm skips qualitative analysis altogether
+/// and evaluates the preprocessed graph directly.
+enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus, kPdag };
 
 /// String representations for algorithms.
-const char* const kAlgorithmToString[] = { "bdd", "zbdd", "mocus" };
+const char* const kAlgorithmToString[] = { "bdd", "zbdd", "mocus", "pdag" };
 
 /// Quantitative analysis approximations.
-enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
+enum class Approximation : std::uint8_t {
+  kNone = 0,
+  kRareEvent,
+  kMcub,
+  kMonteCarlo
+};
 
 /// String representations for approximations.
-const char* const kApproximationToString[] = { "none", "rare-event", "mcub" };
+const char* const kApproximationToString[] = { "none", "rare-event", "mcub",
+                                               "monte-carlo" };
 
 /// Builder for analysis settings.
 /// Analysis facilities are guaranteed not to throw or fail
@@ -67,6 +76,7 @@ class Settings {
   /// MOCUS and ZBDD based analyses run
   /// with the Rare-Event approximation by default.
   /// Whereas, BDD based analyses run with exact quantitative analysis.
+  /// PDAG based analyses run only with the Monte Carlo approximation.
   ///
   /// @param[in] value  The algorithm kind.
   ///
@@ -140,6 +150,52 @@ class Settings {
   /// @throws SettingsError  The probability is not in the [0, 1] range.
   Settings& cut_off(double prob);
 
+  /// @returns The number of the most probable products to report.
+  ///          0 if all the products are reported.
+  [[nodiscard]] int top_products() const { return top_products_; }
+
+  /// Limits the reported products to the most probable ones,
+  /// which are extracted best-first
+  /// without the enumeration of all the products.
+  ///
+  /// @param[in] n  A non-negative number of products (0 to report all).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& top_products(int n);
+
+  /// @returns The time budget in seconds for dynamic BDD variable reordering.
+  ///          0 if the variable order is fixed.
+  [[nodiscard]] double reorder_time() const { return reorder_time_; }
+
+  /// Sets the time budget for sifting of BDD variables
+  /// upon growth of the BDD.
+  /// 0 value keeps the initial variable ordering from the PDAG.
+  ///
+  /// @param[in] time  The time in seconds per BDD.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The time value is negative.
+  Settings& reorder_time(double time);
+
+  /// @returns The time budget in seconds for optional preprocessing passes.
+  ///          0 if the preprocessing time is unlimited.
+  [[nodiscard]] double preprocessing_time() const { return preprocessing_time_; }
+
+  /// Sets the time budget for preprocessing of a graph.
+  /// Optional optimization passes are skipped
+  /// once the preprocessing time exceeds the budget.
+  /// 0 value runs all the passes.
+  ///
+  /// @param[in] time  The time in seconds per graph.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The time value is negative.
+  Settings& preprocessing_time(double time);
+
   /// @returns The number of quantiles for distributions.
   [[nodiscard]] int num_quantiles() const { return num_quantiles_; }
 
@@ -176,6 +232,59 @@ class Settings {
   /// @throws SettingsError  The number is less than 1.
   Settings& num_trials(int n);
 
+  /// @returns The number of 64-bit sample words
+  ///          evaluated together in one pass of direct evaluation.
+  [[nodiscard]] int batch_size() const { return batch_size_; }
+
+  /// Sets the number of 64-bit sample words per direct-evaluation pass.
+  /// Each word packs 64 independent Monte Carlo samples.
+  ///
+  /// @param[in] n  A natural number for the batch size.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& batch_size(int n);
+
+  /// @returns The maximum number of batches for direct evaluation.
+  [[nodiscard]] int sample_size() const { return sample_size_; }
+
+  /// Sets the maximum number of batches for direct evaluation.
+  /// The total number of samples is 64 * batch_size * sample_size.
+  ///
+  /// @param[in] n  A natural number for the number of batches.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& sample_size(int n);
+
+  /// @returns The confidence level for Monte Carlo interval estimates.
+  [[nodiscard]] double confidence() const { return confidence_; }
+
+  /// Sets the confidence level for Monte Carlo interval estimates.
+  ///
+  /// @param[in] level  The two-sided confidence level in (0, 1).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The level is not in the (0, 1) range.
+  Settings& confidence(double level);
+
+  /// @returns The target relative half-width of the confidence interval.
+  ///          0 if the sampling runs to the sample size.
+  [[nodiscard]] double delta() const { return delta_; }
+
+  /// Sets the target relative half-width of the confidence interval
+  /// for early termination of direct evaluation.
+  ///
+  /// @param[in] value  A non-negative relative precision (0 to disable).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The value is negative.
+  Settings& delta(double value);
+
   /// @returns The seed of the pseudo-random number generator.
   [[nodiscard]] int seed() const { return seed_; }
 
@@ -188,6 +297,21 @@ class Settings {
   /// @throws SettingsError  The number is negative.
   Settings& seed(int s);
 
+  /// @returns The number of threads for concurrent analyses of targets.
+  [[nodiscard]] int num_threads() const { return num_threads_; }
+
+  /// Sets the number of threads
+  /// to analyze independent targets (sequences, top events) concurrently,
+  /// to run the trials of uncertainty analysis,
+  /// and to analyze independent modules of a target.
+  ///
+  /// @param[in] n  A natural number for the number of threads.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& num_threads(int n);
+
   /// @returns The length time of the system under risk.
   [[nodiscard]] double mission_time() const { return mission_time_; }
 
@@ -268,6 +392,10 @@ class Settings {
   /// implicants, importance/uncertainty, or debug printing), products are
   /// required.
   [[nodiscard]] bool requires_products() const {
+    // Direct evaluation never enumerates products.
+    if (algorithm_ == Algorithm::kPdag)
+      return false;
+
     if (adaptive_)
       return true;
 
@@ -286,8 +414,9 @@ class Settings {
       return true;
 #endif
 
-    // Approximations rely on cut sets.
-    if (approximation_ != Approximation::kNone)
+    // Approximations rely on cut sets except for sampling.
+    if (approximation_ != Approximation::kNone &&
+        approximation_ != Approximation::kMonteCarlo)
       return true;
 
     // Otherwise, BDD can compute probabilities directly without products.
@@ -410,13 +539,21 @@ class Settings {
   bool bit_pack_cut_sets_ = false;                    ///< Serialize cut sets as packed bit-vectors.
   bool adaptive_ = false;                             ///< A flag for adaptive quantification.
   int limit_order_ = 20;                              ///< Limit on the order of products.
+  int top_products_ = 0;                              ///< The number of reported products.
   int seed_ = 372;                                    ///< The seed for the pseudo-random number generator.
   int num_trials_ = 1000;                             ///< The number of trials for Monte Carlo simulations.
+  int num_threads_ = 1;                               ///< The number of threads for target analyses.
+  int batch_size_ = 16;                               ///< The number of 64-bit sample words per pass.
+  int sample_size_ = 1000;                            ///< The maximum number of sample batches.
+  double confidence_ = 0.95;                          ///< The confidence level for interval estimates.
+  double delta_ = 0;                                  ///< The relative half-width for early stopping.
   int num_quantiles_ = 20;                            ///< The number of quantiles for distributions.
   int num_bins_ = 20;                                 ///< The number of bins for histograms.
   double mission_time_ = 8760;                        ///< System mission time.
   double time_step_ = 0;                              ///< The time step for probability analyses.
   double cut_off_ = 1e-20;                             ///< The cut-off probability for products.
+  double reorder_time_ = 0;                           ///< The time budget for BDD reordering.
+  double preprocessing_time_ = 0;                     ///< The time budget for preprocessing.
 
   // Graph Compilation Options
   bool keep_null_gates_ = false;
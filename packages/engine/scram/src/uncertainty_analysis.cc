@@ -23,6 +23,7 @@
 
 #include <cmath>
 #include <algorithm>            // std::clamp
+#include <memory>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/density.hpp>
@@ -33,7 +34,9 @@
 
 #include "event.h"
 #include "expression.h"
+#include "expression/random_deviate.h"
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram::core {
 
@@ -89,6 +92,37 @@ void UncertaintyAnalysis::SampleExpressions(
   }
 }
 
+std::vector<double> UncertaintyAnalysis::SampleTrials(
+    const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
+    const Pdag::IndexMap<double>& p_vars, int num_threads,
+    const TrialCalculator& calculate) {
+  int num_trials = Analysis::settings().num_trials();
+  const int batch_size = ProbabilityAnalyzerBase::kBatchSize;
+  std::vector<double> samples(num_trials);
+  num_threads = ParallelFor(
+      num_trials, batch_size, num_threads, [&](int actual_threads) {
+        // Concurrent threads keep their sampled values apart.
+        std::unique_ptr<mef::Expression::SampleTable> sample_table;
+        if (actual_threads > 1)
+          sample_table = std::make_unique<mef::Expression::SampleTable>();
+        std::vector<Pdag::IndexMap<double>> batch(batch_size, p_vars);
+        return [&, sample_table = std::move(sample_table),
+                batch = std::move(batch), workspace = std::vector<double>()](
+                   std::size_t first, std::size_t last) mutable {
+          batch.resize(last - first);
+          for (int i = 0; i < static_cast<int>(batch.size()); ++i) {
+            mef::RandomDeviate::stream(first + i);
+            SampleExpressions(deviate_expressions, &batch[i]);
+          }
+          calculate(batch, &samples[first], &workspace);
+        };
+      });
+  if (num_threads > 1)
+    LOG(DEBUG3) << "Sampled " << num_trials << " trials on " << num_threads
+                << " threads";
+  return samples;
+}
+
 void UncertaintyAnalysis::CalculateStatistics(
     const std::vector<double>& samples)  {
   using namespace boost;  // NOLINT
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -93,6 +94,30 @@ class UncertaintyAnalysis : public Analysis {
       const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
       Pdag::IndexMap<double>* p_vars) ;
 
+  /// Calculator of the total probabilities of a batch of trials
+  /// into the results (the second argument).
+  /// The last argument is storage private to the calling thread.
+  using TrialCalculator =
+      std::function<void(const std::vector<Pdag::IndexMap<double>>&, double*,
+                         std::vector<double>*)>;
+
+  /// Runs Monte Carlo trials concurrently
+  /// in batches of ProbabilityAnalyzerBase::kBatchSize trials.
+  /// Every trial samples its own RNG stream
+  /// keyed by the seed and the trial number,
+  /// so the samples are the same for any number of threads.
+  ///
+  /// @param[in] deviate_expressions  A collection of deviate expressions.
+  /// @param[in] p_vars  Indices to probabilities mapping with mean values.
+  /// @param[in] num_threads  The number of threads to run the trials.
+  /// @param[in] calculate  The calculator safe for concurrent calls.
+  ///
+  /// @returns The sampled total probabilities in the order of trials.
+  std::vector<double> SampleTrials(
+      const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
+      const Pdag::IndexMap<double>& p_vars, int num_threads,
+      const TrialCalculator& calculate);
+
  private:
   /// Performs Monte Carlo Simulation
    /// by sampling the probability distributions
@@ -135,6 +160,21 @@ class UncertaintyAnalyzer : public UncertaintyAnalysis {
   /// @returns Samples of the total probability.
   std::vector<double> Sample()  override;
 
+  /// @returns The number of threads to sample with.
+  int num_threads() const { return Analysis::settings().num_threads(); }
+
+  /// Calculates the total probabilities of a batch of trials.
+  ///
+  /// @param[in] p_vars  The sampled probabilities of the variables.
+  /// @param[out] results  The total probabilities in the order of trials.
+  /// @param[in,out] workspace  Storage private to the calling thread.
+  void CalculateProbabilities(const std::vector<Pdag::IndexMap<double>>& p_vars,
+                              double* results,
+                              std::vector<double>* /*workspace*/) {
+    for (const Pdag::IndexMap<double>& trial : p_vars)
+      *results++ = prob_analyzer_->CalculateTotalProbability(trial);
+  }
+
   /// Calculator of the total probability.
   ProbabilityAnalyzer<Calculator>* prob_analyzer_;
 };
@@ -143,18 +183,30 @@ template <class Calculator>
 std::vector<double> UncertaintyAnalyzer<Calculator>::Sample()  {
   std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
       UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph());
-  Pdag::IndexMap<double> p_vars = prob_analyzer_->p_vars();  // Private copy!
-  std::vector<double> samples;
-  samples.reserve(Analysis::settings().num_trials());
-
-  for (int i = 0; i < Analysis::settings().num_trials(); ++i) {
-    UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
-    double result = prob_analyzer_->CalculateTotalProbability(p_vars);
-    assert(result >= 0 && result <= 1);
-    samples.push_back(prob_analyzer_->ApplyInitiatingEventFrequency(result));
-  }
+  return UncertaintyAnalysis::SampleTrials(
+      deviate_expressions, prob_analyzer_->p_vars(), num_threads(),
+      [this](const std::vector<Pdag::IndexMap<double>>& p_vars,
+             double* results, std::vector<double>* workspace) {
+        CalculateProbabilities(p_vars, results, workspace);
+        for (std::size_t i = 0; i < p_vars.size(); ++i) {
+          assert(results[i] >= 0 && results[i] <= 1);
+          results[i] = prob_analyzer_->ApplyInitiatingEventFrequency(results[i]);
+        }
+      });
+}
+
+/// The trials are calculated together in one pass over the BDD.
+template <>
+inline void UncertaintyAnalyzer<Bdd>::CalculateProbabilities(
+    const std::vector<Pdag::IndexMap<double>>& p_vars, double* results,
+    std::vector<double>* workspace) {
+  prob_analyzer_->CalculateTotalProbabilities(p_vars, results, workspace);
+}
 
-  return samples;
+/// The direct evaluation shares its sampling state between calls.
+template <>
+inline int UncertaintyAnalyzer<DirectEval>::num_threads() const {
+  return 1;
 }
 
 }  // namespace scram::core
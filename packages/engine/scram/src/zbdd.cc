@@ -25,12 +25,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <optional>
+#include <queue>
 
 #include <boost/range/algorithm.hpp>
 
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram::core {
 
@@ -66,36 +69,65 @@ Zbdd::Zbdd(Bdd* bdd, const Settings& settings)
   CHECK_ZBDD(true);
 }
 
+Zbdd::Zbdd(Bdd* bdd, int root, const Settings& settings)
+    : Zbdd(bdd->roots()[root], bdd->coherent(), bdd, settings) {
+  CHECK_ZBDD(true);
+}
+
+// The pass-through pin keeps the host of a multi-root graph unconverted.
 Zbdd::Zbdd(const Pdag* graph, const Settings& settings)
-    : Zbdd(graph->root(), settings) {
+    : Zbdd(graph->roots().empty() ? graph->root() : *graph->roots().front(),
+           settings) {
   assert(!graph->complement() && "Complements must be propagated.");
-  if (graph->IsTrivial()) {
-    const Gate& top_gate = graph->root();
-    assert(top_gate.args().size() == 1);
-    assert(top_gate.args<Gate>().empty());
-    int child = *top_gate.args().begin();
-    if (top_gate.constant()) {
-      root_ = child < 0 ? kEmpty_ : kBase_;
-    } else if (child < 0) {
-      root_ = kBase_;
-    } else {
-      const Variable& var = top_gate.args<Variable>().begin()->second;
-      root_ = FindOrAddVertex(var.index(), kBase_, kEmpty_, var.order());
-    }
+  if (!graph->roots().empty()) {
+    for (int i = 0; i < graph->roots().size(); ++i)
+      root_graphs_.emplace_back(new Zbdd(graph, i, settings));
+  } else if (graph->IsTrivial()) {
+    root_ = ConvertPassThrough(graph->root());
+  }
+  CHECK_ZBDD(true);
+}
+
+Zbdd::Zbdd(const Pdag* graph, int root, const Settings& settings)
+    : Zbdd(graph->roots()[root]->args<Gate>().empty()
+               ? *graph->roots()[root]
+               : *graph->roots()[root]->args<Gate>().begin()->second,
+           settings) {
+  const Gate& pin = *graph->roots()[root];
+  assert(pin.args().size() == 1);
+  if (pin.args<Gate>().empty()) {
+    root_ = ConvertPassThrough(pin);
+  } else {
+    assert(*pin.args().begin() > 0 && "Complements must be propagated.");
   }
   CHECK_ZBDD(true);
 }
 
+Zbdd::VertexPtr Zbdd::ConvertPassThrough(const Gate& gate)  {
+  assert(gate.args().size() == 1);
+  assert(gate.args<Gate>().empty());
+  int child = *gate.args().begin();
+  if (gate.constant())
+    return child < 0 ? kEmpty_ : kBase_;
+  if (child < 0)
+    return kBase_;
+  const Variable& var = gate.args<Variable>().begin()->second;
+  return FindOrAddVertex(var.index(), kBase_, kEmpty_, var.order());
+}
+
 void Zbdd::Analyze(const Pdag* graph)  {
+  for (const std::unique_ptr<Zbdd>& root_graph : root_graphs_)
+    root_graph->Analyze(graph);
   CLOCK(zbdd_time);
-  assert(root_->terminal() ||
-         SetNode::Ref(root_).max_set_order() <= kSettings_.limit_order());
-  root_ = Minimize(root_);  // Likely to be minimal by now.
-  assert(root_->terminal() || SetNode::Ref(root_).minimal());
+  std::vector<Zbdd*> modules;  // Including the modules of modules.
   for (const auto& entry : modules_)
-    entry.second->Analyze();
-
-  Prune(root_, kSettings_.limit_order());
+    modules.push_back(entry.second.get());
+  for (std::size_t i = 0; i < modules.size(); ++i) {
+    for (const auto& entry : modules[i]->modules_)
+      modules.push_back(entry.second.get());
+  }
+  AnalyzeModules(modules);
+  Reduce();
   if (graph)
     ApplySubstitutions(graph->substitutions());
 
@@ -103,10 +135,41 @@ void Zbdd::Analyze(const Pdag* graph)  {
   LOG(DEBUG3) << "G" << module_index_ << " analysis time: " << DUR(zbdd_time);
 }
 
+void Zbdd::Reduce()  {
+  assert(root_->terminal() ||
+         SetNode::Ref(root_).max_set_order() <= kSettings_.limit_order());
+  root_ = Minimize(root_);  // Likely to be minimal by now.
+  assert(root_->terminal() || SetNode::Ref(root_).minimal());
+  Prune(root_, kSettings_.limit_order(), limit_weight());
+}
+
+void Zbdd::AnalyzeModules(const std::vector<Zbdd*>& modules)  {
+  auto analyze = [](Zbdd* module) {
+    CLOCK(module_time);
+    module->Reduce();
+    module->Freeze();
+    LOG(DEBUG3) << "G" << module->module_index_
+                << " analysis time: " << DUR(module_time);
+  };
+  // Modules share no vertices or tables with each other.
+  int num_threads = ParallelFor(
+      modules.size(), 1, kSettings_.num_threads(), [&](int) {
+        return [&](std::size_t first, std::size_t last) {
+          for (std::size_t i = first; i < last; ++i)
+            analyze(modules[i]);
+        };
+      });
+  if (num_threads > 1)
+    LOG(DEBUG4) << "Analyzed " << modules.size() << " ZBDD modules on "
+                << num_threads << " threads";
+}
+
 void Zbdd::SetProbabilityContext(const Pdag* pdag) {
   pdag_ = pdag;
   for (auto& entry : modules_)
     entry.second->SetProbabilityContext(pdag);
+  for (const std::unique_ptr<Zbdd>& root_graph : root_graphs_)
+    root_graph->SetProbabilityContext(pdag);
 }
 
 double Zbdd::LiteralProbability(int literal) const {
@@ -130,6 +193,29 @@ double Zbdd::LiteralProbability(int literal) const {
   return literal < 0 ? 1.0 - probability : probability;
 }
 
+int Zbdd::limit_weight() const {
+  if (!HasProbabilityContext())
+    return kMaxWeight;
+  double frequency = pdag_->initiating_event_frequency();
+  if (!(frequency > 0.0) || !std::isfinite(frequency))
+    return kMaxWeight;
+  double bits = -std::log2(kSettings_.cut_off() / frequency);
+  if (!(bits >= 0.0))  // The cut-off is above any product probability.
+    return kMaxWeight;
+  return std::min(std::floor(bits * kWeightScale), double(kMaxWeight));
+}
+
+int Zbdd::LiteralWeight(const SetNode& node)  {
+  if (!HasProbabilityContext() || MayBeUnity(node) || IsGate(node))
+    return 0;
+  double probability = LiteralProbability(node.index());
+  if (!(probability > 0.0))
+    return kMaxWeight;
+  // The slack guards the rounding down against the error of the logarithm.
+  double weight = std::floor(-std::log2(probability) * kWeightScale - 1e-9);
+  return std::clamp(weight, 0.0, double(kMaxWeight));
+}
+
 Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index, const Pdag* pdag)
     : kBase_(new Terminal<SetNode>(true)),
       kEmpty_(new Terminal<SetNode>(false)),
@@ -138,6 +224,7 @@ Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index, const Pdag
       root_(kEmpty_),
       coherent_(coherent),
       module_index_(module_index),
+      pool_(new VertexPool<SetNode>),
       set_id_(2) {}
 
 Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
@@ -187,7 +274,8 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings)
     return;
   assert(!settings.prime_implicants() && "Not implemented.");
   CLOCK(init_time);
-  assert(gate.module() && "The constructor is meant for module gates.");
+  assert((gate.module() || gate.graph().NumPins(gate)) &&
+         "The constructor is meant for module and root gates.");
   LOG(DEBUG3) << "Converting module to ZBDD: G" << gate.index();
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
   std::unordered_map<int, std::pair<VertexPtr, int>> gates;
@@ -235,13 +323,19 @@ SetNodePtr Zbdd::FindOrAddVertex(int index, const VertexPtr& high,
   if (!in_table.expired())
     return in_table.lock();
   assert(order > 0 && "Improper order.");
-  SetNodePtr node(new SetNode(index, order, set_id_++, high, low));
+  SetNodePtr node(pool_->Create(index, order, set_id_++, high, low));
   node->module(module);
   node->coherent(coherent);
   int high_order = high->terminal() ? 0 : SetNode::Ref(high).max_set_order();
   high_order += !MayBeUnity(*node);
   int low_order = low->terminal() ? 0 : SetNode::Ref(low).max_set_order();
   node->max_set_order(std::max(high_order, low_order));
+  node->weight(LiteralWeight(*node));
+  int high_weight =
+      high->terminal() ? 0 : SetNode::Ref(high).max_set_weight();
+  high_weight = std::min(high_weight + node->weight(), kMaxWeight);
+  int low_weight = low->terminal() ? 0 : SetNode::Ref(low).max_set_weight();
+  node->max_set_weight(std::max(high_weight, low_weight));
 
   in_table = node;
   return node;
@@ -388,7 +482,8 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   });
   auto it = args.cbegin();
   for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+    result = Apply(gate.type(), result, *it, kSettings_.limit_order(),
+                   limit_weight());
   }
   ClearTables();
   assert(result);
@@ -399,15 +494,17 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   return result;
 }
 
-Triplet Zbdd::GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                           int order)  {
+Quadruplet Zbdd::GetResultKey(const VertexPtr& arg_one,
+                              const VertexPtr& arg_two, int order,
+                              int weight)  {
   assert(order >= 0 && "Illegal order for computations.");
+  assert(weight >= 0 && "Illegal weight for computations.");
   assert(!arg_one->terminal() && !arg_two->terminal());
   assert(arg_one->id() && arg_two->id());
   assert(arg_one->id() != arg_two->id());
   int min_id = std::min(arg_one->id(), arg_two->id());
   int max_id = std::max(arg_one->id(), arg_two->id());
-  return {min_id, max_id, order};
+  return {min_id, max_id, order, weight};
 }
 
 /// Forward declarations of interdependent Apply operation specializations.
@@ -415,41 +512,46 @@ Triplet Zbdd::GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
                                   const VertexPtr& arg_two,
-                                  int limit_order) ;
+                                  int limit_order, int limit_weight) ;
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
                                  const VertexPtr& arg_two,
-                                 int limit_order) ;
+                                 int limit_order, int limit_weight) ;
 /// @}
 
 /// Specialization of Apply for AND connective for non-terminal ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
                                   const SetNodePtr& arg_two,
-                                  int limit_order)  {
+                                  int limit_order, int limit_weight)  {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  int weight_high = limit_weight - arg_one->weight();
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
     // (x*f1 + f0) * (x*g1 + g0) = x*(f1*(g1 + g0) + f0*g1) + f0*g0
     high = Apply<kOr>(
         Apply<kAnd>(arg_one->high(),
-                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high),
-                    limit_high),
-        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high), limit_high);
-    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order);
+                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high,
+                               weight_high),
+                    limit_high, weight_high),
+        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high, weight_high),
+        limit_high, weight_high);
+    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order,
+                      limit_weight);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
            "Ordering contract failed.");
     if (arg_one->order() == arg_two->order()) {
       // (x*f1 + f0) * (~x*g1 + g0) = x*f1*g0 + f0*(~x*g1 + g0)
-      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high,
+                         weight_high);
     } else {
-      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high, weight_high);
     }
-    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order);
+    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order, limit_weight);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -462,23 +564,24 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
                                   const VertexPtr& arg_two,
-                                  int limit_order)  {
-  if (limit_order < 0)
+                                  int limit_order, int limit_weight)  {
+  if (limit_order < 0 || limit_weight < 0)
     return kEmpty_;
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
-      return Prune(arg_two, limit_order);
+      return Prune(arg_two, limit_order, limit_weight);
     return kEmpty_;
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
-      return Prune(arg_one, limit_order);
+      return Prune(arg_one, limit_order, limit_weight);
     return kEmpty_;
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, limit_weight);
 
-  VertexPtr& result = and_table_[GetResultKey(arg_one, arg_two, limit_order)];
+  VertexPtr& result =
+      and_table_[GetResultKey(arg_one, arg_two, limit_order, limit_weight)];
   if (result)
     return result;  // Already computed.
 
@@ -490,9 +593,11 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kAnd>(set_one, set_two, limit_order);
+  result = Apply<kAnd>(set_one, set_two, limit_order, limit_weight);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
+  assert(result->terminal() ||
+         SetNode::Ref(result).max_set_weight() <= limit_weight);
   return result;
 }
 
@@ -500,14 +605,17 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
                                  const SetNodePtr& arg_two,
-                                 int limit_order)  {
+                                 int limit_order, int limit_weight)  {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  int weight_high = limit_weight - arg_one->weight();
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
-    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order);
+    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high,
+                      weight_high);
+    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order,
+                     limit_weight);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
@@ -516,8 +624,8 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
       if (arg_one->high()->terminal() && arg_two->high()->terminal())
         return kBase_;
     }
-    high = Prune(arg_one->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two, limit_order);
+    high = Prune(arg_one->high(), limit_high, weight_high);
+    low = Apply<kOr>(arg_one->low(), arg_two, limit_order, limit_weight);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -530,23 +638,24 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
                                  const VertexPtr& arg_two,
-                                 int limit_order)  {
-  if (limit_order < 0)
+                                 int limit_order, int limit_weight)  {
+  if (limit_order < 0 || limit_weight < 0)
     return kEmpty_;
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
       return kBase_;
-    return Prune(arg_two, limit_order);
+    return Prune(arg_two, limit_order, limit_weight);
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
       return kBase_;
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, limit_weight);
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, limit_weight);
 
-  VertexPtr& result = or_table_[GetResultKey(arg_one, arg_two, limit_order)];
+  VertexPtr& result =
+      or_table_[GetResultKey(arg_one, arg_two, limit_order, limit_weight)];
   if (result)
     return result;  // Already computed.
 
@@ -558,19 +667,21 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kOr>(set_one, set_two, limit_order);
+  result = Apply<kOr>(set_one, set_two, limit_order, limit_weight);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
+  assert(result->terminal() ||
+         SetNode::Ref(result).max_set_weight() <= limit_weight);
   return result;
 }
 
 Zbdd::VertexPtr Zbdd::Apply(Connective type, const VertexPtr& arg_one,
-                            const VertexPtr& arg_two,
-                            int limit_order)  {
+                            const VertexPtr& arg_two, int limit_order,
+                            int limit_weight)  {
   if (type == kAnd)
-    return Apply<kAnd>(arg_one, arg_two, limit_order);
+    return Apply<kAnd>(arg_one, arg_two, limit_order, limit_weight);
   assert(type == kOr && "Only normalized operations in BDD.");
-  return Apply<kOr>(arg_one, arg_two, limit_order);
+  return Apply<kOr>(arg_one, arg_two, limit_order, limit_weight);
 }
 
 Zbdd::VertexPtr Zbdd::EliminateComplements(
@@ -597,7 +708,7 @@ Zbdd::VertexPtr Zbdd::EliminateComplement(const SetNodePtr& node,
   assert(low->terminal() ||
          SetNode::Ref(low).max_set_order() <= kSettings_.limit_order());
   if (node->index() < 0 && !(node->module() && !node->coherent()))
-    return Apply<kOr>(high, low, kSettings_.limit_order());
+    return Apply<kOr>(high, low, kSettings_.limit_order(), limit_weight());
   return Minimize(GetReducedVertex(node, high, low));
 }
 
@@ -634,95 +745,171 @@ Zbdd::VertexPtr Zbdd::EliminateConstantModule(const SetNodePtr& node,
     if (module->root_->terminal()) {
       if (!Terminal<SetNode>::Ref(module->root_).value())
         return low;
-      return Apply<kOr>(high, low, kSettings_.limit_order());
+      return Apply<kOr>(high, low, kSettings_.limit_order(), limit_weight());
     }
   }
   return Minimize(GetReducedVertex(node, high, low));
 }
 
 Zbdd::VertexPtr Zbdd::Minimize(const VertexPtr& vertex)  {
-  if (vertex->terminal())
-    return vertex;
-  SetNodePtr node = SetNode::Ptr(vertex);
-  if (node->minimal())
-    return vertex;
-  VertexPtr& result = minimal_results_[vertex->id()];
-  if (result)
-    return result;
-  VertexPtr high = Minimize(node->high());
-  VertexPtr low = Minimize(node->low());
-  high = Subsume(high, low);
-  assert(high->id() != low->id() && "Subsume failed!");
-  if (high->terminal() && !Terminal<SetNode>::Ref(high).value()) {
-    result = low;  // Reduction rule.
-    return result;
+  // The explicit stack of calls keeps long ZBDDs off the thread stack.
+  struct Call {
+    SetNodePtr node;  ///< The node to minimize.
+    int step;  ///< The number of finished steps.
+    VertexPtr high;  ///< The minimized high branch after the first step.
+  };
+  std::vector<Call> calls;
+  VertexPtr result;  // The result of the last finished call.
+  auto call = [this, &calls, &result](const VertexPtr& arg) {
+    if (arg->terminal() || SetNode::Ref(arg).minimal()) {
+      result = arg;
+      return;
+    }
+    if (auto it = minimal_results_.find(arg->id());
+        it != minimal_results_.end()) {
+      result = it->second;
+      return;
+    }
+    calls.push_back({SetNode::Ptr(arg), 0, nullptr});
+  };
+  call(vertex);
+  while (!calls.empty()) {
+    Call& current = calls.back();
+    switch (current.step++) {
+      case 0:
+        call(current.node->high());
+        continue;
+      case 1:
+        current.high = result;
+        call(current.node->low());
+        continue;
+    }
+    VertexPtr low = std::move(result);
+    VertexPtr high = Subsume(current.high, low);
+    assert(high->id() != low->id() && "Subsume failed!");
+    if (high->terminal() && !Terminal<SetNode>::Ref(high).value()) {
+      result = low;  // Reduction rule.
+    } else {
+      result = FindOrAddVertex(current.node, high, low);
+      SetNode::Ref(result).minimal(true);
+    }
+    minimal_results_.emplace(current.node->id(), result);
+    calls.pop_back();
   }
-  result = FindOrAddVertex(node, high, low);
-  SetNode::Ref(result).minimal(true);
   return result;
 }
 
 Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
                               const VertexPtr& low)  {
-  if (low->terminal())
-    return Terminal<SetNode>::Ref(low).value() ? kEmpty_ : high;
-  if (high->terminal())
-    return high;  // No need to reduce terminal sets.
-  VertexPtr& computed = subsume_table_[{high->id(), low->id()}];
-  if (computed)
-    return computed;
-
-  SetNodePtr high_node = SetNode::Ptr(high);
-  SetNodePtr low_node = SetNode::Ptr(low);
-  if (high_node->order() > low_node->order() ||
-      (high_node->order() == low_node->order() &&
-       high_node->index() < low_node->index())) {
-    computed = Subsume(high, low_node->low());
-    return computed;
-  }
-  VertexPtr subhigh;
-  VertexPtr sublow;
-  if (high_node->order() == low_node->order() &&
-      high_node->index() == low_node->index()) {
-    assert(high_node->index() == low_node->index());
-    subhigh = Subsume(high_node->high(), low_node->high());
-    subhigh = Subsume(subhigh, low_node->low());
-    sublow = Subsume(high_node->low(), low_node->low());
-  } else {
-    assert(high_node->order() < low_node->order() ||
-           (high_node->order() == low_node->order() &&
-            high_node->index() > low_node->index()));
-    subhigh = Subsume(high_node->high(), low);
-    sublow = Subsume(high_node->low(), low);
-  }
-  if (subhigh->terminal() && !Terminal<SetNode>::Ref(subhigh).value()) {
-    computed = sublow;
-    return computed;
+  // The explicit stack of calls keeps long ZBDDs off the thread stack.
+  // The steps of a call:
+  //   0: Subsumes the high branch of high or skips the top of low.
+  //   1: Subsumes the high branch of high with the low branch of low.
+  //   2: Subsumes the low branch of high.
+  //   3: Joins the branches.
+  //   4: Returns the result of the skip.
+  struct Call {
+    SetNodePtr high;  ///< The set to remove the subsumed paths from.
+    SetNodePtr low;  ///< The set of paths to remove.
+    int step;  ///< The next step.
+    bool same_top;  ///< The sets have the same top variable.
+    VertexPtr subhigh;  ///< The subsumed high branch after step 2.
+  };
+  std::vector<Call> calls;
+  VertexPtr result;  // The result of the last finished call.
+  auto call = [this, &calls, &result](const VertexPtr& high,
+                                      const VertexPtr& low) {
+    if (low->terminal()) {
+      result = Terminal<SetNode>::Ref(low).value() ? kEmpty_ : high;
+      return;
+    }
+    if (high->terminal()) {
+      result = high;  // No need to reduce terminal sets.
+      return;
+    }
+    if (auto it = subsume_table_.find({high->id(), low->id()});
+        it != subsume_table_.end()) {
+      result = it->second;
+      return;
+    }
+    calls.push_back({SetNode::Ptr(high), SetNode::Ptr(low), 0, false, nullptr});
+  };
+  call(high, low);
+  while (!calls.empty()) {
+    Call& current = calls.back();
+    const SetNode& high_node = *current.high;
+    const SetNode& low_node = *current.low;
+    switch (current.step) {
+      case 0:
+        if (high_node.order() > low_node.order() ||
+            (high_node.order() == low_node.order() &&
+             high_node.index() < low_node.index())) {
+          current.step = 4;
+          call(current.high, low_node.low());
+          continue;
+        }
+        current.same_top = high_node.order() == low_node.order() &&
+                           high_node.index() == low_node.index();
+        assert(current.same_top || high_node.order() < low_node.order() ||
+               (high_node.order() == low_node.order() &&
+                high_node.index() > low_node.index()));
+        current.step = current.same_top ? 1 : 2;
+        call(high_node.high(), current.same_top ? low_node.high()
+                                                : VertexPtr(current.low));
+        continue;
+      case 1:
+        current.step = 2;
+        call(VertexPtr(result), low_node.low());
+        continue;
+      case 2:
+        current.step = 3;
+        current.subhigh = std::move(result);
+        call(high_node.low(), current.same_top ? low_node.low()
+                                               : VertexPtr(current.low));
+        continue;
+      case 3:
+        if (current.subhigh->terminal() &&
+            !Terminal<SetNode>::Ref(current.subhigh).value())
+          break;  // The result is the subsumed low branch.
+        assert(current.subhigh->id() != result->id());
+        {
+          SetNodePtr new_high =
+              FindOrAddVertex(current.high, current.subhigh, result);
+          new_high->minimal(high_node.minimal());
+          result = new_high;
+        }
+        break;
+      case 4:
+        break;
+    }
+    subsume_table_.emplace(std::make_pair(current.high->id(),
+                                          current.low->id()),
+                           result);
+    calls.pop_back();
   }
-  assert(subhigh->id() != sublow->id());
-  SetNodePtr new_high = FindOrAddVertex(high_node, subhigh, sublow);
-  new_high->minimal(high_node->minimal());
-  computed = new_high;
-  return computed;
+  return result;
 }
 
-Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order)  {
-  if (limit_order < 0)
+Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order,
+                            int limit_weight)  {
+  if (limit_order < 0 || limit_weight < 0)
     return kEmpty_;
   if (vertex->terminal())
     return vertex;
 
   SetNodePtr node = SetNode::Ptr(vertex);
-  if (node->max_set_order() <= limit_order)
+  if (node->max_set_order() <= limit_order &&
+      node->max_set_weight() <= limit_weight)
     return node;
 
-  VertexPtr& result = prune_results_[{node->id(), limit_order}];
+  VertexPtr& result = prune_results_[{node->id(), limit_order, limit_weight}];
   if (result)
     return result;
 
   int limit_high = limit_order - !MayBeUnity(*node);
-  result = GetReducedVertex(node, Prune(node->high(), limit_high),
-                            Prune(node->low(), limit_order));
+  int weight_high = limit_weight - node->weight();
+  result = GetReducedVertex(node, Prune(node->high(), limit_high, weight_high),
+                            Prune(node->low(), limit_order, limit_weight));
   if (!result->terminal())
     SetNode::Ref(result).minimal(node->minimal());
   return result;
@@ -779,6 +966,7 @@ void Zbdd::ApplySubstitutions(
   unique_table_.clear();  // New ordering for nodes.
 
   VertexPtr new_root = kEmpty_;
+  const int kLimitWeight = limit_weight();
   for (const std::vector<int>& product : *this) {
     std::vector<int> to_add;
     std::vector<int> to_remove;
@@ -798,14 +986,15 @@ void Zbdd::ApplySubstitutions(
         continue;
       new_product = Apply<kAnd>(
           new_product, FindOrAddVertex(id, kBase_, kEmpty_, std::abs(id)),
-          kSettings_.limit_order());
+          kSettings_.limit_order(), kLimitWeight);
     }
     for (int id : to_add) {
       new_product = Apply<kAnd>(
           new_product, FindOrAddVertex(id, kBase_, kEmpty_, std::abs(id)),
-          kSettings_.limit_order());
+          kSettings_.limit_order(), kLimitWeight);
     }
-    new_root = Apply<kOr>(new_root, new_product, kSettings_.limit_order());
+    new_root = Apply<kOr>(new_root, new_product, kSettings_.limit_order(),
+                          kLimitWeight);
   }
   root_ = std::move(new_root);
   root_ = Minimize(root_);
@@ -910,6 +1099,397 @@ void Zbdd::TestStructure(const VertexPtr& vertex, bool modules)  {
   TestStructure(node.low(), modules);
 }
 
+double Zbdd::CalculateUpperBound(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const Vertex<SetNode>*, double>* bounds) const {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? 1 : -1;
+  if (auto it = bounds->find(vertex.get()); it != bounds->end())
+    return it->second;
+  const SetNode& node = SetNode::Ref(vertex);
+  double high = CalculateUpperBound(node.high(), p_vars, bounds);
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    double module_bound =
+        module.CalculateUpperBound(module.root_, p_vars, bounds);
+    high = module_bound < 0 ? -1 : high * module_bound;
+  } else {
+    double p = p_vars[std::abs(node.index())];
+    high *= node.index() < 0 ? 1 - p : p;
+  }
+  double bound = std::max(high, CalculateUpperBound(node.low(), p_vars, bounds));
+  bounds->emplace(vertex.get(), bound);
+  return bound;
+}
+
+const std::vector<double>& Zbdd::SumProducts(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const Vertex<SetNode>*, std::vector<double>>* sums)
+    const {
+  static const std::vector<double> kEmpty;
+  static const std::vector<double> kBase = {1};
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? kBase : kEmpty;
+  if (auto it = sums->find(vertex.get()); it != sums->end())
+    return it->second;
+  const SetNode& node = SetNode::Ref(vertex);
+  std::vector<double> sum = SumProducts(node.low(), p_vars, sums);
+  const std::vector<double>& high = SumProducts(node.high(), p_vars, sums);
+  auto add = [this, &sum](int order, double p) {
+    if (order > kSettings_.limit_order())
+      return;
+    if (order >= static_cast<int>(sum.size()))
+      sum.resize(order + 1);
+    sum[order] += p;
+  };
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    const std::vector<double>& module_sum =
+        module.SumProducts(module.root_, p_vars, sums);
+    for (int i = 0; i < static_cast<int>(module_sum.size()); ++i) {
+      for (int j = 0; j < static_cast<int>(high.size()); ++j)
+        add(i + j, module_sum[i] * high[j]);
+    }
+  } else {
+    double p = p_vars[std::abs(node.index())];
+    if (node.index() < 0)
+      p = 1 - p;
+    for (int j = 0; j < static_cast<int>(high.size()); ++j)
+      add(j + 1, p * high[j]);
+  }
+  return sums->emplace(vertex.get(), std::move(sum)).first->second;
+}
+
+double Zbdd::CalculateSumOfProducts(
+    const Pdag::IndexMap<double>& p_vars) const {
+  double sum = 0;
+  if (HasProbabilityContext()) {
+    VisitProducts(
+        [&p_vars](int literal) {
+          return literal < 0 ? 1 - p_vars[-literal] : p_vars[literal];
+        },
+        [&sum](std::span<const int>, double p) { sum += p; });
+    return sum;
+  }
+  std::unordered_map<const Vertex<SetNode>*, std::vector<double>> sums;
+  for (double p : SumProducts(root_, p_vars, &sums))
+    sum += p;
+  return sum;
+}
+
+std::vector<Zbdd::ScoredProduct> Zbdd::TopProducts(
+    int limit, const Pdag::IndexMap<double>& p_vars) const {
+  std::vector<ScoredProduct> products;
+  std::unordered_map<const Vertex<SetNode>*, double> bounds;
+  double root_bound = CalculateUpperBound(root_, p_vars, &bounds);
+  // The cut-off applies as in the iteration over the products.
+  const bool pruning = HasProbabilityContext();
+  const double cut_off = pruning ? kSettings_.cut_off() : 0;
+  const double frequency =
+      pruning ? pdag_->initiating_event_frequency() : 1;
+  auto below_cut_off = [cut_off, frequency](double bound) {
+    return bound * frequency < cut_off;
+  };
+  if (limit <= 0 || root_bound < 0 || below_cut_off(root_bound))
+    return products;
+
+  // The search states share the tails of their lists
+  // of pending sets and partial products.
+  struct Pending {
+    const VertexPtr* vertex;  // The root of the pending set.
+    const Zbdd* zbdd;  // The owner of the vertex and its modules.
+    double bound;  // The upper bound of the product with the rest of sets.
+    int next;  // The rest of pending sets or -1.
+  };
+  struct Literal {
+    int index;
+    int previous;  // The preceding literal or -1.
+  };
+  struct State {
+    double priority;  // The upper bound of the completed products.
+    double probability;  // The probability of the partial product.
+    int product;  // The last literal of the partial product or -1.
+    int order;  // The size of the partial product.
+    int pending;  // The first pending set or -1 for complete products.
+
+    bool operator<(const State& other) const {
+      return priority < other.priority;
+    }
+  };
+  std::vector<Pending> pending_sets;
+  std::vector<Literal> literals;
+  std::priority_queue<State> queue;
+
+  auto get_bound = [&pending_sets](int pending) {
+    return pending < 0 ? 1 : pending_sets[pending].bound;
+  };
+  // The Empty set is never added.
+  auto add_pending = [&](const VertexPtr& vertex, const Zbdd* zbdd,
+                         int next) {
+    if (vertex->terminal())
+      return next;  // The Base set is the identity for products.
+    double bound = bounds.find(vertex.get())->second * get_bound(next);
+    pending_sets.push_back({&vertex, zbdd, bound, next});
+    return static_cast<int>(pending_sets.size()) - 1;
+  };
+
+  queue.push({root_bound, 1, -1, 0, add_pending(root_, this, -1)});
+  while (!queue.empty() && static_cast<int>(products.size()) < limit) {
+    State state = queue.top();
+    queue.pop();
+    // Descends along the most probable branches
+    // while deferring the alternatives into the queue.
+    while (state.pending >= 0) {
+      Pending set = pending_sets[state.pending];
+      const SetNode& node = SetNode::Ref(*set.vertex);
+      std::optional<State> high;
+      if (node.module()) {
+        const Zbdd& module = *set.zbdd->modules_.find(node.index())->second;
+        if (module.CalculateUpperBound(module.root_, p_vars, &bounds) >= 0) {
+          int pending = add_pending(module.root_, &module,
+                                    add_pending(node.high(), set.zbdd, set.next));
+          high = {state.probability * get_bound(pending), state.probability,
+                  state.product, state.order, pending};
+        }
+      } else if (state.order < kSettings_.limit_order()) {
+        double p = p_vars[std::abs(node.index())];
+        double probability = state.probability * (node.index() < 0 ? 1 - p : p);
+        literals.push_back({node.index(), state.product});
+        int pending = add_pending(node.high(), set.zbdd, set.next);
+        high = {probability * get_bound(pending), probability,
+                static_cast<int>(literals.size()) - 1, state.order + 1,
+                pending};
+      }
+      std::optional<State> low;
+      if (!node.low()->terminal() || Terminal<SetNode>::Ref(node.low()).value()) {
+        int pending = add_pending(node.low(), set.zbdd, set.next);
+        low = {state.probability * get_bound(pending), state.probability,
+               state.product, state.order, pending};
+      }
+      // The states below the cut-off can only yield pruned products.
+      if (high && below_cut_off(high->priority))
+        high.reset();
+      if (low && below_cut_off(low->priority))
+        low.reset();
+      if (!high || (low && low->priority > high->priority))
+        std::swap(high, low);
+      if (!high)
+        break;  // Dead end.
+      if (low)
+        queue.push(*low);
+      state = *high;
+    }
+    if (state.pending >= 0)
+      continue;
+    if (!queue.empty() && queue.top().priority > state.priority) {
+      queue.push(state);  // Another branch may yield a more probable product.
+      continue;
+    }
+    std::vector<int> product;
+    for (int i = state.product; i >= 0; i = literals[i].previous)
+      product.push_back(literals[i].index);
+    std::reverse(product.begin(), product.end());
+    products.emplace_back(std::move(product), state.probability);
+  }
+  return products;
+}
+
+ProductCounter::ProductCounter(const Zbdd& zbdd)
+    : zbdd_(zbdd), limit_order_(zbdd.settings().limit_order()) {
+  const Histogram& orders = CountProducts(zbdd.root_, zbdd);
+  size_ = 0;
+  for (const Count& count : orders)
+    size_ += count;
+  // The Base set is reported as a product of order 1.
+  distribution_.assign(orders.begin() + (orders.size() > 1), orders.end());
+  if (orders.size() > 1)
+    distribution_.front() += orders.front();
+  while (!distribution_.empty() && distribution_.back() == 0)
+    distribution_.pop_back();
+}
+
+const ProductCounter::Histogram& ProductCounter::CountProducts(
+    const Zbdd::VertexPtr& vertex, const Zbdd& zbdd) {
+  static const Histogram kEmpty;
+  static const Histogram kBase = {1};
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? kBase : kEmpty;
+  if (auto it = histograms_.find(vertex.get()); it != histograms_.end())
+    return it->second;
+  const SetNode& node = SetNode::Ref(vertex);
+  Histogram orders;
+  if (node.module()) {
+    const Zbdd& module = *zbdd.modules_.find(node.index())->second;
+    orders = Convolve(CountProducts(module.root_, module),
+                      CountProducts(node.high(), zbdd));
+  } else {
+    orders = Convolve({0, 1}, CountProducts(node.high(), zbdd));
+  }
+  const Histogram& low = CountProducts(node.low(), zbdd);
+  if (orders.size() < low.size())
+    orders.resize(low.size());
+  for (std::size_t i = 0; i < low.size(); ++i)
+    orders[i] += low[i];
+  return histograms_.emplace(vertex.get(), std::move(orders)).first->second;
+}
+
+const ProductCounter::Histogram& ProductCounter::histogram(
+    const Zbdd::VertexPtr& vertex) const {
+  static const Histogram kEmpty;
+  static const Histogram kBase = {1};
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? kBase : kEmpty;
+  return histograms_.find(vertex.get())->second;
+}
+
+ProductCounter::Histogram ProductCounter::Convolve(const Histogram& lhs,
+                                                   const Histogram& rhs) const {
+  if (lhs.empty() || rhs.empty())
+    return {};
+  Histogram result(
+      std::min<int>(lhs.size() + rhs.size() - 1, limit_order_ + 1));
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i] == 0)
+      continue;
+    for (std::size_t j = 0; j < rhs.size() && i + j < result.size(); ++j)
+      result[i + j] += lhs[i] * rhs[j];
+  }
+  while (!result.empty() && result.back() == 0)
+    result.pop_back();
+  return result;
+}
+
+std::vector<int> ProductCounter::product(Count rank) const {
+  assert(rank < size_ && "The rank is out of range.");
+  // The sets pending for the product
+  // with the histograms of their products with the rest of the sets.
+  struct Pending {
+    const Zbdd::VertexPtr* vertex;
+    const Zbdd* zbdd;
+    Histogram orders;
+  };
+  std::vector<Pending> pending_sets = {
+      {&zbdd_.root_, &zbdd_, histogram(zbdd_.root_)}};
+  auto count = [](const Histogram& orders, int budget) {
+    Count total = 0;
+    for (int i = 0; i < static_cast<int>(orders.size()) && i <= budget; ++i)
+      total += orders[i];
+    return total;
+  };
+  std::vector<int> result;
+  int budget = limit_order_;  // The number of literals left for the product.
+  while (!pending_sets.empty()) {
+    Pending set = std::move(pending_sets.back());
+    pending_sets.pop_back();
+    if ((*set.vertex)->terminal())
+      continue;  // The Base set.
+    const Histogram& rest = pending_sets.empty()
+                                ? histogram(set.zbdd->kBase_)
+                                : pending_sets.back().orders;
+    const SetNode& node = SetNode::Ref(*set.vertex);
+    // The high branch comes first in the iteration order.
+    Histogram high = Convolve(histogram(node.high()), rest);
+    if (node.module()) {
+      const Zbdd& module = *set.zbdd->modules_.find(node.index())->second;
+      Histogram orders = Convolve(histogram(module.root_), high);
+      if (Count high_count = count(orders, budget); rank < high_count) {
+        pending_sets.push_back({&node.high(), set.zbdd, std::move(high)});
+        pending_sets.push_back({&module.root_, &module, std::move(orders)});
+        continue;
+      } else {
+        rank -= high_count;
+      }
+    } else if (Count high_count = budget ? count(high, budget - 1) : 0;
+               rank < high_count) {
+      result.push_back(node.index());
+      --budget;
+      pending_sets.push_back({&node.high(), set.zbdd, std::move(high)});
+      continue;
+    } else {
+      rank -= high_count;
+    }
+    assert(!histogram(node.low()).empty() && "Ranking beyond the products.");
+    pending_sets.push_back(
+        {&node.low(), set.zbdd, Convolve(histogram(node.low()), rest)});
+  }
+  return result;
+}
+
+std::vector<int> ProductCounter::GatherEvents() const {
+  std::vector<bool> events;
+  if (size_ > 0)
+    GatherEvents(zbdd_, 0, &events);
+  std::vector<int> indices;
+  for (int i = 0; i < static_cast<int>(events.size()); ++i) {
+    if (events[i])
+      indices.push_back(i);
+  }
+  return indices;
+}
+
+void ProductCounter::GatherEvents(const Zbdd& zbdd, int context,
+                                  std::vector<bool>* events) const {
+  // The minimum size of products in a set within the limit order.
+  auto min_order = [this](const Zbdd::VertexPtr& vertex) {
+    const Histogram& orders = histogram(vertex);
+    auto it = boost::find_if(orders, [](const Count& count) { return count > 0; });
+    return it == orders.end() ? limit_order_ + 1
+                              : static_cast<int>(it - orders.begin());
+  };
+  // Vertices in topological order with the minimum number of literals
+  // in the products besides the ones of the vertex set.
+  std::vector<const SetNode*> vertices;
+  std::unordered_map<const SetNode*, int> contexts;
+  auto visit = [&](auto& self, const Zbdd::VertexPtr& vertex) -> void {
+    if (vertex->terminal())
+      return;
+    const SetNode* node = &SetNode::Ref(vertex);
+    if (!contexts.emplace(node, limit_order_ + 1).second)
+      return;
+    self(self, node->high());
+    self(self, node->low());
+    vertices.push_back(node);
+  };
+  visit(visit, zbdd.root_);
+  if (zbdd.root_->terminal())
+    return;
+  contexts[&SetNode::Ref(zbdd.root_)] = context;
+  auto update = [&contexts](const Zbdd::VertexPtr& vertex, int value) {
+    if (vertex->terminal())
+      return;
+    int& current = contexts.find(&SetNode::Ref(vertex))->second;
+    current = std::min(current, value);
+  };
+  std::map<int, int> module_contexts;
+  for (auto it = vertices.rbegin(); it != vertices.rend(); ++it) {
+    const SetNode& node = **it;
+    int node_context = contexts.find(&node)->second;
+    int high_order = min_order(node.high());
+    if (node.module()) {
+      const Zbdd& module = *zbdd.modules_.find(node.index())->second;
+      int module_order = min_order(module.root_);
+      if (node_context + module_order + high_order <= limit_order_) {
+        auto [entry, inserted] = module_contexts.emplace(
+            node.index(), node_context + high_order);
+        if (!inserted)
+          entry->second = std::min(entry->second, node_context + high_order);
+      }
+      update(node.high(), node_context + module_order);
+    } else {
+      if (node_context + 1 + high_order <= limit_order_) {
+        int index = std::abs(node.index());
+        if (static_cast<int>(events->size()) <= index)
+          events->resize(index + 1);
+        (*events)[index] = true;
+      }
+      update(node.high(), node_context + 1);
+    }
+    update(node.low(), node_context);
+  }
+  for (const auto& [index, module_context] : module_contexts)
+    GatherEvents(*zbdd.modules_.find(index)->second, module_context, events);
+}
+
 namespace zbdd {
 
 CutSetContainer::CutSetContainer(const Settings& settings, int module_index,
@@ -936,7 +1516,8 @@ Zbdd::VertexPtr CutSetContainer::ConvertGate(const Gate& gate)  {
   auto it = args.cbegin();
   VertexPtr result = *it;
   for (++it; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, settings().limit_order());
+    result = Apply(gate.type(), result, *it, settings().limit_order(),
+                   limit_weight());
   }
   ClearTables();
   return result;
@@ -960,13 +1541,14 @@ Zbdd::VertexPtr CutSetContainer::ExpandGate(
          SetNode::Ref(gate_zbdd).max_set_order() <= settings().limit_order());
   assert(cut_sets->terminal() ||
          SetNode::Ref(cut_sets).max_set_order() <= settings().limit_order());
-  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order());
+  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order(),
+                     limit_weight());
 }
 
 void CutSetContainer::Merge(const VertexPtr& vertex)  {
   assert(vertex->terminal() ||
          SetNode::Ref(vertex).max_set_order() <= settings().limit_order());
-  root(Apply<kOr>(root(), vertex, settings().limit_order()));
+  root(Apply<kOr>(root(), vertex, settings().limit_order(), limit_weight()));
   ClearTables();
 }
 
@@ -24,14 +24,18 @@
 #include <cstdint>
 
 #include <array>
+#include <limits>
 #include <map>
 #include <memory>
+#include <random>
+#include <span>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <boost/functional/hash.hpp>
 #include <boost/iterator/iterator_facade.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
 #include <boost/noncopyable.hpp>
 
 #include "bdd.h"
@@ -63,6 +67,24 @@ class SetNode : public NonTerminal<SetNode> {
   /// @param[in] order  The order/size of the largest set.
   void max_set_order(int order) { max_set_order_ = order; }
 
+  /// @returns The probability weight of the literal of this node.
+  int weight() const { return weight_; }
+
+  /// Registers the probability weight of the node literal.
+  ///
+  /// @param[in] value  The non-negative weight of the literal.
+  void weight(int value) { weight_ = value; }
+
+  /// @returns The registered weight of the heaviest set in the ZBDD,
+  ///          i.e., the least probable set.
+  int max_set_weight() const { return max_set_weight_; }
+
+  /// Registers the weight of the heaviest set in the ZBDD
+  /// represented by this vertex.
+  ///
+  /// @param[in] value  The weight of the heaviest set.
+  void max_set_weight(int value) { max_set_weight_ = value; }
+
   /// @returns Whatever count is stored in this node.
   std::int64_t count() const { return count_; }
 
@@ -84,6 +106,8 @@ class SetNode : public NonTerminal<SetNode> {
  private:
   bool minimal_ = false;  ///< A flag for minimized collection of sets.
   int max_set_order_ = 0;  ///< The order of the largest set in the ZBDD.
+  int weight_ = 0;  ///< The probability weight of the node literal.
+  int max_set_weight_ = 0;  ///< The weight of the heaviest set in the ZBDD.
   std::int64_t count_ = 0;  ///< The number of products, nodes, or anything.
 };
 
@@ -127,10 +151,31 @@ struct TripletHash {
 template <typename Value>
 using TripletTable = std::unordered_map<Triplet, Value, TripletHash>;
 
+using Quadruplet = std::array<int, 4>;  ///< Quadruplet of numbers.
+
+/// Functor for hashing quadruplets of ordered numbers.
+struct QuadrupletHash {
+  /// Operator overload for hashing four ordered numbers.
+  ///
+  /// @param[in] quadruplet  Four numbers.
+  ///
+  /// @returns Hash value of the quadruplet.
+  std::size_t operator()(const Quadruplet& quadruplet) const  {
+    return boost::hash_range(quadruplet.begin(), quadruplet.end());
+  }
+};
+
+/// Hash table with quadruplets of numbers as keys.
+///
+/// @tparam Value  Type of values to be stored in the table.
+template <typename Value>
+using QuadrupletTable = std::unordered_map<Quadruplet, Value, QuadrupletHash>;
+
 /// Zero-Suppressed Binary Decision Diagrams for set manipulations.
 class Zbdd : private boost::noncopyable {
  public:
   friend class const_iterator;
+  friend class ProductCounter;
   using VertexPtr = IntrusivePtr<Vertex<SetNode>>;  ///< ZBDD vertex base.
   using TerminalPtr = IntrusivePtr<Terminal<SetNode>>;  ///< Terminal vertex.
 
@@ -373,8 +418,19 @@ class Zbdd : private boost::noncopyable {
   ///       However, ZBDD guarantees to preserve the original BDD structure.
   Zbdd(Bdd* bdd, const Settings& settings) ;
 
+  /// Converts one root of a multi-root ROBDD into ZBDD.
+  ///
+  /// @param[in] bdd  ROBDD with the ITE vertices.
+  /// @param[in] root  The index of the root in the order of the BDD roots.
+  /// @param[in] settings  Settings for analysis.
+  ///
+  /// @copydetails Zbdd(Bdd*, const Settings&)
+  Zbdd(Bdd* bdd, int root, const Settings& settings) ;
+
   /// Constructor with the analysis target.
   /// ZBDD is directly produced from a PDAG.
+  /// A multi-root PDAG is converted into a ZBDD per root,
+  /// which are accessed with products(int).
   ///
   /// @param[in] graph  Preprocessed and fully normalized PDAG.
   /// @param[in] settings  The analysis settings.
@@ -383,6 +439,15 @@ class Zbdd : private boost::noncopyable {
   /// @note The construction may take considerable time.
   Zbdd(const Pdag* graph, const Settings& settings) ;
 
+  /// Constructs ZBDD of one root of a multi-root PDAG.
+  ///
+  /// @param[in] graph  Preprocessed and fully normalized multi-root PDAG.
+  /// @param[in] root  The index of the root in the order of the PDAG roots.
+  /// @param[in] settings  The analysis settings.
+  ///
+  /// @pre The passed PDAG already has variable ordering.
+  Zbdd(const Pdag* graph, int root, const Settings& settings) ;
+
   virtual ~Zbdd()  = default;
 
   /// Runs the analysis
@@ -399,6 +464,15 @@ class Zbdd : private boost::noncopyable {
   /// @returns Products generated by the analysis.
   const Zbdd& products() const { return *this; }
 
+  /// @param[in] root  The index of the root in the order of the PDAG roots.
+  ///
+  /// @returns Products of the root of a multi-root PDAG
+  ///          or of the only root.
+  const Zbdd& products(int root) const {
+    assert((root_graphs_.empty() ? root == 0 : root < root_graphs_.size()));
+    return root_graphs_.empty() ? *this : *root_graphs_[root];
+  }
+
   /// @returns Iterators over sets in the ZBDD.
   /// @{
   auto begin() const { return const_iterator(*this); }
@@ -409,6 +483,7 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @note This is not cheap.
   ///       The complexity is O(N) on the number of *sets* in ZBDD.
+  ///       ProductCounter counts the products without the enumeration.
   std::size_t size() const { return std::distance(begin(), end()); }
 
   /// @returns true for ZBDD with no products.
@@ -417,6 +492,78 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// A product with its probability.
+  using ScoredProduct = std::pair<std::vector<int>, double>;
+
+  /// Extracts the most probable products best-first
+  /// without enumerating the whole set.
+  /// The search is guided by the upper bound probability of every vertex,
+  /// i.e., the probability of the most probable product below the vertex,
+  /// so the work is proportional to the number of requested products
+  /// rather than to the number of products in the ZBDD.
+  ///
+  /// @param[in] limit  The maximum number of products to extract.
+  /// @param[in] p_vars  Probabilities of the variables.
+  ///
+  /// @returns Up to the limit of products
+  ///          in non-increasing order of their probabilities.
+  ///
+  /// @pre The probabilities are in the [0, 1] range.
+  ///
+  /// @note The limit on the product order and the cut-off are respected
+  ///       as in the iteration over the products.
+  ///       The search stops once the upper bound falls below the cut-off.
+  std::vector<ScoredProduct> TopProducts(
+      int limit, const Pdag::IndexMap<double>& p_vars) const;
+
+  /// Calculates the sum of the probabilities of all the products
+  /// with one bottom-up pass over the ZBDD and its modules
+  /// instead of the enumeration of the products.
+  ///
+  /// @param[in] p_vars  Probabilities of the variables.
+  ///
+  /// @returns The sum of the product probabilities
+  ///          with the limit on the product order and the cut-off
+  ///          as in the iteration over the products.
+  ///
+  /// @pre The ZBDD is minimal,
+  ///      so no product ends before the limit on the order cuts its vertex.
+  ///
+  /// @note With the cut-off, the sum is over the visited products
+  ///       since the pruning depends on the whole product.
+  double CalculateSumOfProducts(const Pdag::IndexMap<double>& p_vars) const;
+
+  /// Visits products depth-first
+  /// without the iterator state or copies of the products.
+  /// The products are visited in the iteration order
+  /// with the same limit on the order and the same cut-off.
+  ///
+  /// @tparam Probability  Callable as double(int literal).
+  /// @tparam Visitor  Callable as void(std::span<const int>, double).
+  ///
+  /// @param[in] probability  The probabilities of literals.
+  /// @param[in] visitor  The consumer of products
+  ///                     and their probabilities,
+  ///                     i.e., the products of literal probabilities
+  ///                     multiplied in the order of the literals.
+  ///
+  /// @note The product span is valid only within the visitor call.
+  template <class Probability, class Visitor>
+  void VisitProducts(Probability&& probability, Visitor&& visitor) const {
+    ProductWalker<Probability, Visitor> walker(*this, probability, visitor);
+    walker.Walk(root_, *this, 1, 1);
+  }
+
+  /// Visits products without their probabilities.
+  ///
+  /// @tparam Visitor  Callable as void(std::span<const int>, double).
+  ///
+  /// @param[in] visitor  The consumer of products with the probability 1.
+  template <class Visitor>
+  void VisitProducts(Visitor&& visitor) const {
+    VisitProducts([](int) { return 1.0; }, std::forward<Visitor>(visitor));
+  }
+
  protected:
   /// The common constructor to initialize member variables.
   ///
@@ -443,6 +590,23 @@ class Zbdd : private boost::noncopyable {
   /// Computes literal probability for the current PDAG context.
   double LiteralProbability(int literal) const;
 
+  /// The probability cut-off enters the ZBDD computations
+  /// in the same way as the limit on the product order.
+  /// Every literal gets an integer weight,
+  /// i.e., the negative binary logarithm of its probability
+  /// scaled by kWeightScale and rounded down,
+  /// and sets with the sum of weights above the limit are pruned.
+  /// Rounding down keeps the pruning conservative:
+  /// no set with the probability at or above the cut-off is lost.
+  /// @{
+  static constexpr int kWeightScale = 8;  ///< Weight units per probability halving.
+  static constexpr int kMaxWeight = 1 << 20;  ///< Saturation for impossible sets.
+  /// @}
+
+  /// @returns The limit on the set weight for the cut-off of the analysis.
+  /// @returns kMaxWeight if probability-aware pruning is not applicable.
+  int limit_weight() const;
+
   /// @returns A set of registered and fully processed modules;
   const std::map<int, std::unique_ptr<Zbdd>>& modules() const {
     return modules_;
@@ -491,13 +655,14 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
-  /// @post The limit on the set order is guaranteed.
+  /// @post The limits on the set order and weight are guaranteed.
   template <Connective Type>
   VertexPtr Apply(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                  int limit_order) ;
+                  int limit_order, int limit_weight) ;
 
   /// Applies Boolean operation to two vertices representing sets.
   /// This is a convenience function
@@ -507,14 +672,16 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre The connective is either AND or OR.
   ///
-  /// @post The limit on the set order is guaranteed.
+  /// @post The limits on the set order and weight are guaranteed.
   VertexPtr Apply(Connective type, const VertexPtr& arg_one,
-                  const VertexPtr& arg_two, int limit_order) ;
+                  const VertexPtr& arg_two, int limit_order,
+                  int limit_weight) ;
 
   /// Applies Boolean operation to ZBDD graph non-terminal vertices.
   ///
@@ -523,13 +690,14 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument set vertex.
   /// @param[in] arg_two  Second argument set vertex.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre Argument vertices are ordered.
   template <Connective Type>
   VertexPtr Apply(const SetNodePtr& arg_one, const SetNodePtr& arg_two,
-                  int limit_order) ;
+                  int limit_order, int limit_weight) ;
 
   /// Removes complements of variables from products.
   /// This procedure only needs to be performed for non-coherent graphs
@@ -555,6 +723,18 @@ class Zbdd : private boost::noncopyable {
   /// @pre All modules have been processed.
   void EliminateConstantModules() ;
 
+  /// Minimizes and prunes the products of this ZBDD
+  /// without processing its modules.
+  void Reduce() ;
+
+  /// Reduces and freezes modules.
+  /// The modules are processed concurrently
+  /// if more than one thread is available to the calling thread.
+  ///
+  /// @param[in] modules  All nested modules
+  ///                     to be processed without their submodules.
+  void AnalyzeModules(const std::vector<Zbdd*>& modules) ;
+
   /// Removes subsets in ZBDD.
   ///
   /// @param[in] vertex  The variable node in the set.
@@ -626,7 +806,7 @@ class Zbdd : private boost::noncopyable {
 
  private:
   using SetNodeWeakPtr = WeakIntrusivePtr<SetNode>;  ///< Pointer for tables.
-  using ComputeTable = TripletTable<VertexPtr>;  ///< General computation table.
+  using ComputeTable = QuadrupletTable<VertexPtr>;  ///< General computation table.
   /// Module entry in the tables with its original gate index.
   using ModuleEntry = std::pair<const int, std::unique_ptr<Zbdd>>;
 
@@ -662,8 +842,18 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @post The root vertex pointer is uninitialized
   ///       if the PDAG is constant or single variable.
+  ///
+  /// @note The root gates of a multi-root PDAG are converted
+  ///       the same way as modules.
   Zbdd(const Gate& gate, const Settings& settings) ;
 
+  /// Converts the pass-through gate of a constant or single variable.
+  ///
+  /// @param[in] gate  The root gate or pin with a non-gate argument.
+  ///
+  /// @returns The root vertex for the argument of the gate.
+  VertexPtr ConvertPassThrough(const Gate& gate) ;
+
   /// Finds a replacement for an existing node
   /// or adds a new node based on an existing node.
   ///
@@ -707,15 +897,16 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument.
   /// @param[in] arg_two  Second argument.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight for the computations.
   ///
-  /// @returns A triplet of integers for the computation key.
+  /// @returns A quadruplet of integers for the computation key.
   ///
   /// @pre The arguments are not the same functions.
   ///      Equal ID functions are handled by the reduction.
   /// @pre Even though the arguments are not SetNodePtr type,
   ///      they are ZBDD SetNode vertices.
-  Triplet GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                       int limit_order) ;
+  Quadruplet GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
+                          int limit_order, int limit_weight) ;
 
   /// Converts BDD graph into ZBDD graph.
   ///
@@ -831,12 +1022,25 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @param[in] vertex  The root vertex of the ZBDD.
   /// @param[in] limit_order  The cut-off order for the sets.
+  /// @param[in] limit_weight  The cut-off weight for the sets.
   ///
   /// @returns The root vertex of the pruned ZBDD.
   ///
   /// @post If the ZBDD is minimal,
   ///       the resultant pruned ZBDD is minimal.
-  VertexPtr Prune(const VertexPtr& vertex, int limit_order) ;
+  VertexPtr Prune(const VertexPtr& vertex, int limit_order,
+                  int limit_weight) ;
+
+  /// Computes the probability weight of a node literal.
+  ///
+  /// @param[in] node  The node with the literal.
+  ///
+  /// @returns 0 for gates, Unity candidates,
+  ///          or without probability-aware pruning.
+  ///
+  /// @note Complements are Unity candidates without prime implicants,
+  ///       so only the reported literals weigh against the cut-off.
+  int LiteralWeight(const SetNode& node) ;
 
   /// Checks if a set node represents a gate.
   /// Apply operations and truncation operations
@@ -905,6 +1109,117 @@ class Zbdd : private boost::noncopyable {
   /// @pre SetNode marks are clear (false).
   void TestStructure(const VertexPtr& vertex, bool modules) ;
 
+  /// Depth-first traversal of products for visitors.
+  /// A single buffer holds the current product,
+  /// and the branches to continue after module products
+  /// are kept on a stack.
+  ///
+  /// @tparam Probability  Callable as double(int literal).
+  /// @tparam Visitor  Callable as void(std::span<const int>, double).
+  template <class Probability, class Visitor>
+  class ProductWalker {
+   public:
+    /// @param[in] zbdd  The root ZBDD with the analysis settings.
+    /// @param[in] probability  The probabilities of literals.
+    /// @param[in] visitor  The consumer of products.
+    ProductWalker(const Zbdd& zbdd, Probability& probability, Visitor& visitor)
+        : zbdd_(zbdd),
+          probability_(probability),
+          visitor_(visitor),
+          limit_order_(zbdd.settings().limit_order()),
+          pruning_(zbdd.HasProbabilityContext()),
+          cut_off_(pruning_ ? zbdd.settings().cut_off() : 0),
+          frequency_(pruning_ ? zbdd.pdag_->initiating_event_frequency() : 1) {
+      product_.reserve(std::max(limit_order_, 0));
+    }
+
+    /// Visits the products of a vertex
+    /// continued with the pending branches.
+    ///
+    /// @param[in] vertex  The vertex in a ZBDD or its module.
+    /// @param[in] zbdd  The owner of the vertex.
+    /// @param[in] p_cut  The product probability for the cut-off.
+    /// @param[in] p  The product probability for the visitor.
+    void Walk(const VertexPtr& vertex, const Zbdd& zbdd, double p_cut,
+              double p) {
+      const VertexPtr* it = &vertex;
+      for (;; it = &SetNode::Ref(*it).low()) {
+        if ((*it)->terminal()) {
+          if (!Terminal<SetNode>::Ref(*it).value() || Prune(p_cut))
+            return;
+          if (pending_.empty()) {
+            visitor_(std::span<const int>(product_), p);
+            return;
+          }
+          std::pair<const VertexPtr*, const Zbdd*> next = pending_.back();
+          pending_.pop_back();
+          Walk(*next.first, *next.second, p_cut, p);
+          pending_.push_back(next);
+          return;
+        }
+        if (static_cast<int>(product_.size()) >= limit_order_)
+          return;
+        const SetNode& node = SetNode::Ref(*it);
+        if (node.module()) {
+          const Zbdd& module = *zbdd.modules_.find(node.index())->second;
+          pending_.emplace_back(&node.high(), &zbdd);
+          Walk(module.root_, module, p_cut, p);
+          pending_.pop_back();
+        } else {
+          double p_high_cut = p_cut;
+          if (pruning_)
+            p_high_cut *= zbdd_.LiteralProbability(node.index());
+          product_.push_back(node.index());
+          if (!Prune(p_high_cut))
+            Walk(node.high(), zbdd, p_high_cut, p * probability_(node.index()));
+          product_.pop_back();
+        }
+      }
+    }
+
+   private:
+    /// @returns true if the product probability is below the cut-off.
+    bool Prune(double p_cut) const { return p_cut * frequency_ < cut_off_; }
+
+    const Zbdd& zbdd_;  ///< The root ZBDD.
+    Probability& probability_;  ///< The probabilities of literals.
+    Visitor& visitor_;  ///< The consumer of products.
+    const int limit_order_;  ///< The limit on the product order.
+    const bool pruning_;  ///< The indication of the probability cut-off.
+    const double cut_off_;  ///< The cut-off for product probabilities.
+    const double frequency_;  ///< The initiating event frequency.
+    std::vector<int> product_;  ///< The current product.
+    /// The high branches of module proxies with their owners.
+    std::vector<std::pair<const VertexPtr*, const Zbdd*>> pending_;
+  };
+
+  /// Calculates the probability of the most probable product in a set.
+  ///
+  /// @param[in] vertex  The root vertex of the set.
+  /// @param[in] p_vars  Probabilities of the variables.
+  /// @param[in,out] bounds  Memoization of the upper bounds
+  ///                        of vertices in this ZBDD and its modules.
+  ///
+  /// @returns The upper bound probability of products in the set.
+  /// @returns -1 for the Empty set.
+  double CalculateUpperBound(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const Vertex<SetNode>*, double>* bounds) const;
+
+  /// Calculates the sums of the product probabilities by product order.
+  ///
+  /// @param[in] vertex  The root vertex of the set.
+  /// @param[in] p_vars  Probabilities of the variables.
+  /// @param[in,out] sums  Memoization of the sums
+  ///                      of vertices in this ZBDD and its modules.
+  ///
+  /// @returns The sums of the products indexed by their order
+  ///          up to the limit on the product order.
+  const std::vector<double>& SumProducts(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const Vertex<SetNode>*, std::vector<double>>* sums)
+      const;
+
   const Settings kSettings_;  ///< Analysis settings.
   const Pdag* pdag_;  ///< Optional PDAG context for probability lookups.
   VertexPtr root_;  ///< The root vertex of ZBDD.
@@ -914,12 +1229,13 @@ class Zbdd : private boost::noncopyable {
   /// Table of unique SetNodes denoting sets.
   /// The key consists of (index, id_high, id_low) triplet.
   UniqueTable<SetNode> unique_table_;
+  VertexPoolPtr<SetNode> pool_;  ///< The memory of set nodes.
 
   /// Table of processed computations over sets.
   /// The argument sets are recorded with their IDs (not vertex indices).
   /// In order to keep only unique computations,
   /// the argument IDs must be ordered.
-  /// The key is {min_id, max_id, max_order}.
+  /// The key is {min_id, max_id, max_order, max_weight}.
   /// @{
   ComputeTable and_table_;
   ComputeTable or_table_;
@@ -929,13 +1245,127 @@ class Zbdd : private boost::noncopyable {
   std::unordered_map<int, VertexPtr> minimal_results_;
   /// The results of subsume operations over sets.
   PairTable<VertexPtr> subsume_table_;
-  /// The results of pruning operations.
-  PairTable<VertexPtr> prune_results_;
+  /// The results of pruning operations
+  /// with {id, max_order, max_weight} keys.
+  TripletTable<VertexPtr> prune_results_;
 
   std::map<int, std::unique_ptr<Zbdd>> modules_;  ///< Module graphs.
+  /// The graphs of the roots of a multi-root PDAG.
+  std::vector<std::unique_ptr<Zbdd>> root_graphs_;
   int set_id_;  ///< Identification assignment for new set graphs.
 };
 
+/// Counter of products in a ZBDD.
+/// The number of products of each order is computed for every vertex
+/// with dynamic programming over the graph and modules,
+/// so the statistics, ranked access, and sampling of products
+/// need no enumeration of the products.
+///
+/// The products are counted as in the iteration over the ZBDD
+/// with the limit on the product order
+/// but without the probability cut-off.
+/// Products below the cut-off may still be missing
+/// if they have been pruned during the ZBDD construction.
+class ProductCounter {
+ public:
+  /// The number of products with overflow checks.
+  using Count = boost::multiprecision::checked_uint128_t;
+
+  /// Counts the products of the ZBDD.
+  ///
+  /// @param[in] zbdd  The ZBDD with final products.
+  ///
+  /// @throws std::overflow_error  The number of products is out of range.
+  ///
+  /// @pre The ZBDD is not modified during the lifetime of the counter.
+  explicit ProductCounter(const Zbdd& zbdd);
+
+  /// @returns The number of products.
+  const Count& size() const { return size_; }
+
+  /// @returns The number of products by order
+  ///          starting from order 1 (with the Base set included).
+  const std::vector<Count>& distribution() const { return distribution_; }
+
+  /// @returns Sorted indices of basic events in the products.
+  std::vector<int> GatherEvents() const;
+
+  /// Unranks a product.
+  ///
+  /// @param[in] rank  The position of the product in the iteration order.
+  ///
+  /// @returns The product with the given rank.
+  ///
+  /// @pre The rank is less than the number of products.
+  std::vector<int> product(Count rank) const;
+
+  /// Samples a product uniformly.
+  ///
+  /// @tparam URBG  Uniform random bit generator type.
+  ///
+  /// @param[in,out] rng  The source of randomness.
+  ///
+  /// @returns A random product.
+  ///
+  /// @pre The ZBDD has products.
+  template <class URBG>
+  std::vector<int> Sample(URBG& rng) const {
+    assert(size_ > 0 && "No products to sample.");
+    constexpr auto kMax64 = std::numeric_limits<std::uint64_t>::max();
+    Count max_rank = size_ - 1;
+    if (max_rank <= kMax64) {
+      return product(std::uniform_int_distribution<std::uint64_t>(
+          0, static_cast<std::uint64_t>(max_rank))(rng));
+    }
+    std::uniform_int_distribution<std::uint64_t> high_half(
+        0, static_cast<std::uint64_t>(max_rank >> 64));
+    std::uniform_int_distribution<std::uint64_t> low_half;
+    for (;;) {  // Rejection of ranks out of range.
+      Count rank = (Count(high_half(rng)) << 64) | low_half(rng);
+      if (rank <= max_rank)
+        return product(std::move(rank));
+    }
+  }
+
+ private:
+  /// The number of products by the product size (the number of literals).
+  using Histogram = std::vector<Count>;
+
+  /// Counts the products of a set by size up to the limit order.
+  ///
+  /// @param[in] vertex  The root vertex of the set.
+  /// @param[in] zbdd  The owner of the vertex and its modules.
+  ///
+  /// @returns The memoized histogram of the set.
+  const Histogram& CountProducts(const Zbdd::VertexPtr& vertex,
+                                 const Zbdd& zbdd);
+
+  /// @returns The histogram of a vertex.
+  ///
+  /// @param[in] vertex  A vertex counted upon construction.
+  const Histogram& histogram(const Zbdd::VertexPtr& vertex) const;
+
+  /// @returns The histogram of the products of two sets
+  ///          truncated at the limit order.
+  Histogram Convolve(const Histogram& lhs, const Histogram& rhs) const;
+
+  /// Collects events of products in a ZBDD
+  /// reached with at least the given number of literals in the product.
+  ///
+  /// @param[in] zbdd  The ZBDD or its module.
+  /// @param[in] context  The minimum number of other literals in products.
+  /// @param[in,out] events  Flags for event indices in products.
+  void GatherEvents(const Zbdd& zbdd, int context,
+                    std::vector<bool>* events) const;
+
+  const Zbdd& zbdd_;  ///< The counted ZBDD.
+  const int limit_order_;  ///< The limit on the product size.
+  /// The histograms of all vertices in the ZBDD and its modules.
+  std::unordered_map<const Vertex<SetNode>*, Histogram> histograms_;
+  Count size_;  ///< The total number of products.
+  std::vector<Count> distribution_;  ///< The number of products by order.
+};
+
 namespace zbdd {
 
 /// Storage for generated cut sets in MOCUS.
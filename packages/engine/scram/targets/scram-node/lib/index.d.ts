@@ -3,6 +3,7 @@ declare module 'scram-node' {
   import { Model } from '../../../types/model';
   import {
     QuantifyRequest,
+    ScenarioRequest,
     ScramNodeOptions,
   } from '../../../types/quantify-request';
   import { QuantifyModelResult } from '../../../types/quantify-result';
@@ -84,4 +85,20 @@ declare module 'scram-node' {
     options?: ScramNodeOptions,
     model?: Model,
   ): QuantifyModelResult;
+
+  /**
+   * @remarks Quantifies the model once and re-quantifies its top events and sequences
+   * for every what-if scenario without rebuilding the products/BDD.
+   * The results carry `results.scenarios` with the per-scenario
+   * `topEvents` and `sequences` frequencies.
+   *
+   * @param options - The analysis settings (probability analysis is implied).
+   * @param model - The model to quantify.
+   * @param scenarios - The overrides of parameters and basic event probabilities.
+   */
+  export function QuantifyScenarios(
+    options: ScramNodeOptions,
+    model: Model,
+    scenarios: ScenarioRequest[],
+  ): QuantifyModelResult;
 }
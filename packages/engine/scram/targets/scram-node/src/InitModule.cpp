@@ -12,6 +12,7 @@
  */
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("QuantifyModel", Napi::Function::New(env, QuantifyModel));
+    exports.Set("QuantifyScenarios", Napi::Function::New(env, QuantifyScenarios));
     exports.Set("BuildModelOnly", Napi::Function::New(env, BuildModelOnly));
     return exports;
 }
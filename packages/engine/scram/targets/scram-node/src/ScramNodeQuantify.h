@@ -2,3 +2,6 @@
 
 // The main Node Addon function
 Napi::Value QuantifyModel(const Napi::CallbackInfo& info);
+
+// Quantifies what-if scenarios against one analysis of the model
+Napi::Value QuantifyScenarios(const Napi::CallbackInfo& info);
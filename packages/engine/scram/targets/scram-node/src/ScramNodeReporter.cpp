@@ -366,6 +366,23 @@ void WriteProductListJson(JsonWriter &writer,
   writer.EndArray();
 }
 
+void WriteEstimateJson(JsonWriter &writer,
+                       const scram::core::ProbabilityAnalysis &pa) {
+  if (!pa.estimate())
+    return;
+  const scram::core::ProbabilityEstimate &estimate = *pa.estimate();
+  writer.Key("standardError");
+  writer.Number(estimate.std_error);
+  writer.Key("confidence");
+  writer.Number(estimate.confidence);
+  writer.Key("lowerBound");
+  writer.Number(estimate.lower_bound);
+  writer.Key("upperBound");
+  writer.Number(estimate.upper_bound);
+  writer.Key("samples");
+  writer.Number(static_cast<double>(estimate.num_samples));
+}
+
 void WriteSumOfProductsJson(JsonWriter &writer,
               const scram::core::FaultTreeAnalysis &fta,
               const scram::core::ProbabilityAnalysis *pa,
@@ -380,6 +397,7 @@ void WriteSumOfProductsJson(JsonWriter &writer,
     if (pa) {
       writer.Key("probability");
       writer.Number(pa->p_total());
+      WriteEstimateJson(writer, *pa);
     }
     writer.EndObject();
     return;
@@ -393,6 +411,7 @@ void WriteSumOfProductsJson(JsonWriter &writer,
   if (pa) {
     writer.Key("probability");
     writer.Number(pa->p_total());
+    WriteEstimateJson(writer, *pa);
   }
   if (!products.distribution().empty()) {
     writer.Key("distribution");
@@ -997,6 +1016,9 @@ Napi::Object ScramNodeResults(Napi::Env env, const scram::core::RiskAnalysis& an
   if (impIdx   > 0) results.Set("importance",            importanceArr);
   if (sopIdx   > 0) results.Set("sumOfProducts",         sopArr);
 
+  // What-if scenarios
+  if (!analysis.scenarios().empty()) results.Set("scenarios", ScramNodeScenarios(env, analysis));
+
   return results;
 }
 
@@ -1049,6 +1071,40 @@ Napi::Object ScramNodeCurve(Napi::Env env, const scram::core::ProbabilityAnalysi
   return curve;
 }
 
+// What-if Scenarios: top-event and sequence frequencies per scenario
+Napi::Array ScramNodeScenarios(Napi::Env env, const scram::core::RiskAnalysis& analysis) {
+  Napi::Array scenarios = Napi::Array::New(env, analysis.scenarios().size());
+  for (size_t i = 0; i < analysis.scenarios().size(); ++i) {
+    Napi::Object scenario = Napi::Object::New(env);
+    scenario.Set("name", analysis.scenarios()[i].name);
+    Napi::Array topEvents = Napi::Array::New(env);
+    Napi::Array sequences = Napi::Array::New(env);
+    uint32_t topIdx = 0;
+    uint32_t seqIdx = 0;
+    for (const auto& result : analysis.results()) {
+      if (!result.probability_analysis || result.probability_analysis->p_scenarios().empty()) continue;
+      const double value = result.probability_analysis->p_scenarios()[i];
+      Napi::Object entry = Napi::Object::New(env);
+      if (const auto* gate = std::get_if<const scram::mef::Gate*>(&result.id.target)) {
+        entry.Set("name",  (*gate)->name());
+        entry.Set("value", Napi::Number::New(env, value));
+        topEvents.Set(topIdx++, entry);
+      } else {
+        const auto& [initiating_event, sequence] =
+            std::get<std::pair<const scram::mef::InitiatingEvent&, const scram::mef::Sequence&>>(result.id.target);
+        entry.Set("initiatingEvent", initiating_event.name());
+        entry.Set("name",            sequence.name());
+        entry.Set("value",           Napi::Number::New(env, value));
+        sequences.Set(seqIdx++, entry);
+      }
+    }
+    if (topIdx > 0) scenario.Set("topEvents", topEvents);
+    if (seqIdx > 0) scenario.Set("sequences", sequences);
+    scenarios.Set(i, scenario);
+  }
+  return scenarios;
+}
+
 // Statistical Measure (Uncertainty)
 Napi::Object ScramNodeStatisticalMeasure(Napi::Env env, const scram::core::UncertaintyAnalysis& ua) {
   Napi::Object stat = Napi::Object::New(env);
@@ -1123,6 +1179,18 @@ Napi::Object ScramNodeImportance(Napi::Env env, const scram::core::ImportanceAna
   return imp;
 }
 
+// Monte Carlo confidence interval of the total probability, if any
+static void SetEstimate(Napi::Env env, Napi::Object& sop, const scram::core::ProbabilityAnalysis& pa) {
+  if (!pa.estimate())
+    return;
+  const scram::core::ProbabilityEstimate& estimate = *pa.estimate();
+  sop.Set("standardError", Napi::Number::New(env, estimate.std_error));
+  sop.Set("confidence", Napi::Number::New(env, estimate.confidence));
+  sop.Set("lowerBound", Napi::Number::New(env, estimate.lower_bound));
+  sop.Set("upperBound", Napi::Number::New(env, estimate.upper_bound));
+  sop.Set("samples", Napi::Number::New(env, static_cast<double>(estimate.num_samples)));
+}
+
 // Sum of Products (Cut Sets) for fault tree analyses (already computed by RiskAnalysis)
 Napi::Object ScramNodeSumOfProducts(Napi::Env env, const scram::core::FaultTreeAnalysis& fta, const scram::core::ProbabilityAnalysis* pa, const scram::core::RiskAnalysis::Result* result) {
   Napi::Object sop = Napi::Object::New(env);
@@ -1132,6 +1200,7 @@ Napi::Object ScramNodeSumOfProducts(Napi::Env env, const scram::core::FaultTreeA
     sop.Set("products",    Napi::Number::New(env, 0));
     if (pa) {
       sop.Set("probability", Napi::Number::New(env, pa->p_total()));
+      SetEstimate(env, sop, *pa);
     }
     // Do not set distribution or productList when products are not available.
     return sop;
@@ -1146,6 +1215,7 @@ Napi::Object ScramNodeSumOfProducts(Napi::Env env, const scram::core::FaultTreeA
   if (pa) {
     totalProb = pa->p_total();
     sop.Set("probability", Napi::Number::New(env, totalProb));
+    SetEstimate(env, sop, *pa);
   }
   
   // Distribution
@@ -15,6 +15,7 @@ Napi::Object ScramNodeModelFeatures(Napi::Env env, const scram::mef::Model& mode
 Napi::Object ScramNodeResults(Napi::Env env, const scram::core::RiskAnalysis& analysis);
 Napi::Object ScramNodeSafetyIntegrityLevels(Napi::Env env, const scram::core::ProbabilityAnalysis& pa);
 Napi::Object ScramNodeCurve(Napi::Env env, const scram::core::ProbabilityAnalysis& pa);
+Napi::Array  ScramNodeScenarios(Napi::Env env, const scram::core::RiskAnalysis& analysis);
 Napi::Object ScramNodeStatisticalMeasure(Napi::Env env, const scram::core::UncertaintyAnalysis& ua);
 Napi::Object ScramNodeImportance(Napi::Env env, const scram::core::ImportanceAnalysis& ia);
 Napi::Object ScramNodeSumOfProducts(Napi::Env env, const scram::core::FaultTreeAnalysis& fta, const scram::core::ProbabilityAnalysis* pa, const scram::core::RiskAnalysis::Result* result = nullptr);
@@ -97,6 +97,21 @@ scram::core::Settings ScramNodeOptions(const Napi::Object& nodeOptions) {
         settings.cut_off(nodeOptions.Get("cutOff").ToNumber().DoubleValue());
     }
 
+    // The number of the most probable products to report (int)
+    if (nodeOptions.Has("topProducts")) {
+        settings.top_products(nodeOptions.Get("topProducts").ToNumber().Int32Value());
+    }
+
+    // Time budget for BDD variable reordering (double)
+    if (nodeOptions.Has("reorderTime")) {
+        settings.reorder_time(nodeOptions.Get("reorderTime").ToNumber().DoubleValue());
+    }
+
+    // Time budget for optional preprocessing passes (double)
+    if (nodeOptions.Has("preprocessingTime")) {
+        settings.preprocessing_time(nodeOptions.Get("preprocessingTime").ToNumber().DoubleValue());
+    }
+
     // Mission time (double)
     if (nodeOptions.Has("missionTime")) {
         settings.mission_time(nodeOptions.Get("missionTime").ToNumber().DoubleValue());
@@ -112,6 +127,26 @@ scram::core::Settings ScramNodeOptions(const Napi::Object& nodeOptions) {
         settings.num_trials(nodeOptions.Get("numTrials").ToNumber().Int32Value());
     }
 
+    // Direct evaluation: 64-bit sample words per pass (int)
+    if (nodeOptions.Has("batchSize")) {
+        settings.batch_size(nodeOptions.Get("batchSize").ToNumber().Int32Value());
+    }
+
+    // Direct evaluation: maximum number of passes (int)
+    if (nodeOptions.Has("sampleSize")) {
+        settings.sample_size(nodeOptions.Get("sampleSize").ToNumber().Int32Value());
+    }
+
+    // Confidence level of Monte Carlo estimates (double)
+    if (nodeOptions.Has("confidence")) {
+        settings.confidence(nodeOptions.Get("confidence").ToNumber().DoubleValue());
+    }
+
+    // Relative half-width of the confidence interval for early stopping (double)
+    if (nodeOptions.Has("delta")) {
+        settings.delta(nodeOptions.Get("delta").ToNumber().DoubleValue());
+    }
+
     // Number of quantiles (int)
     if (nodeOptions.Has("numQuantiles")) {
         settings.num_quantiles(nodeOptions.Get("numQuantiles").ToNumber().Int32Value());
@@ -127,6 +162,11 @@ scram::core::Settings ScramNodeOptions(const Napi::Object& nodeOptions) {
         settings.seed(nodeOptions.Get("seed").ToNumber().Int32Value());
     }
 
+    // Number of threads for concurrent target analyses (int)
+    if (nodeOptions.Has("threads")) {
+        settings.num_threads(nodeOptions.Get("threads").ToNumber().Int32Value());
+    }
+
     // Graph compilation and preprocessing flags
     // Expand at-least gates (--no-kn flag disables K/N gate optimization)
     if (nodeOptions.Has("noKn")) {
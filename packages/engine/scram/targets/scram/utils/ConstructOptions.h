@@ -79,14 +79,23 @@ inline po::options_description ConstructOptions() {
             ("sil", "compute safety-integrity-level metrics")
             ("rare-event", "use the rare event approximation")
             ("mcub", "use the MCUB approximation")
+            ("monte-carlo", "use the Monte Carlo direct evaluation")
             ("limit-order,l", OPT_VALUE(int), "upper limit for the product order")
             ("cut-off", OPT_VALUE(double), "cut-off probability for products")
+            ("top-products", OPT_VALUE(int), "number of the most probable products to report")
+            ("reorder-time", OPT_VALUE(double), "time budget in seconds for BDD variable reordering")
+            ("preprocessing-time", OPT_VALUE(double), "time budget in seconds for optional preprocessing passes")
             ("mission-time", OPT_VALUE(double), "system mission time in hours")
             ("time-step", OPT_VALUE(double), "timestep in hours")
             ("num-trials", OPT_VALUE(int), "number of trials for Monte Carlo simulations")
+            ("batch-size", OPT_VALUE(int), "64-bit sample words per direct evaluation pass")
+            ("sample-size", OPT_VALUE(int), "maximum number of direct evaluation passes")
+            ("confidence", OPT_VALUE(double), "confidence level for Monte Carlo estimates")
+            ("delta", OPT_VALUE(double), "relative half-width of the confidence interval to stop sampling")
             ("num-quantiles", OPT_VALUE(int),"number of quantiles for distributions")
             ("num-bins", OPT_VALUE(int), "number of bins for histograms")
             ("seed", OPT_VALUE(int), "seed for the pseudo-random number generator")
+            ("threads", OPT_VALUE(int), "number of threads to analyze targets and sample trials concurrently")
             ("output,o", OPT_VALUE(path), "output file for reports");
 
         all.add(gc).add(debug).add(desc);
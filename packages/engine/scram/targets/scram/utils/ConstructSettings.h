@@ -53,6 +53,8 @@ namespace ScramCLI {
             settings->algorithm(scram::core::Algorithm::kZbdd);
         } else if (vm.contains("mocus")) {
             settings->algorithm(scram::core::Algorithm::kMocus);
+        } else if (vm.contains("pdag")) {
+            settings->algorithm(scram::core::Algorithm::kPdag);
         }
         settings->prime_implicants(vm.contains("prime-implicants"));
 
@@ -65,7 +67,13 @@ namespace ScramCLI {
         } else if (vm.contains("mcub")) {
             settings->approximation(scram::core::Approximation::kMcub);
             probability_requested = true;
-        }     
+        } else if (vm.contains("monte-carlo")) {
+            settings->approximation(scram::core::Approximation::kMonteCarlo);
+            probability_requested = true;
+        }
+        // Direct evaluation of the PDAG has no qualitative results to report.
+        if (vm.contains("pdag"))
+            probability_requested = true;
         SET("time-step", double, time_step);
         settings->safety_integrity_levels(vm.contains("sil"));
         // For BDD algorithm: enable probability analysis by default UNLESS prime-implicants is requested alone
@@ -91,11 +99,20 @@ namespace ScramCLI {
         settings->ccf_analysis(vm.contains("ccf"));
         settings->adaptive(vm.contains("adaptive"));
         SET("seed", int, seed);
+        SET("threads", int, num_threads);
         SET("limit-order", int, limit_order);
         SET("cut-off", double, cut_off);
+        SET("top-products", int, top_products);
+        SET("reorder-time", double, reorder_time);
+        SET("preprocessing-time", double, preprocessing_time);
         SET("mission-time", double, mission_time);
         SET("num-quantiles", int, num_quantiles);
         SET("num-bins", int, num_bins);
+        SET("num-trials", int, num_trials);
+        SET("batch-size", int, batch_size);
+        SET("sample-size", int, sample_size);
+        SET("confidence", double, confidence);
+        SET("delta", double, delta);
         settings->preprocessor = vm.contains("preprocessor");
         settings->print = vm.contains("print");
 
@@ -0,0 +1,133 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bdd.h"
+#include "fault_tree_analysis.h"
+#include "importance_analysis.h"
+#include "initializer.h"
+#include "model.h"
+#include "probability_analysis.h"
+#include "settings.h"
+
+using namespace scram;
+using namespace scram::core;
+
+namespace {
+
+/// The BDD-based probability analysis of the single top event of a fixture model.
+struct Fixture {
+    Fixture(const std::string& file, const Settings& settings)
+        : model(mef::Initializer({std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/" + file},
+                                 settings).model()),
+          fta(*model->fault_trees().begin()->top_events().front(), settings) {
+        fta.Analyze();
+        analysis = std::make_unique<ProbabilityAnalyzer<Bdd>>(&fta, &model->mission_time());
+        analysis->Analyze();
+    }
+
+    /// @returns The total probability with the given variable probabilities
+    ///          without touching the state of the analysis.
+    double p_total(const Pdag::IndexMap<double>& p_vars) const {
+        std::vector<double> p_nodes;
+        return analysis->CalculateTotalProbability(p_vars, &p_nodes);
+    }
+
+    std::unique_ptr<mef::Model> model;
+    FaultTreeAnalyzer<Bdd> fta;
+    std::unique_ptr<ProbabilityAnalyzer<Bdd>> analysis;
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(BddTests)
+
+/**
+ * @brief Tests the dynamic reordering of variables with sifting.
+ * @details The fixture pairs the same variables in two shifted ways,
+ *          so the initial order blows up the BDD past the reordering threshold.
+ *          Sifting must not grow the BDD nor change the total probability.
+ */
+    BOOST_AUTO_TEST_CASE(test_sifting_keeps_function) {
+        Settings settings;
+        settings.probability_analysis(true);
+        Fixture fixed("core/sifting.xml", settings);
+        settings.reorder_time(60);
+        Fixture sifted("core/sifting.xml", settings);
+        BOOST_CHECK_LT(sifted.analysis->bdd_graph()->nodes().size(),
+                       fixed.analysis->bdd_graph()->nodes().size());
+        BOOST_CHECK_CLOSE(sifted.analysis->p_total(), fixed.analysis->p_total(), 1e-9);
+    }
+
+/**
+ * @brief Tests the marginal importance factors of the adjoint pass
+ *        against the central finite differences of the total probability.
+ * @details The total probability is linear in the probability of each variable,
+ *          so the differences are exact up to the rounding.
+ *          The fixtures cover modules, complement edges, and a non-modular BDD.
+ */
+    BOOST_AUTO_TEST_CASE(test_adjoint_mif_matches_finite_differences) {
+        for (const char* file :
+             {"core/modules.xml", "fta/correct_non_coherent.xml", "core/sifting.xml"}) {
+            BOOST_TEST_CONTEXT(file) {
+                Settings settings;
+                settings.importance_analysis(true);
+                Fixture fixture(file, settings);
+                ImportanceAnalyzer<Bdd> importance(fixture.analysis.get());
+                importance.Analyze();
+                BOOST_REQUIRE(!importance.importance().empty());
+
+                const auto& events = fixture.fta.graph()->basic_events();
+                for (const ImportanceRecord& record : importance.importance()) {
+                    BOOST_TEST_CONTEXT(record.event.id()) {
+                        auto it = std::find(events.begin(), events.end(), &record.event);
+                        BOOST_REQUIRE(it != events.end());
+                        int index = Pdag::kVariableStartIndex + (it - events.begin());
+                        Pdag::IndexMap<double> p_vars = fixture.analysis->p_vars();
+                        const double p = p_vars[index];
+                        const double h = std::min({1e-3, p, 1 - p}) / 2 + 1e-6;
+                        p_vars[index] = p + h;
+                        double p_high = fixture.p_total(p_vars);
+                        p_vars[index] = p - h;
+                        double p_low = fixture.p_total(p_vars);
+                        BOOST_CHECK_CLOSE(record.factors.mif, (p_high - p_low) / (2 * h), 1e-4);
+                    }
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the batched calculation of the total probability
+ *        against the scalar calculation for each probability set.
+ * @details The number of sets leaves a partial batch.
+ *          The fixtures cover modules and complement edges.
+ */
+    BOOST_AUTO_TEST_CASE(test_batches_match_scalar) {
+        for (const char* file :
+             {"core/modules.xml", "fta/correct_non_coherent.xml", "core/sifting.xml"}) {
+            BOOST_TEST_CONTEXT(file) {
+                Settings settings;
+                settings.probability_analysis(true);
+                Fixture fixture(file, settings);
+                std::mt19937 rng(42);
+                std::uniform_real_distribution<double> p_dist(0, 1);
+                std::vector<Pdag::IndexMap<double>> sets;
+                for (int i = 0; i < 2 * ProbabilityAnalyzerBase::kBatchSize + 3; ++i) {
+                    Pdag::IndexMap<double>& p_vars = sets.emplace_back(fixture.analysis->p_vars());
+                    for (double& p : p_vars)
+                        p = p_dist(rng);
+                }
+                std::vector<double> batched = fixture.analysis->CalculateTotalProbabilities(sets);
+                BOOST_REQUIRE_EQUAL(batched.size(), sets.size());
+                for (int i = 0; i < static_cast<int>(sets.size()); ++i)
+                    BOOST_CHECK_CLOSE(batched[i], fixture.p_total(sets[i]), 1e-10);
+            }
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,224 @@
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+#include "bdd.h"
+#include "initializer.h"
+#include "mocus.h"
+#include "model.h"
+#include "risk_analysis.h"
+#include "settings.h"
+#include "zbdd.h"
+
+using namespace scram;
+using namespace scram::core;
+
+namespace {
+
+/// Runs the analysis of the single top event of a fixture model.
+///
+/// @returns The total probability and the Monte Carlo estimate if any.
+std::pair<double, std::optional<ProbabilityEstimate>>
+Quantify(const std::string& file, const Settings& settings) {
+    std::unique_ptr<mef::Model> model =
+        mef::Initializer({std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/" + file},
+                         settings).model();
+    RiskAnalysis analysis(model.get(), settings);
+    analysis.Analyze();
+    BOOST_REQUIRE_EQUAL(analysis.results().size(), 1);
+    const ProbabilityAnalysis& pa = *analysis.results().front().probability_analysis;
+    return {pa.p_total(), pa.estimate()};
+}
+
+/// @returns The products of the analysis as sets of literal names.
+std::set<std::set<std::string>> Products(const FaultTreeAnalysis& fta) {
+    std::set<std::set<std::string>> products;
+    for (const Product& product : fta.products()) {
+        std::set<std::string> literals;
+        for (const Literal& literal : product)
+            literals.insert((literal.complement ? "~" : "") + literal.event.id());
+        products.insert(literals);
+    }
+    return products;
+}
+
+/// Runs the dedicated analysis of a target on its own graph.
+///
+/// @returns The products and the total probability of the target.
+template <class Algorithm>
+std::pair<std::set<std::set<std::string>>, double>
+Dedicated(const mef::Gate& target, const Settings& settings, mef::Model* model) {
+    FaultTreeAnalyzer<Algorithm> fta(target, settings, model);
+    fta.Analyze();
+    auto quantify = [&](auto&& pa) {
+        pa.Analyze();
+        return pa.p_total();
+    };
+    double p_total = settings.approximation() == Approximation::kNone
+                         ? quantify(ProbabilityAnalyzer<Bdd>(&fta, &model->mission_time()))
+                         : quantify(ProbabilityAnalyzer<RareEventCalculator>(
+                               &fta, &model->mission_time()));
+    return {Products(fta), p_total};
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(DirectEvalTests)
+
+/**
+ * @brief Tests the Monte Carlo estimate of the PDAG algorithm against the exact BDD probability.
+ * @details Runs coherent and non-coherent fixtures with a fixed seed
+ *          and checks that the confidence interval brackets the exact value.
+ */
+    BOOST_AUTO_TEST_CASE(test_estimate_brackets_bdd) {
+        for (const char* file : {"core/ab_bc.xml", "fta/correct_non_coherent.xml",
+                                 "core/atleast.xml", "core/xor.xml"}) {
+            BOOST_TEST_CONTEXT(file) {
+                Settings settings;
+                settings.probability_analysis(true).seed(42);
+                double exact = Quantify(file, settings).first;
+                BOOST_REQUIRE(!Quantify(file, settings).second);
+
+                settings.algorithm(Algorithm::kPdag).confidence(0.999).sample_size(200);
+                auto [p_total, estimate] = Quantify(file, settings);
+                BOOST_REQUIRE(estimate);
+                BOOST_CHECK_EQUAL(p_total, estimate->value);
+                BOOST_CHECK_GT(estimate->num_samples, 0);
+                BOOST_CHECK_LE(estimate->num_successes, estimate->num_samples);
+                BOOST_CHECK_GT(estimate->std_error, 0);
+                BOOST_CHECK_LE(estimate->lower_bound, exact);
+                BOOST_CHECK_GE(estimate->upper_bound, exact);
+            }
+        }
+    }
+
+/**
+ * @brief Tests the early stop of sampling at the requested relative precision.
+ * @details The relaxed precision must stop sampling before the sample size limit
+ *          with the interval half-width within the requested fraction of the estimate.
+ */
+    BOOST_AUTO_TEST_CASE(test_delta_stopping_rule) {
+        Settings settings;
+        settings.algorithm(Algorithm::kPdag).probability_analysis(true).seed(42)
+            .sample_size(1000);
+        std::int64_t full = Quantify("core/ab_bc.xml", settings).second->num_samples;
+
+        settings.delta(0.1);
+        ProbabilityEstimate estimate = *Quantify("core/ab_bc.xml", settings).second;
+        BOOST_CHECK_LT(estimate.num_samples, full);
+        BOOST_CHECK_LE((estimate.upper_bound - estimate.lower_bound) / 2,
+                       0.1 * estimate.value);
+    }
+
+/**
+ * @brief Tests the Monte Carlo approximation over products of the BDD algorithm.
+ * @details The direct evaluation of the preprocessed graph must bracket the exact probability.
+ */
+    BOOST_AUTO_TEST_CASE(test_monte_carlo_approximation) {
+        Settings settings;
+        settings.probability_analysis(true).seed(7);
+        double exact = Quantify("core/ab_bc.xml", settings).first;
+        settings.approximation(Approximation::kMonteCarlo).confidence(0.999);
+        ProbabilityEstimate estimate = *Quantify("core/ab_bc.xml", settings).second;
+        BOOST_CHECK_LE(estimate.lower_bound, exact);
+        BOOST_CHECK_GE(estimate.upper_bound, exact);
+    }
+
+/**
+ * @brief Tests the sequences of an initiating event sampled on one shared preprocessed graph.
+ * @details Every sequence and fault-tree top estimate must bracket
+ *          the exact probability from the dedicated BDD of the target.
+ */
+    BOOST_AUTO_TEST_CASE(test_shared_sequence_graph) {
+        const std::string file = std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/eta/shared_sequences.xml";
+        Settings settings;
+        settings.probability_analysis(true).seed(42);
+        std::unique_ptr<mef::Model> model = mef::Initializer({file}, settings).model();
+        RiskAnalysis exact(model.get(), settings);
+        exact.Analyze();
+
+        settings.algorithm(Algorithm::kPdag).confidence(0.999).sample_size(200);
+        RiskAnalysis sampled(model.get(), settings);
+        sampled.Analyze();
+        BOOST_REQUIRE_EQUAL(exact.results().size(), 5);
+        BOOST_REQUIRE_EQUAL(sampled.results().size(), exact.results().size());
+        // The order of sequences is not fixed between analyses.
+        auto target = [](const RiskAnalysis::Result& result) {
+            return std::visit(
+                [](const auto& input) -> const void* {
+                    if constexpr (std::is_pointer_v<std::decay_t<decltype(input)>>)
+                        return input;
+                    else
+                        return &input.second;
+                },
+                result.id.target);
+        };
+        std::map<const void*, double> p_exact;
+        for (const RiskAnalysis::Result& result : exact.results())
+            p_exact[target(result)] = result.probability_analysis->p_total();
+        double p_sequences = 0;
+        for (const RiskAnalysis::Result& result : sampled.results()) {
+            BOOST_TEST_CONTEXT("target " << result.fault_tree_analysis->top_event().id()) {
+                BOOST_REQUIRE_EQUAL(p_exact.count(target(result)), 1);
+                const ProbabilityEstimate& estimate = *result.probability_analysis->estimate();
+                BOOST_CHECK_LE(estimate.lower_bound, p_exact[target(result)]);
+                BOOST_CHECK_GE(estimate.upper_bound, p_exact[target(result)]);
+                if (result.id.target.index() == 1)
+                    p_sequences += estimate.value;
+            }
+        }
+        BOOST_CHECK_CLOSE(p_sequences, 1, 1e-9);  // Exhaustive exclusive sequences.
+    }
+
+/**
+ * @brief Tests the exact analyses of the sequences on one shared preprocessed graph.
+ * @details The products and probabilities of every sequence
+ *          must match the dedicated analysis of the sequence gate
+ *          with every qualitative algorithm.
+ */
+    BOOST_AUTO_TEST_CASE(test_shared_sequence_graph_exact) {
+        const std::string file = std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/eta/shared_sequences.xml";
+        for (Algorithm algorithm : {Algorithm::kBdd, Algorithm::kZbdd, Algorithm::kMocus}) {
+            for (Approximation approximation : {Approximation::kNone, Approximation::kRareEvent}) {
+                BOOST_TEST_CONTEXT(kAlgorithmToString[static_cast<int>(algorithm)] << " "
+                                   << kApproximationToString[static_cast<int>(approximation)]) {
+                    Settings settings;
+                    settings.algorithm(algorithm).approximation(approximation)
+                        .probability_analysis(true).importance_analysis(true);
+                    std::unique_ptr<mef::Model> model = mef::Initializer({file}, settings).model();
+                    RiskAnalysis analysis(model.get(), settings);
+                    analysis.Analyze();
+                    int num_sequences = 0;
+                    for (const RiskAnalysis::Result& result : analysis.results()) {
+                        if (result.id.target.index() != 1)
+                            continue;
+                        ++num_sequences;
+                        const FaultTreeAnalysis& shared = *result.fault_tree_analysis;
+                        BOOST_TEST_CONTEXT("sequence " << shared.top_event().id()) {
+                            auto [products, p_total] = [&] {
+                                switch (algorithm) {
+                                    case Algorithm::kBdd:
+                                        return Dedicated<Bdd>(shared.top_event(), settings, model.get());
+                                    case Algorithm::kZbdd:
+                                        return Dedicated<Zbdd>(shared.top_event(), settings, model.get());
+                                    default:
+                                        return Dedicated<Mocus>(shared.top_event(), settings, model.get());
+                                }
+                            }();
+                            BOOST_CHECK(Products(shared) == products);
+                            BOOST_CHECK_CLOSE(result.probability_analysis->p_total(), p_total, 1e-9);
+                            BOOST_CHECK(result.importance_analysis);
+                        }
+                    }
+                    BOOST_CHECK_EQUAL(num_sequences, 3);
+                }
+            }
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
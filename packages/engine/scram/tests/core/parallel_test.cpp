@@ -0,0 +1,149 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bdd.h"
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+#include "mocus.h"
+#include "model.h"
+#include "parallel.h"
+#include "settings.h"
+
+using namespace scram;
+using namespace scram::core;
+
+namespace {
+
+/// @returns The products of the analysis of the single top event of a fixture model
+///          with their probabilities as in Product::p().
+template <class Algorithm>
+std::map<std::set<std::string>, double> AnalyzeProducts(const std::string& file,
+                                                        const Settings& settings) {
+    std::unique_ptr<mef::Model> model =
+        mef::Initializer({std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/" + file}, settings)
+            .model();
+    FaultTreeAnalyzer<Algorithm> analysis(*model->fault_trees().begin()->top_events().front(),
+                                          settings);
+    analysis.Analyze();
+    std::map<std::set<std::string>, double> products;
+    analysis.products().Visit([&products](const Product& product, double p) {
+        std::set<std::string> literals;
+        for (const Literal& literal : product)
+            literals.insert((literal.complement ? "not " : "") + literal.event.id());
+        products.emplace(std::move(literals), p);
+    });
+    return products;
+}
+
+/// Tests the products of the analysis on several threads
+/// against the products of the analysis on one thread.
+template <class Algorithm>
+void TestThreadsMatchSingleThread(const std::string& file, Settings settings) {
+    std::map<std::set<std::string>, double> expected =
+        AnalyzeProducts<Algorithm>(file, settings.num_threads(1));
+    BOOST_REQUIRE(!expected.empty());
+    for (int num_threads : {2, 4}) {
+        BOOST_TEST_CONTEXT(num_threads << " threads") {
+            std::map<std::set<std::string>, double> products =
+                AnalyzeProducts<Algorithm>(file, settings.num_threads(num_threads));
+            BOOST_CHECK(products == expected);
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(ParallelTests)
+
+/**
+ * @brief Tests that every item is processed exactly once in chunks.
+ */
+    BOOST_AUTO_TEST_CASE(test_items_processed_once) {
+        std::vector<std::atomic<int>> counts(103);
+        int num_threads = ParallelFor(counts.size(), 8, 4, [&](int) {
+            return [&](std::size_t first, std::size_t last) {
+                BOOST_CHECK_LE(last - first, 8);
+                for (std::size_t i = first; i < last; ++i)
+                    ++counts[i];
+            };
+        });
+        BOOST_CHECK_EQUAL(num_threads, 4);
+        for (const std::atomic<int>& count : counts)
+            BOOST_CHECK_EQUAL(count, 1);
+    }
+
+/**
+ * @brief Tests that the number of threads is limited by the number of chunks.
+ */
+    BOOST_AUTO_TEST_CASE(test_threads_limited_by_chunks) {
+        auto noop = [](int) { return [](std::size_t, std::size_t) {}; };
+        BOOST_CHECK_EQUAL(ParallelFor(3, 1, 8, noop), 3);
+        BOOST_CHECK_EQUAL(ParallelFor(16, 8, 8, noop), 2);
+        BOOST_CHECK_EQUAL(ParallelFor(0, 1, 8, noop), 1);
+    }
+
+/**
+ * @brief Tests that nested loops share the thread budget of the outer loop.
+ * @details The outer loop on 2 of 4 threads leaves 2 threads to every nested loop;
+ *          the outer loop on all 4 threads leaves the nested loops on their own thread.
+ */
+    BOOST_AUTO_TEST_CASE(test_nested_budget) {
+        auto noop = [](int) { return [](std::size_t, std::size_t) {}; };
+        for (auto [num_items, nested_threads] : {std::pair{2, 2}, std::pair{4, 1}}) {
+            std::atomic<int> max_nested = 0;
+            ParallelFor(num_items, 1, 4, [&](int) {
+                return [&](std::size_t, std::size_t) {
+                    int num_threads = ParallelFor(100, 1, 4, noop);
+                    for (int max = max_nested; max < num_threads &&
+                         !max_nested.compare_exchange_weak(max, num_threads);) {}
+                };
+            });
+            BOOST_CHECK_EQUAL(max_nested, nested_threads);
+        }
+        // The budget is restored after the loop.
+        BOOST_CHECK_EQUAL(ThreadBudget::Available(4), 4);
+    }
+
+/**
+ * @brief Tests the propagation of the first exception with the cancellation of the rest.
+ */
+    BOOST_AUTO_TEST_CASE(test_exception) {
+        std::atomic<int> num_processed = 0;
+        BOOST_CHECK_THROW(ParallelFor(1000, 1, 4, [&](int) {
+            return [&](std::size_t first, std::size_t) {
+                ++num_processed;
+                if (first == 10)
+                    throw std::runtime_error("failure");
+            };
+        }), std::runtime_error);
+        BOOST_CHECK_LT(num_processed, 1000);
+    }
+
+/**
+ * @brief Tests the products of MOCUS and the BDD on several threads
+ *        against the products on one thread.
+ * @details The independent modules are nested three levels deep,
+ *          so the concurrent analyses of modules spawn nested concurrent analyses.
+ *          The limit on the product order truncates the products within modules.
+ */
+    BOOST_AUTO_TEST_CASE(test_nested_modules_match_single_thread) {
+        for (int limit_order : {20, 4}) {
+            BOOST_TEST_CONTEXT("the limit order " << limit_order) {
+                Settings settings;
+                settings.limit_order(limit_order).approximation(Approximation::kRareEvent);
+                TestThreadsMatchSingleThread<Mocus>("core/nested_modules.xml", settings);
+                TestThreadsMatchSingleThread<Bdd>("core/nested_modules.xml", settings);
+                settings.approximation(Approximation::kNone).prime_implicants(true);
+                TestThreadsMatchSingleThread<Bdd>("core/nested_modules.xml", settings);
+            }
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
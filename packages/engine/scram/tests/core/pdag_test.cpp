@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+
+#include <pthread.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "event.h"
+#include "pdag.h"
+#include "preprocessor.h"
+
+using namespace scram;
+using namespace scram::core;
+
+namespace {
+
+/// The MEF gates of a chain alternating AND and OR connectives,
+/// i.e., G0 = E0 & G1, G1 = E1 | G2, and so on down to the last two events.
+/// Every gate of the chain is a module with its own event,
+/// so preprocessing can neither coalesce nor drop the gates.
+struct Chain {
+    explicit Chain(int depth) {
+        for (int i = 0; i <= depth; ++i)
+            events.push_back(std::make_unique<mef::BasicEvent>("E" + std::to_string(i)));
+        for (int i = 0; i < depth; ++i)
+            gates.push_back(std::make_unique<mef::Gate>("G" + std::to_string(i)));
+        for (int i = 0; i < depth; ++i) {
+            mef::Formula::ArgEvent next = i + 1 < depth
+                                              ? mef::Formula::ArgEvent(gates[i + 1].get())
+                                              : mef::Formula::ArgEvent(events[depth].get());
+            gates[i]->formula(std::make_unique<mef::Formula>(
+                i % 2 ? mef::kOr : mef::kAnd, mef::Formula::ArgSet{events[i].get(), next}));
+        }
+    }
+
+    std::vector<std::unique_ptr<mef::BasicEvent>> events;
+    std::vector<std::unique_ptr<mef::Gate>> gates;
+};
+
+/// @returns The number of gates and variables reachable from the root.
+std::pair<int, int> CountNodes(Pdag* graph) {
+    int num_gates = 0;
+    int num_variables = 0;
+    graph->Clear<Pdag::kGateMark>();
+    graph->Clear<Pdag::kVisit>();
+    TraverseNodes(graph->root(), [&](const auto& node) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(node)>, GatePtr>) {
+            ++num_gates;
+        } else if (!node->Visited()) {
+            node->Visit(1);
+            ++num_variables;
+        }
+    });
+    graph->Clear<Pdag::kGateMark>();
+    graph->Clear<Pdag::kVisit>();
+    return {num_gates, num_variables};
+}
+
+/// Constructs and preprocesses the PDAG of a deep chain for an algorithm.
+template <class Algorithm>
+void TestDeepChain(const Chain& chain) {
+    const int depth = chain.gates.size();
+    Pdag graph(*chain.gates.front());
+    BOOST_CHECK(CountNodes(&graph) == std::pair(depth, depth + 1));
+    CustomPreprocessor<Algorithm> preprocessor{&graph};
+    preprocessor();
+    BOOST_REQUIRE(!graph.IsTrivial());
+    BOOST_CHECK(CountNodes(&graph) == std::pair(depth, depth + 1));
+}
+
+/// Runs a function on a thread with a small stack
+/// to catch recursion proportional to the depth of graphs.
+void RunOnSmallStack(std::function<void()> function) {
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, 1 << 20);
+    pthread_t thread;
+    auto run = [](void* arg) -> void* {
+        (*static_cast<std::function<void()>*>(arg))();
+        return nullptr;
+    };
+    BOOST_REQUIRE_EQUAL(pthread_create(&thread, &attributes, run, &function), 0);
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attributes);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(PdagTests)
+
+/**
+ * @brief Tests the construction and preprocessing of a PDAG
+ *        with a gate chain too deep for recursion on the thread stack.
+ * @details The traversals and the destruction of the graph must use explicit stacks
+ *          for the depth to be limited by the heap.
+ */
+    BOOST_AUTO_TEST_CASE(test_deep_chain) {
+        Chain chain(50000);
+        RunOnSmallStack([&chain] {
+            TestDeepChain<Bdd>(chain);
+            TestDeepChain<Zbdd>(chain);
+            TestDeepChain<Mocus>(chain);
+        });
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -120,6 +120,63 @@ BOOST_AUTO_TEST_SUITE(SettingsTests)
         BOOST_CHECK_THROW(settings.limit_order(-1), scram::SettingsError);
     }
 
+/**
+ * @brief Tests the PDAG algorithm with the Monte Carlo direct evaluation.
+ * @details Verifies the default approximation, the product requirements, and the sampling parameter validation.
+ */
+    BOOST_AUTO_TEST_CASE(test_direct_evaluation_setting) {
+        Settings settings;
+        settings.algorithm(Algorithm::kPdag);
+        BOOST_CHECK(settings.approximation() == Approximation::kMonteCarlo);
+        BOOST_CHECK(!settings.requires_products());
+        BOOST_CHECK_THROW(settings.approximation(Approximation::kRareEvent), scram::SettingsError);
+        BOOST_CHECK_THROW(settings.prime_implicants(true), scram::SettingsError);
+
+        BOOST_CHECK_THROW(settings.batch_size(0), scram::SettingsError);
+        BOOST_CHECK_THROW(settings.sample_size(0), scram::SettingsError);
+        BOOST_CHECK_THROW(settings.confidence(1), scram::SettingsError);
+        BOOST_CHECK_THROW(settings.delta(-0.1), scram::SettingsError);
+        settings.confidence(0.99).delta(0.05);
+        BOOST_CHECK_EQUAL(settings.confidence(), 0.99);
+        BOOST_CHECK_EQUAL(settings.delta(), 0.05);
+    }
+
+/**
+ * @brief Tests the number of threads for concurrent analyses.
+ * @details Verifies the single-threaded default and the rejection of non-positive numbers.
+ */
+    BOOST_AUTO_TEST_CASE(test_num_threads_setting) {
+        Settings settings;
+        BOOST_CHECK_EQUAL(settings.num_threads(), 1);
+        settings.num_threads(8);
+        BOOST_CHECK_EQUAL(settings.num_threads(), 8);
+        BOOST_CHECK_THROW(settings.num_threads(0), scram::SettingsError);
+    }
+
+/**
+ * @brief Tests the time budget for BDD variable reordering.
+ * @details Verifies the fixed-order default and the rejection of negative budgets.
+ */
+    BOOST_AUTO_TEST_CASE(test_reorder_time_setting) {
+        Settings settings;
+        BOOST_CHECK_EQUAL(settings.reorder_time(), 0);
+        settings.reorder_time(2.5);
+        BOOST_CHECK_EQUAL(settings.reorder_time(), 2.5);
+        BOOST_CHECK_THROW(settings.reorder_time(-1), scram::SettingsError);
+    }
+
+/**
+ * @brief Tests the time budget for optional preprocessing passes.
+ * @details Verifies the unlimited default and the rejection of negative budgets.
+ */
+    BOOST_AUTO_TEST_CASE(test_preprocessing_time_setting) {
+        Settings settings;
+        BOOST_CHECK_EQUAL(settings.preprocessing_time(), 0);
+        settings.preprocessing_time(30);
+        BOOST_CHECK_EQUAL(settings.preprocessing_time(), 30);
+        BOOST_CHECK_THROW(settings.preprocessing_time(-1), scram::SettingsError);
+    }
+
 // Additional test cases follow the same pattern, providing detailed documentation on their purpose and behavior.
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
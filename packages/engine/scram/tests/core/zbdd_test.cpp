@@ -0,0 +1,411 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bdd.h"
+#include "fault_tree_analysis.h"
+#include "initializer.h"
+#include "model.h"
+#include "mocus.h"
+#include "settings.h"
+#include "zbdd.h"
+
+using namespace scram;
+using namespace scram::core;
+
+namespace {
+
+/// The BDD-based analysis of the single top event of a fixture model.
+/// The settings must require products, e.g., prime implicants.
+struct Fixture {
+    Fixture(const std::string& file, const Settings& settings)
+        : model(mef::Initializer({std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/" + file},
+                                 settings).model()),
+          analysis(*model->fault_trees().begin()->top_events().front(), settings) {
+        analysis.Analyze();
+        for (const mef::BasicEvent* event : analysis.graph()->basic_events())
+            p_vars.push_back(event->p());
+    }
+
+    /// @returns The products of the analysis.
+    const Zbdd& products() const { return analysis.algorithm()->products(); }
+
+    /// @returns The probability of a product.
+    double p(const std::vector<int>& product) const {
+        double p = 1;
+        for (int literal : product)
+            p *= literal < 0 ? 1 - p_vars[-literal] : p_vars[literal];
+        return p;
+    }
+
+    /// @returns All the products in non-increasing order of their probabilities.
+    std::vector<Zbdd::ScoredProduct> SortedProducts() const {
+        std::vector<Zbdd::ScoredProduct> sorted;
+        for (const std::vector<int>& product : products())
+            sorted.emplace_back(product, p(product));
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second > rhs.second;
+        });
+        return sorted;
+    }
+
+    /// @returns All the products in the iteration order.
+    std::vector<std::vector<int>> AllProducts() const {
+        return {products().begin(), products().end()};
+    }
+
+    std::unique_ptr<mef::Model> model;
+    FaultTreeAnalyzer<Bdd> analysis;
+    Pdag::IndexMap<double> p_vars;
+};
+
+/// @returns The product as a set of literals regardless of the literal order.
+std::set<int> AsSet(const std::vector<int>& product) {
+    return {product.begin(), product.end()};
+}
+
+/// @returns The products of the analysis of the single top event of a fixture model
+///          with their probabilities as in Product::p().
+template <class Algorithm>
+std::map<std::set<std::string>, double> AnalyzeProducts(const std::string& file,
+                                                        const Settings& settings) {
+    std::unique_ptr<mef::Model> model =
+        mef::Initializer({std::string(PROJECT_SOURCE_DIR) + "/tests/fixtures/" + file}, settings)
+            .model();
+    FaultTreeAnalyzer<Algorithm> analysis(*model->fault_trees().begin()->top_events().front(),
+                                          settings);
+    analysis.Analyze();
+    std::map<std::set<std::string>, double> products;
+    analysis.products().Visit([&products](const Product& product, double p) {
+        std::set<std::string> literals;
+        for (const Literal& literal : product)
+            literals.insert((literal.complement ? "not " : "") + literal.event.id());
+        products.emplace(std::move(literals), p);
+    });
+    return products;
+}
+
+/// Tests the products pruned with the cut-off during the construction
+/// against the products without the cut-off above the same cut-off.
+/// The cut-offs are set just below every product probability.
+template <class Algorithm>
+void TestCutOffPruning(const std::string& file, bool prime_implicants) {
+    Settings settings;
+    settings.prime_implicants(prime_implicants).probability_analysis(true);
+    if (!prime_implicants)
+        settings.approximation(Approximation::kRareEvent);  // Requires products.
+    std::map<std::set<std::string>, double> all = AnalyzeProducts<Algorithm>(file, settings);
+    BOOST_REQUIRE(!all.empty());
+    for (const auto& entry : all) {
+        const double cut_off = entry.second * (1 - 1e-3);
+        BOOST_TEST_CONTEXT("the cut-off " << cut_off) {
+            std::map<std::set<std::string>, double> expected;
+            for (const auto& product : all) {
+                if (product.second >= cut_off)
+                    expected.insert(product);
+            }
+            settings.cut_off(cut_off);
+            std::map<std::set<std::string>, double> pruned =
+                AnalyzeProducts<Algorithm>(file, settings);
+            BOOST_CHECK_EQUAL(pruned.size(), expected.size());
+            for (const auto& product : expected)
+                BOOST_CHECK(pruned.contains(product.first));
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(ZbddTests)
+
+/**
+ * @brief Tests the best-first extraction of products against the sorted enumeration.
+ * @details The coherent fixture with modules and the non-coherent fixture with prime implicants
+ *          are checked with and without the limit on the product order
+ *          for limits below, at, and above the number of products.
+ */
+    BOOST_AUTO_TEST_CASE(test_top_products_match_sorted_enumeration) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml"}) {
+            for (int limit_order : {20, 2}) {
+                BOOST_TEST_CONTEXT(file << " with the limit order " << limit_order) {
+                    Settings settings;
+                    settings.prime_implicants(true).limit_order(limit_order);
+                    Fixture fixture(file, settings);
+                    std::vector<Zbdd::ScoredProduct> sorted = fixture.SortedProducts();
+                    BOOST_REQUIRE(!sorted.empty());
+                    std::set<std::set<int>> all;
+                    for (const Zbdd::ScoredProduct& product : sorted)
+                        all.insert(AsSet(product.first));
+
+                    const int size = sorted.size();
+                    for (int limit : {0, 1, 4, size, size + 3}) {
+                        std::vector<Zbdd::ScoredProduct> top =
+                            fixture.products().TopProducts(limit, fixture.p_vars);
+                        BOOST_REQUIRE_EQUAL(top.size(), std::min(limit, size));
+                        std::set<std::set<int>> unique;
+                        for (int i = 0; i < static_cast<int>(top.size()); ++i) {
+                            BOOST_CHECK(all.contains(AsSet(top[i].first)));
+                            unique.insert(AsSet(top[i].first));
+                            BOOST_CHECK_CLOSE(top[i].second, fixture.p(top[i].first), 1e-9);
+                            BOOST_CHECK_CLOSE(top[i].second, sorted[i].second, 1e-9);
+                        }
+                        BOOST_CHECK_EQUAL(unique.size(), top.size());
+                    }
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the expected products of the fixture with modules.
+ * @details The only product of order 3 is dropped with the limit order of 2.
+ */
+    BOOST_AUTO_TEST_CASE(test_modules_fixture_products) {
+        Settings settings;
+        settings.prime_implicants(true);
+        BOOST_CHECK_EQUAL(Fixture("core/modules.xml", settings).SortedProducts().size(), 13);
+        settings.limit_order(2);
+        BOOST_CHECK_EQUAL(Fixture("core/modules.xml", settings).SortedProducts().size(), 12);
+    }
+
+/**
+ * @brief Tests the most probable products visited through the product container.
+ * @details The visited products must be the best products of the full visit
+ *          with the same probabilities in non-increasing order.
+ */
+    BOOST_AUTO_TEST_CASE(test_visit_top) {
+        Settings settings;
+        settings.prime_implicants(true).probability_analysis(true);
+        Fixture fixture("core/modules.xml", settings);
+        std::vector<double> all;
+        fixture.analysis.products().Visit(
+            [&all](const Product& product, double p) {
+                BOOST_CHECK_CLOSE(p, product.p(), 1e-9);
+                all.push_back(p);
+            });
+        std::ranges::sort(all, std::greater<>());
+
+        std::vector<double> top;
+        fixture.analysis.products().VisitTop(5, [&top](const Product& product, double p) {
+            BOOST_CHECK_CLOSE(p, product.p(), 1e-9);
+            top.push_back(p);
+        });
+        BOOST_REQUIRE_EQUAL(top.size(), 5);
+        for (int i = 0; i < 5; ++i)
+            BOOST_CHECK_CLOSE(top[i], all[i], 1e-9);
+    }
+
+/**
+ * @brief Tests the products and probabilities of the depth-first visit
+ *        against the iteration over the products.
+ * @details The fixtures are checked with and without the limit on the product order,
+ *          which truncates the products within modules.
+ */
+    BOOST_AUTO_TEST_CASE(test_visit_products_match_iteration) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml"}) {
+            for (int limit_order : {20, 2}) {
+                BOOST_TEST_CONTEXT(file << " with the limit order " << limit_order) {
+                    Settings settings;
+                    settings.prime_implicants(true).limit_order(limit_order);
+                    Fixture fixture(file, settings);
+                    std::vector<std::vector<int>> all = fixture.AllProducts();
+                    BOOST_REQUIRE(!all.empty());
+
+                    std::vector<std::vector<int>> visited;
+                    fixture.products().VisitProducts(
+                        [&fixture](int literal) { return fixture.p({literal}); },
+                        [&fixture, &visited](std::span<const int> product, double p) {
+                            visited.emplace_back(product.begin(), product.end());
+                            BOOST_CHECK_CLOSE(p, fixture.p(visited.back()), 1e-9);
+                        });
+                    BOOST_REQUIRE_EQUAL(visited.size(), all.size());
+                    for (int i = 0; i < static_cast<int>(all.size()); ++i) {
+                        BOOST_CHECK_EQUAL_COLLECTIONS(visited[i].begin(), visited[i].end(),
+                                                      all[i].begin(), all[i].end());
+                    }
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the sum of the product probabilities without the enumeration
+ *        against the sum over the visited products.
+ * @details The fixtures are checked with and without the limit on the product order,
+ *          which truncates the products within modules.
+ */
+    BOOST_AUTO_TEST_CASE(test_sum_of_products) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml"}) {
+            for (int limit_order : {20, 2}) {
+                BOOST_TEST_CONTEXT(file << " with the limit order " << limit_order) {
+                    Settings settings;
+                    settings.prime_implicants(true).probability_analysis(true).limit_order(
+                        limit_order);
+                    Fixture fixture(file, settings);
+                    double sum = 0;
+                    fixture.analysis.products().Visit(
+                        [&sum](const Product&, double p) { sum += p; });
+                    BOOST_CHECK_CLOSE(fixture.products().CalculateSumOfProducts(fixture.p_vars),
+                                      sum, 1e-9);
+                    BOOST_CHECK_CLOSE(fixture.analysis.products().CalculateSumOfProducts(), sum,
+                                      1e-9);
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the most probable products with the cut-off
+ *        against the products visited with the same cut-off.
+ * @details The cut-off is set between the product probabilities,
+ *          so the search must stop before the limit on the number of products.
+ */
+    BOOST_AUTO_TEST_CASE(test_top_products_stop_at_cut_off) {
+        Settings settings;
+        settings.prime_implicants(true).probability_analysis(true);
+        std::vector<Zbdd::ScoredProduct> sorted =
+            Fixture("core/modules.xml", settings).SortedProducts();
+        BOOST_REQUIRE_GT(sorted.size(), 4);
+        const double cut_off = (sorted[3].second + sorted[4].second) / 2;
+        BOOST_REQUIRE_GT(sorted[3].second, cut_off);
+        BOOST_REQUIRE_LT(sorted[4].second, cut_off);
+
+        settings.cut_off(cut_off);
+        Fixture fixture("core/modules.xml", settings);
+        std::vector<double> all;
+        fixture.analysis.products().Visit(
+            [&all](const Product&, double p) { all.push_back(p); });
+        std::ranges::sort(all, std::greater<>());
+        BOOST_REQUIRE_EQUAL(all.size(), 4);
+
+        std::vector<double> top;
+        fixture.analysis.products().VisitTop(sorted.size(), [&top](const Product&, double p) {
+            top.push_back(p);
+        });
+        BOOST_REQUIRE_EQUAL(top.size(), all.size());
+        for (int i = 0; i < static_cast<int>(top.size()); ++i) {
+            BOOST_CHECK_GE(top[i], cut_off);
+            BOOST_CHECK_CLOSE(top[i], all[i], 1e-9);
+        }
+    }
+
+/**
+ * @brief Tests the pruning of products below the cut-off
+ *        while the ZBDD is built from the BDD and by MOCUS.
+ * @details The coherent fixture has modules.
+ *          Without prime implicants, the complements in the non-coherent fixtures
+ *          are dropped from the products, so they must not weigh against the cut-off,
+ *          e.g., the unlikely complement of the likely event.
+ */
+    BOOST_AUTO_TEST_CASE(test_cut_off_pruning) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml",
+                                 "core/likely_complement.xml"}) {
+            BOOST_TEST_CONTEXT(file) {
+                TestCutOffPruning<Bdd>(file, /*prime_implicants=*/true);
+                TestCutOffPruning<Bdd>(file, /*prime_implicants=*/false);
+                TestCutOffPruning<Mocus>(file, /*prime_implicants=*/false);
+            }
+        }
+    }
+
+/**
+ * @brief Tests the counts, the distribution, and the events of products
+ *        against the enumeration of the products.
+ * @details The fixtures are checked with and without the limit on the product order,
+ *          which truncates the products within modules.
+ */
+    BOOST_AUTO_TEST_CASE(test_product_counter_statistics) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml"}) {
+            for (int limit_order : {20, 2, 1}) {
+                BOOST_TEST_CONTEXT(file << " with the limit order " << limit_order) {
+                    Settings settings;
+                    settings.prime_implicants(true).limit_order(limit_order);
+                    Fixture fixture(file, settings);
+                    std::vector<std::vector<int>> all = fixture.AllProducts();
+                    ProductCounter counter(fixture.products());
+                    BOOST_CHECK(counter.size() == all.size());
+
+                    std::vector<ProductCounter::Count> distribution(limit_order);
+                    std::set<int> events;
+                    for (const std::vector<int>& product : all) {
+                        BOOST_REQUIRE_LE(product.size(), limit_order);
+                        ++distribution[product.empty() ? 0 : product.size() - 1];
+                        for (int literal : product)
+                            events.insert(std::abs(literal));
+                    }
+                    while (!distribution.empty() && distribution.back() == 0)
+                        distribution.pop_back();  // Up to the largest product.
+                    BOOST_CHECK(counter.distribution() == distribution);
+                    std::vector<int> gathered = counter.GatherEvents();
+                    BOOST_CHECK_EQUAL_COLLECTIONS(gathered.begin(), gathered.end(),
+                                                  events.begin(), events.end());
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the unranking of every product against the iteration order.
+ */
+    BOOST_AUTO_TEST_CASE(test_product_counter_unranking) {
+        for (const char* file : {"core/modules.xml", "fta/correct_non_coherent.xml"}) {
+            for (int limit_order : {20, 2}) {
+                BOOST_TEST_CONTEXT(file << " with the limit order " << limit_order) {
+                    Settings settings;
+                    settings.prime_implicants(true).limit_order(limit_order);
+                    Fixture fixture(file, settings);
+                    std::vector<std::vector<int>> all = fixture.AllProducts();
+                    ProductCounter counter(fixture.products());
+                    for (int rank = 0; rank < static_cast<int>(all.size()); ++rank) {
+                        BOOST_TEST_CONTEXT("rank " << rank) {
+                            std::vector<int> product = counter.product(rank);
+                            BOOST_CHECK_EQUAL_COLLECTIONS(product.begin(), product.end(),
+                                                          all[rank].begin(), all[rank].end());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+/**
+ * @brief Tests the uniformity of sampled products over the full iteration.
+ * @details Every product of the module fixture with the limit order of 2
+ *          must be sampled within 5 standard deviations of the expected frequency,
+ *          and no other product may be sampled.
+ */
+    BOOST_AUTO_TEST_CASE(test_product_counter_sampling) {
+        Settings settings;
+        settings.prime_implicants(true).limit_order(2);
+        Fixture fixture("core/modules.xml", settings);
+        std::vector<std::vector<int>> all = fixture.AllProducts();
+        BOOST_REQUIRE_EQUAL(all.size(), 12);
+        ProductCounter counter(fixture.products());
+
+        std::map<std::vector<int>, int> frequencies;
+        for (const std::vector<int>& product : all)
+            frequencies[product] = 0;
+        const int num_samples = 12000;
+        std::mt19937 rng(42);
+        for (int i = 0; i < num_samples; ++i) {
+            auto it = frequencies.find(counter.Sample(rng));
+            BOOST_REQUIRE(it != frequencies.end());
+            ++it->second;
+        }
+        const double expected = static_cast<double>(num_samples) / all.size();
+        const double sigma = std::sqrt(expected * (1 - 1.0 / all.size()));
+        for (const auto& [product, frequency] : frequencies)
+            BOOST_CHECK_LE(std::abs(frequency - expected), 5 * sigma);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
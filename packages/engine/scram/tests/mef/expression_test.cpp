@@ -1,5 +1,9 @@
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include "expression.h"
+#include "expression/constant.h"
+#include "expression/random_deviate.h"
 #include "error.h"
 
 using namespace scram::mef;
@@ -16,6 +20,16 @@ private:
     double value_;
 };
 
+// Mock expression that counts its samples
+class CountingExpression : public Expression {
+public:
+    double value() noexcept override { return 0; }
+    double DoSample() noexcept override { return ++count_; }
+
+private:
+    int count_ = 0;
+};
+
 BOOST_AUTO_TEST_SUITE(ExpressionTests)
 
 /**
@@ -120,4 +134,42 @@ BOOST_AUTO_TEST_SUITE(ExpressionTests)
         BOOST_CHECK_THROW(EnsureWithin(&invalid_expr, valid_interval, "test"), DomainError);
     }
 
+/**
+ * @brief Tests the thread-private sample table of the Expression class.
+ * @details This test verifies that values sampled with an installed table do not leak into the shared expression state.
+ */
+    BOOST_AUTO_TEST_CASE(test_expression_sample_table) {
+        CountingExpression expr;
+        BOOST_CHECK_EQUAL(expr.Sample(), 1.0);
+        {
+            Expression::SampleTable table;
+            BOOST_CHECK_EQUAL(expr.Sample(), 2.0);
+            BOOST_CHECK_EQUAL(expr.Sample(), 2.0);
+            expr.Reset();
+            BOOST_CHECK_EQUAL(expr.Sample(), 3.0);
+        }
+        BOOST_CHECK_EQUAL(expr.Sample(), 1.0);
+    }
+
+/**
+ * @brief Tests the RNG streams of random deviates.
+ * @details This test verifies that a stream gives the same samples on any thread and that distinct streams differ.
+ */
+    BOOST_AUTO_TEST_CASE(test_random_deviate_stream) {
+        ConstantExpression min(0);
+        ConstantExpression max(1);
+        UniformDeviate deviate(&min, &max);
+        RandomDeviate::seed(42);
+        auto sample = [&deviate](int stream) {
+            Expression::SampleTable table;
+            RandomDeviate::stream(stream);
+            return deviate.Sample();
+        };
+        double first = sample(7);
+        double other = 0;
+        std::thread([&] { other = sample(7); }).join();
+        BOOST_CHECK_EQUAL(first, other);
+        BOOST_CHECK_NE(first, sample(8));
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
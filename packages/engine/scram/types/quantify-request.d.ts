@@ -64,6 +64,18 @@ export interface CommandLineOptions {
    * Cut-off probability for products
    */
   "cut-off"?: number;
+  /**
+   * Number of the most probable products to report
+   */
+  "top-products"?: number;
+  /**
+   * Time budget in seconds for BDD variable reordering
+   */
+  "reorder-time"?: number;
+  /**
+   * Time budget in seconds for optional preprocessing passes
+   */
+  "preprocessing-time"?: number;
   /**
    * System mission time in hours
    */
@@ -88,6 +100,11 @@ export interface CommandLineOptions {
    * Seed for the pseudo-random number generator
    */
   seed?: number;
+  /**
+   * Number of threads to analyze sequences and top events concurrently
+   * and to run the Monte Carlo trials of uncertainty analysis
+   */
+  threads?: number;
   /**
    * Confidence level for Monte Carlo convergence (0-1)
    */
@@ -189,12 +206,16 @@ export interface ScramNodeOptions {
   // Basic parameters
   limitOrder?: number;
   cutOff?: number;
+  topProducts?: number; // The number of the most probable products to report (0 for all)
+  reorderTime?: number; // Time budget in seconds for BDD variable reordering
+  preprocessingTime?: number; // Time budget in seconds for optional preprocessing passes
   missionTime?: number;
   timeStep?: number;
   numTrials?: number;
   numQuantiles?: number;
   numBins?: number;
   seed?: number;
+  threads?: number; // Threads for concurrent analyses of sequences and top events
 
   // Monte Carlo specific parameters
   confidence?: number; // Confidence level for convergence (0-1)
@@ -230,4 +251,18 @@ export interface NodeQuantRequest {
 
 export type QuantifyRequest = CommandLineOptions & ModelOptions;
 
+/**
+ * @remarks What-if overrides of the model values quantified
+ * with the products/BDD of the unmodified model.
+ */
+export interface ScenarioRequest {
+  name?: string; // Identifier of the scenario in the results
+  parameters?: Record<string, number>; // Parameter name -> overriding value
+  basicEvents?: Record<string, number>; // Basic event name -> overriding probability
+}
+
+export interface ScenarioQuantRequest extends NodeQuantRequest {
+  scenarios: ScenarioRequest[];
+}
+
 export interface ConvergenceQuantRequest extends NodeQuantRequest {}